@@ -0,0 +1,173 @@
+#ifndef ARM_H
+#define ARM_H
+
+#include <FEHServo.h>
+#include <FEHUtility.h>
+#include <math.h>
+#include "profile.h"
+
+//Fastest the arm is swept (in degrees per second), the same as the old one degree every 5 ms
+#define ARM_MAX_SPEED 200
+//Rate the arm speeds up and slows down at (in degrees per second squared)
+#define ARM_ACCELERATION 10000
+
+class ArmController;
+
+/**
+ * This is a struct which refers to one move handed to an ArmController, so the code that started it can
+ * check on it or wait for it later while other primitives run.
+ */
+struct ArmMove
+{
+    const ArmController *arm;
+    unsigned long id;
+
+    /** done
+        @return true once the arm has reached the end of this move, or a later move replaced it
+    */
+    bool done() const;
+};
+
+/**
+ * This is a class which sweeps the arm servo along a trapezoidal profile from a background control loop
+ * task, so a drive primitive can run while the arm moves.
+ *
+ * moveTo() plans the sweep from where the arm was last commanded and returns straight away with an
+ * ArmMove. Every tick update() sets the servo to where the profile says it should be by then. A new
+ * move starts from wherever the last one had got to, so moves can be chained or interrupted. The arm only
+ * moves while a control loop is running, so code that needs the arm in place before it carries on should
+ * wait on the ArmMove with a control loop (see waitForArm() in robot.cpp).
+ */
+class ArmController
+{
+    public:
+        ArmController(FEHServo &servo, float maxSpeed = ARM_MAX_SPEED, float acceleration = ARM_ACCELERATION)
+            : servo(servo), profile(0, maxSpeed, acceleration) {
+            this->maxSpeed = maxSpeed;
+            this->acceleration = acceleration;
+            current = start = target = 0;
+            startTime = 0;
+            moving = false;
+            started = 0;
+            finished = 0;
+        }
+
+        /** setMaxSpeed
+            Changes how fast later moves sweep the arm
+            @param maxSpeed Fastest the arm may turn (in degrees per second)
+        */
+        void setMaxSpeed(float maxSpeed) {
+            this->maxSpeed = maxSpeed;
+        }
+
+        float getMaxSpeed() const {
+            return maxSpeed;
+        }
+
+        /** hold
+            Sets the arm straight to an angle, cancelling any move in progress
+            @param degree Angle to set the servo to
+        */
+        void hold(float degree) {
+            servo.SetDegree(degree);
+            current = start = target = degree;
+            moving = false;
+            finished = started;
+        }
+
+        /** moveFrom
+            Starts sweeping the arm from one angle to another
+            @param from Angle the arm is taken to be at
+            @param to Angle to sweep to
+            @return The move, which is done once the arm reaches to
+        */
+        ArmMove moveFrom(float from, float to) {
+            current = from;
+            return moveTo(to);
+        }
+
+        /** moveTo
+            Starts sweeping the arm from where it was last commanded to a new angle
+            @param to Angle to sweep to
+            @return The move, which is done once the arm reaches to
+        */
+        ArmMove moveTo(float to) {
+            start = current;
+            target = to;
+            profile = TrapezoidProfile(fabs(to - start), maxSpeed, acceleration);
+            startTime = TimeNow();
+            //Anything still running has been replaced, so count it as done
+            finished = started;
+            started++;
+            moving = true;
+            servo.SetDegree(start);
+            ArmMove move = {this, started};
+            return move;
+        }
+
+        /** step
+            Moves the servo to where the current move should be by now
+            @param now Time the tick started (in seconds)
+        */
+        void step(double now) {
+            if(!moving) {
+                return;
+            }
+            float t = now - startTime;
+            float covered = profile.position(t);
+            current = target > start ? start + covered : start - covered;
+            servo.SetDegree(current);
+            if(t >= profile.getDuration()) {
+                current = target;
+                moving = false;
+                finished = started;
+            }
+        }
+
+        /** isDone
+            @param id Move to check
+            @return true once the move has finished or been replaced
+        */
+        bool isDone(unsigned long id) const {
+            return finished >= id;
+        }
+
+        bool isMoving() const {
+            return moving;
+        }
+
+        /** getDegree
+            @return Angle the servo was last commanded to
+        */
+        float getDegree() const {
+            return current;
+        }
+
+        /** update
+            Control loop task that keeps the arm moving
+            @param arm The ArmController to update
+            @param now Time the tick started (in seconds)
+        */
+        static void update(void *arm, double now) {
+            ((ArmController *)arm)->step(now);
+        }
+
+    private:
+        FEHServo &servo;
+        TrapezoidProfile profile;
+        float maxSpeed;
+        float acceleration;
+        float current;
+        float start;
+        float target;
+        double startTime;
+        bool moving;
+        unsigned long started;
+        unsigned long finished;
+};
+
+inline bool ArmMove::done() const {
+    return arm->isDone(id);
+}
+
+#endif
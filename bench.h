@@ -0,0 +1,401 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <FEHUtility.h>
+#include <FEHLCD.h>
+
+//Most phases and primitives that can be timed
+#define BENCH_MAX_ENTRIES 48
+//Most named counters
+#define BENCH_MAX_COUNTERS 16
+//Loop period histogram: bucket 0 is below BENCH_HISTOGRAM_BASE and each bucket after is twice as wide,
+//the last one holds everything longer
+#define BENCH_HISTOGRAM_BUCKETS 10
+#define BENCH_HISTOGRAM_BASE 0.000125
+
+/**
+ * Hardware calls whose time is totalled across the whole run.
+ */
+enum BenchSection
+{
+    BENCH_ENCODERS,
+    BENCH_DIGITAL,
+    BENCH_ANALOG,
+    BENCH_RPS,
+    BENCH_LCD,
+    BENCH_RECORDER,
+    BENCH_SECTIONS
+};
+
+/**
+ * This is a struct which holds the timing of one mission phase or motion primitive.
+ */
+struct BenchEntry
+{
+    const char *name;
+    bool phase;
+    int calls;
+    //Seconds spent inside, summed over all calls
+    double total;
+    double longest;
+    //Control loop iterations run directly by this function and the time between them
+    unsigned long iterations;
+    unsigned long periods;
+    double periodTotal;
+    double shortestPeriod;
+    double longestPeriod;
+    unsigned long histogram[BENCH_HISTOGRAM_BUCKETS];
+    double lastTick;
+};
+
+/**
+ * This is a struct which holds the time spent in one kind of hardware call.
+ */
+struct BenchSectionTime
+{
+    unsigned long calls;
+    double total;
+};
+
+/**
+ * This is a struct which holds a named event count.
+ */
+struct BenchCounter
+{
+    const char *name;
+    unsigned long count;
+};
+
+/**
+ * Function a host runner can have called when a timed phase starts and ends.
+ * @param id Index of the phase's entry
+ * @param starting true when the phase starts, false when it returns
+ */
+typedef void (*BenchPhaseHook)(int id, bool starting);
+
+/**
+ * This is a class which counts how many times each mission phase and motion primitive runs and how long
+ * it takes.
+ *
+ * Functions are timed by putting BENCH_PHASE() or BENCH_PRIMITIVE() at the top of them. Times include
+ * any primitives called from inside, so a phase's time is the sum of its primitives plus whatever it does
+ * between them. Each control loop iteration calls BENCH_TICK(), which is charged to the innermost timed
+ * function to build a histogram of how fast its loop really runs. BENCH_SECTION() totals the time spent
+ * in encoder, pin, RPS and LCD calls, and BENCH_COUNT() counts named events.
+ *
+ * The macros only time anything when BENCHMARK is defined (the host benchmark runner defines it). On the
+ * robot BENCH_PHASE() and BENCH_PRIMITIVE() still note which function is running, which costs two stores
+ * per call and lets the flight recorder tag its records; the other macros do nothing. They expect a Bench
+ * named bench.
+ */
+class Bench
+{
+    public:
+        Bench() {
+            count = 0;
+            counterCount = 0;
+            current = -1;
+            phaseHook = 0;
+            for(int i = 0; i < BENCH_SECTIONS; i++) {
+                sections[i].calls = 0;
+                sections[i].total = 0;
+            }
+        }
+
+        /** add
+            Adds a function to the table, called once per function the first time it runs
+            @param name Function name
+            @param phase true for a mission phase, false for a motion primitive
+            @return Index of the new entry
+        */
+        int add(const char *name, bool phase) {
+            if(count >= BENCH_MAX_ENTRIES) {
+                return -1;
+            }
+            BenchEntry &entry = entries[count];
+            entry.name = name;
+            entry.phase = phase;
+            entry.calls = 0;
+            entry.total = 0;
+            entry.longest = 0;
+            entry.iterations = 0;
+            entry.periods = 0;
+            entry.periodTotal = 0;
+            entry.shortestPeriod = 0;
+            entry.longestPeriod = 0;
+            for(int i = 0; i < BENCH_HISTOGRAM_BUCKETS; i++) {
+                entry.histogram[i] = 0;
+            }
+            entry.lastTick = -1;
+            return count++;
+        }
+
+        /** enter
+            Makes an entry the one control loop iterations are charged to
+            @return The entry that was current before, to hand back to leave()
+        */
+        int enter(int id) {
+            int previous = current;
+            current = id;
+            if(id >= 0) {
+                entries[id].lastTick = -1;
+            }
+            return previous;
+        }
+
+        /** restore
+            Goes back to the entry that was current before enter() without recording anything
+        */
+        void restore(int previous) {
+            current = previous;
+        }
+
+        /** leave
+            Records one call of an entry and goes back to the entry that called it
+        */
+        void leave(int id, int previous, double seconds) {
+            current = previous;
+            if(previous >= 0) {
+                //Don't count the time spent in this call as one long iteration of the caller's loop
+                entries[previous].lastTick = -1;
+            }
+            if(id < 0) {
+                return;
+            }
+            BenchEntry &entry = entries[id];
+            entry.calls++;
+            entry.total += seconds;
+            if(seconds > entry.longest) {
+                entry.longest = seconds;
+            }
+        }
+
+        /** tick
+            Records one control loop iteration for the current entry
+            @param now Time the iteration started (in seconds)
+        */
+        void tick(double now) {
+            if(current < 0) {
+                return;
+            }
+            BenchEntry &entry = entries[current];
+            if(entry.lastTick >= 0) {
+                double period = now - entry.lastTick;
+                entry.periods++;
+                entry.periodTotal += period;
+                if(entry.shortestPeriod == 0 || period < entry.shortestPeriod) {
+                    entry.shortestPeriod = period;
+                }
+                if(period > entry.longestPeriod) {
+                    entry.longestPeriod = period;
+                }
+                int bucket = 0;
+                double limit = BENCH_HISTOGRAM_BASE;
+                while(period >= limit && bucket < BENCH_HISTOGRAM_BUCKETS - 1) {
+                    limit *= 2;
+                    bucket++;
+                }
+                entry.histogram[bucket]++;
+            }
+            entry.iterations++;
+            entry.lastTick = now;
+        }
+
+        /** setPhaseHook
+            Has a function called whenever a timed phase starts or returns, so a host runner can follow
+            the mission. Phases only report this when BENCHMARK is defined.
+        */
+        void setPhaseHook(BenchPhaseHook hook) {
+            phaseHook = hook;
+        }
+
+        /** phaseEvent
+            Calls the phase hook if the entry is a phase
+        */
+        void phaseEvent(int id, bool starting) {
+            if(phaseHook && id >= 0 && entries[id].phase) {
+                phaseHook(id, starting);
+            }
+        }
+
+        void recordSection(BenchSection section, double seconds) {
+            sections[section].calls++;
+            sections[section].total += seconds;
+        }
+
+        /** addCounter
+            Adds a named counter, called once per counter the first time it counts
+            @return Index of the new counter
+        */
+        int addCounter(const char *name) {
+            if(counterCount >= BENCH_MAX_COUNTERS) {
+                return -1;
+            }
+            counters[counterCount].name = name;
+            counters[counterCount].count = 0;
+            return counterCount++;
+        }
+
+        void increment(int id) {
+            if(id >= 0) {
+                counters[id].count++;
+            }
+        }
+
+        int getCount() const {
+            return count;
+        }
+
+        /** getCurrent
+            @return Index of the innermost phase or primitive running, or -1 if there is none
+        */
+        int getCurrent() const {
+            return current;
+        }
+
+        const BenchEntry &getEntry(int i) const {
+            return entries[i];
+        }
+
+        const BenchSectionTime &getSection(BenchSection section) const {
+            return sections[section];
+        }
+
+        int getCounterCount() const {
+            return counterCount;
+        }
+
+        const BenchCounter &getCounter(int i) const {
+            return counters[i];
+        }
+
+        /** report
+            Writes the phase times, the loop rate of each primitive, the hardware call times and the
+            counters to the LCD
+        */
+        void report() {
+            for(int i = 0; i < count; i++) {
+                const BenchEntry &entry = entries[i];
+                LCD.Write(entry.name);
+                LCD.Write(" x");
+                LCD.Write(entry.calls);
+                LCD.Write(" s ");
+                LCD.WriteLine((float)entry.total);
+                if(entry.periods > 0) {
+                    LCD.Write("  Hz ");
+                    LCD.Write((float)(entry.periods / entry.periodTotal));
+                    LCD.Write(" ms ");
+                    LCD.Write((float)(entry.shortestPeriod * 1000));
+                    LCD.Write("-");
+                    LCD.WriteLine((float)(entry.longestPeriod * 1000));
+                }
+            }
+            static const char *SECTION_NAMES[BENCH_SECTIONS] = {"Encoders", "Digital", "Analog", "RPS", "LCD", "Recorder"};
+            for(int i = 0; i < BENCH_SECTIONS; i++) {
+                LCD.Write(SECTION_NAMES[i]);
+                LCD.Write(" x");
+                LCD.Write((int)sections[i].calls);
+                LCD.Write(" s ");
+                LCD.WriteLine((float)sections[i].total);
+            }
+            for(int i = 0; i < counterCount; i++) {
+                LCD.Write(counters[i].name);
+                LCD.Write(": ");
+                LCD.WriteLine((int)counters[i].count);
+            }
+        }
+
+    private:
+        BenchEntry entries[BENCH_MAX_ENTRIES];
+        int count;
+        int current;
+        BenchSectionTime sections[BENCH_SECTIONS];
+        BenchCounter counters[BENCH_MAX_COUNTERS];
+        int counterCount;
+        BenchPhaseHook phaseHook;
+};
+
+/**
+ * This is a class which times the function it is declared in and records it when the function returns.
+ */
+class BenchScope
+{
+    public:
+        BenchScope(Bench &bench, int id) : bench(bench) {
+            this->id = id;
+            previous = bench.enter(id);
+            start = TimeNow();
+            bench.phaseEvent(id, true);
+        }
+
+        ~BenchScope() {
+            bench.phaseEvent(id, false);
+            bench.leave(id, previous, TimeNow() - start);
+        }
+
+    private:
+        Bench &bench;
+        int id;
+        int previous;
+        double start;
+};
+
+/**
+ * This is a class which marks the function it is declared in as running until it returns, without timing it.
+ */
+class BenchTag
+{
+    public:
+        BenchTag(Bench &bench, int id) : bench(bench) {
+            previous = bench.enter(id);
+        }
+
+        ~BenchTag() {
+            bench.restore(previous);
+        }
+
+    private:
+        Bench &bench;
+        int previous;
+};
+
+/**
+ * This is a class which times the block it is declared in as one hardware call.
+ */
+class BenchSectionScope
+{
+    public:
+        BenchSectionScope(Bench &bench, BenchSection section) : bench(bench) {
+            this->section = section;
+            start = TimeNow();
+        }
+
+        ~BenchSectionScope() {
+            bench.recordSection(section, TimeNow() - start);
+        }
+
+    private:
+        Bench &bench;
+        BenchSection section;
+        double start;
+};
+
+extern Bench bench;
+
+#ifdef BENCHMARK
+#define BENCH_PHASE() static const int benchId = bench.add(__func__, true); BenchScope benchScope(bench, benchId)
+#define BENCH_PRIMITIVE() static const int benchId = bench.add(__func__, false); BenchScope benchScope(bench, benchId)
+#define BENCH_TICK(now) bench.tick(now)
+#define BENCH_SECTION(section) BenchSectionScope benchSection(bench, section)
+#define BENCH_COUNT(name) do { static const int benchCounter = bench.addCounter(name); bench.increment(benchCounter); } while(0)
+#define BENCH_REPORT() bench.report()
+#else
+#define BENCH_PHASE() static const int benchId = bench.add(__func__, true); BenchTag benchTag(bench, benchId)
+#define BENCH_PRIMITIVE() static const int benchId = bench.add(__func__, false); BenchTag benchTag(bench, benchId)
+#define BENCH_TICK(now) ((void)0)
+#define BENCH_SECTION(section) ((void)0)
+#define BENCH_COUNT(name) ((void)0)
+#define BENCH_REPORT() ((void)0)
+#endif
+
+#endif
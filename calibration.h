@@ -0,0 +1,205 @@
+#ifndef CALIBRATION_H
+#define CALIBRATION_H
+
+#include <FEHSD.h>
+#include <math.h>
+
+//File on the SD card the fitted constants are kept in
+#define CALIBRATION_FILE "CALIB.TXT"
+#define CALIBRATION_VERSION 1
+//Fitted constants further than this fraction from the defaults are taken to be a bad run or a bad file
+#define CALIBRATION_MAX_CHANGE 0.2
+
+/**
+ * This is a struct which holds the constants that turn encoder counts into distances and angles.
+ */
+struct OdometryConstants
+{
+    float countsPerInch;
+    //Counts each wheel turns per degree the robot turns in place, turning left and turning right
+    float leftCountsPerDegree;
+    float rightCountsPerDegree;
+};
+
+/**
+ * This is a class which fits y = slope * x to a set of samples by least squares. The line goes through
+ * the origin since no distance means no counts.
+ */
+class RatioFit
+{
+    public:
+        RatioFit() {
+            clear();
+        }
+
+        void clear() {
+            count = 0;
+            sumXX = 0;
+            sumXY = 0;
+            sumYY = 0;
+        }
+
+        /** add
+            @param x What RPS measured
+            @param y What the encoders counted
+        */
+        void add(float x, float y) {
+            count++;
+            sumXX += (double)x * x;
+            sumXY += (double)x * y;
+            sumYY += (double)y * y;
+        }
+
+        int getCount() const {
+            return count;
+        }
+
+        /** slope
+            @return The slope that minimises the squared error, or 0 without any samples
+        */
+        float slope() const {
+            return sumXX > 0 ? sumXY / sumXX : 0;
+        }
+
+        /** residual
+            @return Root mean square of the samples' distance from the fitted line (in y's units)
+        */
+        float residual() const {
+            if(count == 0 || sumXX <= 0) {
+                return 0;
+            }
+            //Sum of (y - slope * x)^2 expanded, so the samples don't need to be kept
+            double squares = sumYY - sumXY * sumXY / sumXX;
+            return squares > 0 ? sqrt(squares / count) : 0;
+        }
+
+    private:
+        int count;
+        double sumXX;
+        double sumXY;
+        double sumYY;
+};
+
+/**
+ * This is a class which collects calibration drives and fits the odometry constants to them.
+ *
+ * Each straight drive gives the counts the wheels turned against the distance RPS saw the robot move, and
+ * each turn in place the counts against the change in RPS heading. Left and right turns are fitted on
+ * their own since the robot turns unevenly. The constants are kept on the SD card so the robot loads them
+ * at startup instead of using the hard-coded ones.
+ */
+class OdometryCalibration
+{
+    public:
+        /** addStraight
+            @param inches Distance RPS saw the robot move
+            @param counts Average of the two encoders' counts over the drive
+        */
+        void addStraight(float inches, float counts) {
+            straight.add(fabs(inches), counts);
+        }
+
+        /** addTurn
+            @param degrees Change in RPS heading, positive for a left turn
+            @param counts Average of the two encoders' counts over the turn
+        */
+        void addTurn(float degrees, float counts) {
+            if(degrees > 0) {
+                left.add(degrees, counts);
+            }
+            else {
+                right.add(-degrees, counts);
+            }
+        }
+
+        /** fit
+            Replaces each constant that has samples with the fitted one, unless the fit is too far from the
+            constant it replaces to be trusted
+            @param constants Constants to update
+            @return false if a fitted constant was rejected
+        */
+        bool fit(OdometryConstants &constants) const {
+            bool ok = true;
+            ok = replace(constants.countsPerInch, straight) && ok;
+            ok = replace(constants.leftCountsPerDegree, left) && ok;
+            ok = replace(constants.rightCountsPerDegree, right) && ok;
+            return ok;
+        }
+
+        const RatioFit &getStraight() const {
+            return straight;
+        }
+
+        const RatioFit &getLeft() const {
+            return left;
+        }
+
+        const RatioFit &getRight() const {
+            return right;
+        }
+
+        /** load
+            Reads constants saved by save(), keeping the defaults if there is no file or it looks wrong
+            @param constants Set to the saved constants
+            @param filename File to read
+            @return true if the saved constants were loaded
+        */
+        static bool load(OdometryConstants &constants, const char *filename = CALIBRATION_FILE) {
+            FEHFile *file = SD.FOpen(filename, "r");
+            if(!file) {
+                return false;
+            }
+            int version = 0;
+            OdometryConstants saved;
+            int read = SD.FScanf(file, "CALIB %d %f %f %f", &version, &saved.countsPerInch,
+                                 &saved.leftCountsPerDegree, &saved.rightCountsPerDegree);
+            SD.FClose(file);
+            if(read != 4 || version != CALIBRATION_VERSION ||
+               !close(saved.countsPerInch, constants.countsPerInch) ||
+               !close(saved.leftCountsPerDegree, constants.leftCountsPerDegree) ||
+               !close(saved.rightCountsPerDegree, constants.rightCountsPerDegree)) {
+                return false;
+            }
+            constants = saved;
+            return true;
+        }
+
+        /** save
+            Writes constants to the SD card for load() to read at the next startup
+            @param constants Constants to save
+            @param filename File to write
+            @return false if the file couldn't be opened
+        */
+        static bool save(const OdometryConstants &constants, const char *filename = CALIBRATION_FILE) {
+            FEHFile *file = SD.FOpen(filename, "w");
+            if(!file) {
+                return false;
+            }
+            SD.FPrintf(file, "CALIB %d %f %f %f\n", CALIBRATION_VERSION, constants.countsPerInch,
+                       constants.leftCountsPerDegree, constants.rightCountsPerDegree);
+            SD.FClose(file);
+            return true;
+        }
+
+    private:
+        static bool close(float value, float reference) {
+            return fabs(value - reference) <= CALIBRATION_MAX_CHANGE * reference;
+        }
+
+        static bool replace(float &constant, const RatioFit &fit) {
+            if(fit.getCount() == 0) {
+                return true;
+            }
+            if(!close(fit.slope(), constant)) {
+                return false;
+            }
+            constant = fit.slope();
+            return true;
+        }
+
+        RatioFit straight;
+        RatioFit left;
+        RatioFit right;
+};
+
+#endif
@@ -0,0 +1,517 @@
+#ifndef COURSEMAP_H
+#define COURSEMAP_H
+
+#include "locations.h"
+#include "geometry.h"
+#include "linefollower.h"
+#include "pursuit.h"
+
+//Course size (in inches)
+#define COURSE_WIDTH 36
+#define COURSE_LENGTH 72
+//Closest a path between waypoints may come to a wall, half the width of the robot (in inches)
+#define MAP_CLEARANCE 2.5
+//Where the lines up the side ramp and to the fuel light are painted
+#define SIDE_RAMP_LINE_X 31.2
+#define SIDE_RAMP_LINE_Y 24.2
+#define FUEL_LINE_X 26.25
+
+/**
+ * This is a struct which holds a straight piece of wall or line on the course.
+ */
+struct MapSegment
+{
+    float x1, y1, x2, y2;
+};
+
+/**
+ * This is a struct which holds a point on the course.
+ */
+struct MapPoint
+{
+    float x;
+    float y;
+};
+
+/**
+ * This is a struct which holds a line painted on the course.
+ */
+struct MapLine
+{
+    MapSegment segment;
+    LineColor color;
+};
+
+constexpr MapSegment COURSE_WALLS[] = {
+    //Outside walls
+    {0, 0, COURSE_WIDTH, 0},
+    {COURSE_WIDTH, 0, COURSE_WIDTH, COURSE_LENGTH},
+    {COURSE_WIDTH, COURSE_LENGTH, 0, COURSE_LENGTH},
+    {0, COURSE_LENGTH, 0, 0},
+    //Wall at the top of the side ramp
+    {30, 55, COURSE_WIDTH, 55},
+    //Side of the fuel light alcove
+    {22, 46, 22, 53},
+    //Fuel buttons
+    {18, 66, COURSE_WIDTH, 66},
+    //Drop off wall
+    {0, 58, 14, 58},
+    //Switch wall
+    {0, 38, 14, 38}
+};
+
+//Lines sit where the robot's center is when it drives along them. The robot is 4.25 inches from its
+//center to a wall it is pressed against, so the side ramp line is inside of TOP_SIDE_RAMP_X and the
+//fuel light is straight ahead of where the robot stops against the alcove wall.
+constexpr MapLine COURSE_LINES[] = {
+    {{27, SIDE_RAMP_LINE_Y, 35.5, SIDE_RAMP_LINE_Y}, BLACK_LINE},
+    {{SIDE_RAMP_LINE_X, SIDE_RAMP_LINE_Y, SIDE_RAMP_LINE_X, 55}, BLACK_LINE},
+    {{FUEL_LINE_X, 50, FUEL_LINE_X, Location::FUEL_LIGHT_Y}, YELLOW_LINE},
+    {{Location::MID_SWITCH_X, 38, Location::MID_SWITCH_X, 56}, YELLOW_LINE}
+};
+
+constexpr MapSegment COURSE_RAMPS[] = {
+    {Location::BOTTOM_SIDE_RAMP_X, Location::BOTTOM_SIDE_RAMP_Y, Location::TOP_SIDE_RAMP_X, Location::TOP_SIDE_RAMP_Y},
+    {Location::BOT_MAIN_RAMP_X, Location::BOT_MAIN_RAMP_Y, Location::TOP_MAIN_RAMP_X, Location::TOP_MAIN_RAMP_Y}
+};
+
+constexpr int COURSE_WALL_COUNT = sizeof(COURSE_WALLS) / sizeof(COURSE_WALLS[0]);
+constexpr int COURSE_LINE_COUNT = sizeof(COURSE_LINES) / sizeof(COURSE_LINES[0]);
+constexpr int COURSE_RAMP_COUNT = sizeof(COURSE_RAMPS) / sizeof(COURSE_RAMPS[0]);
+
+/**
+ * Points the robot measures with RPS before the run, since RPS is off by a different amount on each
+ * course. Waypoints tied to one of them move with it.
+ */
+enum CourseAnchor
+{
+    ANCHOR_MAP,
+    ANCHOR_START,
+    ANCHOR_SUPPLIES,
+    ANCHOR_DROP_OFF,
+    ANCHOR_COUNT
+};
+
+/**
+ * Waypoints the robot drives between.
+ */
+enum CourseNode
+{
+    NODE_START,
+    //Off to the side of the supplies, so the robot curves round onto them
+    NODE_SUPPLIES_BEND,
+    NODE_SUPPLIES_ABOVE,
+    //Where the robot stops facing down to pick up the supplies
+    NODE_SUPPLIES,
+    NODE_SIDE_RAMP_BOTTOM,
+    NODE_SIDE_RAMP_TOP,
+    NODE_MAIN_RAMP_BOTTOM,
+    NODE_MAIN_RAMP_TOP,
+    //Where the robot stops on the fuel line to read the light and push the buttons
+    NODE_FUEL_BUTTONS,
+    //Far enough below the alcove wall to turn off the fuel line
+    NODE_ALCOVE_EXIT,
+    //Over the top of the alcove wall, so the robot backs round it to the drop off instead of down and back up
+    NODE_ALCOVE_TOP,
+    //Where the robot turns to drive up to the drop off wall, which depends on the fuel light
+    NODE_DROP_OFF_RED,
+    NODE_DROP_OFF_BLUE,
+    NODE_MID_SWITCH,
+    NODE_COUNT
+};
+
+/**
+ * This is a struct which holds where a waypoint is, as an offset from the point it is tied to.
+ */
+struct MapNode
+{
+    CourseAnchor anchor;
+    float dx;
+    float dy;
+};
+
+constexpr MapPoint ANCHOR_POINTS[ANCHOR_COUNT] = {
+    {0, 0},
+    {Location::START_X, Location::START_Y},
+    {Location::SUPPLIES_X, Location::SUPPLIES_Y},
+    {Location::DROP_OFF_X, Location::DROP_OFF_Y}
+};
+
+constexpr MapNode COURSE_NODES[NODE_COUNT] = {
+    {ANCHOR_START, 0, 0},
+    {ANCHOR_SUPPLIES, -4, 8},
+    {ANCHOR_SUPPLIES, 0, 6},
+    {ANCHOR_SUPPLIES, 0, 1.2},
+    {ANCHOR_MAP, Location::BOTTOM_SIDE_RAMP_X, Location::BOTTOM_SIDE_RAMP_Y},
+    {ANCHOR_MAP, Location::TOP_SIDE_RAMP_X, Location::TOP_SIDE_RAMP_Y},
+    {ANCHOR_MAP, Location::BOT_MAIN_RAMP_X, Location::BOT_MAIN_RAMP_Y},
+    {ANCHOR_MAP, Location::TOP_MAIN_RAMP_X, Location::TOP_MAIN_RAMP_Y},
+    {ANCHOR_MAP, FUEL_LINE_X, Location::FUEL_LIGHT_Y - 4.1},
+    {ANCHOR_MAP, FUEL_LINE_X, 41},
+    {ANCHOR_MAP, 18.5, 56.5},
+    {ANCHOR_DROP_OFF, 0, 1.5},
+    {ANCHOR_DROP_OFF, 0, -0.5},
+    {ANCHOR_MAP, Location::MID_SWITCH_X, Location::MID_SWITCH_Y}
+};
+
+/**
+ * Pairs of waypoints the robot can drive straight between. A waypoint that should only be reached from
+ * one direction, like the supplies, only has an edge from that side.
+ */
+constexpr CourseNode COURSE_EDGES[][2] = {
+    {NODE_START, NODE_SUPPLIES_BEND},
+    {NODE_SUPPLIES_BEND, NODE_SUPPLIES_ABOVE},
+    {NODE_SUPPLIES_ABOVE, NODE_SUPPLIES},
+    {NODE_SUPPLIES_ABOVE, NODE_SIDE_RAMP_BOTTOM},
+    {NODE_START, NODE_MAIN_RAMP_BOTTOM},
+    {NODE_SIDE_RAMP_BOTTOM, NODE_MAIN_RAMP_BOTTOM},
+    {NODE_SIDE_RAMP_BOTTOM, NODE_SIDE_RAMP_TOP},
+    {NODE_MAIN_RAMP_BOTTOM, NODE_MAIN_RAMP_TOP},
+    {NODE_SIDE_RAMP_TOP, NODE_MAIN_RAMP_TOP},
+    {NODE_MAIN_RAMP_TOP, NODE_ALCOVE_EXIT},
+    {NODE_ALCOVE_EXIT, NODE_FUEL_BUTTONS},
+    {NODE_ALCOVE_EXIT, NODE_DROP_OFF_RED},
+    {NODE_ALCOVE_EXIT, NODE_DROP_OFF_BLUE},
+    {NODE_FUEL_BUTTONS, NODE_ALCOVE_TOP},
+    {NODE_ALCOVE_TOP, NODE_DROP_OFF_RED},
+    {NODE_ALCOVE_TOP, NODE_DROP_OFF_BLUE},
+    {NODE_ALCOVE_EXIT, NODE_MID_SWITCH},
+    {NODE_MID_SWITCH, NODE_DROP_OFF_BLUE},
+    {NODE_DROP_OFF_RED, NODE_DROP_OFF_BLUE}
+};
+
+constexpr int COURSE_EDGE_COUNT = sizeof(COURSE_EDGES) / sizeof(COURSE_EDGES[0]);
+
+/** nodeX
+    @return Where a waypoint is on the map, before any RPS measurements
+*/
+constexpr float nodeX(int node) {
+    return ANCHOR_POINTS[COURSE_NODES[node].anchor].x + COURSE_NODES[node].dx;
+}
+
+constexpr float nodeY(int node) {
+    return ANCHOR_POINTS[COURSE_NODES[node].anchor].y + COURSE_NODES[node].dy;
+}
+
+/**
+ * This is a class which holds the shortest route between every pair of waypoints, worked out at compile
+ * time with Floyd-Warshall so finding a route on the robot is a table lookup.
+ *
+ * next(from, to) is the first waypoint after from on the way to to, so a route is read off by following
+ * next() until it reaches to. departure() and arrival() are the headings of the first and last straight
+ * of the route.
+ */
+class CourseGraph
+{
+    public:
+        //Distance between waypoints that aren't connected
+        static constexpr float UNREACHABLE = 1e9f;
+
+        constexpr CourseGraph() : distances(), hops(), departures(), arrivals() {
+            for(int i = 0; i < NODE_COUNT; i++) {
+                for(int j = 0; j < NODE_COUNT; j++) {
+                    distances[i][j] = i == j ? 0 : UNREACHABLE;
+                    hops[i][j] = j;
+                }
+            }
+            for(int e = 0; e < COURSE_EDGE_COUNT; e++) {
+                int a = COURSE_EDGES[e][0];
+                int b = COURSE_EDGES[e][1];
+                float dx = nodeX(b) - nodeX(a);
+                float dy = nodeY(b) - nodeY(a);
+                distances[a][b] = distances[b][a] = root(dx * dx + dy * dy);
+            }
+            for(int k = 0; k < NODE_COUNT; k++) {
+                for(int i = 0; i < NODE_COUNT; i++) {
+                    for(int j = 0; j < NODE_COUNT; j++) {
+                        if(distances[i][k] + distances[k][j] < distances[i][j]) {
+                            distances[i][j] = distances[i][k] + distances[k][j];
+                            hops[i][j] = hops[i][k];
+                        }
+                    }
+                }
+            }
+            for(int i = 0; i < NODE_COUNT; i++) {
+                for(int j = 0; j < NODE_COUNT; j++) {
+                    int first = hops[i][j];
+                    departures[i][j] = fastAtan2(nodeY(first) - nodeY(i), nodeX(first) - nodeX(i));
+                    //Walk the route to find the waypoint before the last one
+                    int last = i;
+                    for(int steps = 0; hops[last][j] != j && steps < NODE_COUNT; steps++) {
+                        last = hops[last][j];
+                    }
+                    arrivals[i][j] = fastAtan2(nodeY(j) - nodeY(last), nodeX(j) - nodeX(last));
+                }
+            }
+        }
+
+        /** distance
+            @return Length of the shortest route between two waypoints (in inches), or UNREACHABLE
+        */
+        constexpr float distance(int from, int to) const {
+            return distances[from][to];
+        }
+
+        /** next
+            @return The first waypoint after from on the shortest route to to
+        */
+        constexpr int next(int from, int to) const {
+            return hops[from][to];
+        }
+
+        /** departure
+            @return Heading of the first straight of the route from one waypoint to another
+        */
+        constexpr float departure(int from, int to) const {
+            return departures[from][to];
+        }
+
+        /** arrival
+            @return Heading of the last straight of the route from one waypoint to another
+        */
+        constexpr float arrival(int from, int to) const {
+            return arrivals[from][to];
+        }
+
+        /** hopCount
+            @return Number of waypoints on the route after from, including to
+        */
+        constexpr int hopCount(int from, int to) const {
+            int count = 0;
+            while(from != to && count < NODE_COUNT) {
+                from = hops[from][to];
+                count++;
+            }
+            return count;
+        }
+
+        /** passes
+            @return true if the route from one waypoint to another goes through a third
+        */
+        constexpr bool passes(int from, int to, int via) const {
+            for(int count = 0; from != to && count < NODE_COUNT; count++) {
+                from = hops[from][to];
+                if(from == via) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+    private:
+        static constexpr float root(float value) {
+            float guess = value > 1 ? value : 1;
+            for(int i = 0; i < 20; i++) {
+                guess = (guess + value / guess) / 2;
+            }
+            return guess;
+        }
+
+        float distances[NODE_COUNT][NODE_COUNT];
+        int hops[NODE_COUNT][NODE_COUNT];
+        float departures[NODE_COUNT][NODE_COUNT];
+        float arrivals[NODE_COUNT][NODE_COUNT];
+};
+
+constexpr CourseGraph courseGraph;
+
+/** squaredPointDistance
+    @return Squared distance from a point to the closest point on a segment
+*/
+constexpr float squaredPointDistance(float x, float y, const MapSegment &s) {
+    float sx = s.x2 - s.x1;
+    float sy = s.y2 - s.y1;
+    float lengthSquared = sx * sx + sy * sy;
+    float t = lengthSquared > 0 ? ((x - s.x1) * sx + (y - s.y1) * sy) / lengthSquared : 0;
+    t = t < 0 ? 0 : (t > 1 ? 1 : t);
+    float dx = s.x1 + t * sx - x;
+    float dy = s.y1 + t * sy - y;
+    return dx * dx + dy * dy;
+}
+
+/** squaredSegmentDistance
+    @return Squared distance between the closest points of two segments, 0 if they cross
+*/
+constexpr float squaredSegmentDistance(const MapSegment &a, const MapSegment &b) {
+    float d1 = (b.x2 - b.x1) * (a.y1 - b.y1) - (b.y2 - b.y1) * (a.x1 - b.x1);
+    float d2 = (b.x2 - b.x1) * (a.y2 - b.y1) - (b.y2 - b.y1) * (a.x2 - b.x1);
+    float d3 = (a.x2 - a.x1) * (b.y1 - a.y1) - (a.y2 - a.y1) * (b.x1 - a.x1);
+    float d4 = (a.x2 - a.x1) * (b.y2 - a.y1) - (a.y2 - a.y1) * (b.x2 - a.x1);
+    if(((d1 > 0 && d2 < 0) || (d1 < 0 && d2 > 0)) && ((d3 > 0 && d4 < 0) || (d3 < 0 && d4 > 0))) {
+        return 0;
+    }
+    float closest = squaredPointDistance(a.x1, a.y1, b);
+    float other = squaredPointDistance(a.x2, a.y2, b);
+    closest = other < closest ? other : closest;
+    other = squaredPointDistance(b.x1, b.y1, a);
+    closest = other < closest ? other : closest;
+    other = squaredPointDistance(b.x2, b.y2, a);
+    return other < closest ? other : closest;
+}
+
+/** edgesClearWalls
+    @return true if every edge stays MAP_CLEARANCE away from every wall
+*/
+constexpr bool edgesClearWalls() {
+    for(int e = 0; e < COURSE_EDGE_COUNT; e++) {
+        MapSegment edge = {nodeX(COURSE_EDGES[e][0]), nodeY(COURSE_EDGES[e][0]),
+                           nodeX(COURSE_EDGES[e][1]), nodeY(COURSE_EDGES[e][1])};
+        for(int w = 0; w < COURSE_WALL_COUNT; w++) {
+            if(squaredSegmentDistance(edge, COURSE_WALLS[w]) < MAP_CLEARANCE * MAP_CLEARANCE) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/** allConnected
+    @return true if there is a route between every pair of waypoints, the same length both ways
+*/
+constexpr bool allConnected() {
+    for(int i = 0; i < NODE_COUNT; i++) {
+        for(int j = 0; j < NODE_COUNT; j++) {
+            float there = courseGraph.distance(i, j);
+            float back = courseGraph.distance(j, i);
+            if(there >= CourseGraph::UNREACHABLE || there - back > 0.001f || back - there > 0.001f) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/** insideCourse
+    @return true if a point is on the course
+*/
+constexpr bool insideCourse(float x, float y) {
+    return x >= 0 && x <= COURSE_WIDTH && y >= 0 && y <= COURSE_LENGTH;
+}
+
+/** mapInsideCourse
+    @return true if every waypoint, line and ramp is on the course
+*/
+constexpr bool mapInsideCourse() {
+    for(int i = 0; i < NODE_COUNT; i++) {
+        if(!insideCourse(nodeX(i), nodeY(i))) {
+            return false;
+        }
+    }
+    for(int i = 0; i < COURSE_LINE_COUNT; i++) {
+        const MapSegment &s = COURSE_LINES[i].segment;
+        if(!insideCourse(s.x1, s.y1) || !insideCourse(s.x2, s.y2)) {
+            return false;
+        }
+    }
+    for(int i = 0; i < COURSE_RAMP_COUNT; i++) {
+        const MapSegment &s = COURSE_RAMPS[i];
+        if(!insideCourse(s.x1, s.y1) || !insideCourse(s.x2, s.y2)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/** rampsDrivable
+    @return true if the waypoints at both ends of each ramp are joined by an edge
+*/
+constexpr bool rampsDrivable() {
+    for(int r = 0; r < COURSE_RAMP_COUNT; r++) {
+        bool found = false;
+        for(int e = 0; e < COURSE_EDGE_COUNT; e++) {
+            int a = COURSE_EDGES[e][0];
+            int b = COURSE_EDGES[e][1];
+            if(nodeX(a) == COURSE_RAMPS[r].x1 && nodeY(a) == COURSE_RAMPS[r].y1 &&
+               nodeX(b) == COURSE_RAMPS[r].x2 && nodeY(b) == COURSE_RAMPS[r].y2) {
+                found = true;
+            }
+        }
+        if(!found) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static_assert(COURSE_EDGE_COUNT + 1 >= NODE_COUNT, "Too few edges to connect every waypoint");
+static_assert(mapInsideCourse(), "A waypoint, line or ramp is off the course");
+static_assert(edgesClearWalls(), "An edge passes closer than MAP_CLEARANCE to a wall");
+static_assert(allConnected(), "Every waypoint should be reachable from every other");
+static_assert(rampsDrivable(), "Each ramp should be an edge between two waypoints");
+static_assert(courseGraph.passes(NODE_START, NODE_SUPPLIES, NODE_SUPPLIES_ABOVE),
+              "The supplies should be reached from above");
+static_assert(courseGraph.arrival(NODE_START, NODE_SUPPLIES) > 269 && courseGraph.arrival(NODE_START, NODE_SUPPLIES) < 271,
+              "The robot should arrive at the supplies facing 270");
+static_assert(courseGraph.passes(NODE_FUEL_BUTTONS, NODE_DROP_OFF_RED, NODE_ALCOVE_TOP) &&
+              courseGraph.passes(NODE_FUEL_BUTTONS, NODE_DROP_OFF_BLUE, NODE_ALCOVE_TOP),
+              "The robot should back over the alcove wall to the drop off");
+static_assert(courseGraph.hopCount(NODE_FUEL_BUTTONS, NODE_DROP_OFF_RED) <= MAX_WAYPOINTS &&
+              courseGraph.hopCount(NODE_START, NODE_SUPPLIES) <= MAX_WAYPOINTS,
+              "Routes the robot drives have to fit in followPath()'s waypoint list");
+
+/**
+ * This is a class which turns the compile-time course map into points on the course the robot is on,
+ * moving the waypoints tied to each anchor by however far RPS measured that anchor from the map.
+ */
+class CourseMap
+{
+    public:
+        CourseMap() {
+            for(int i = 0; i < ANCHOR_COUNT; i++) {
+                offsetX[i] = 0;
+                offsetY[i] = 0;
+            }
+        }
+
+        /** locate
+            Moves an anchor, and the waypoints tied to it, to where it was measured
+            @param anchor Point that was measured
+            @param x Where RPS put it
+            @param y Where RPS put it
+        */
+        void locate(CourseAnchor anchor, float x, float y) {
+            offsetX[anchor] = x - ANCHOR_POINTS[anchor].x;
+            offsetY[anchor] = y - ANCHOR_POINTS[anchor].y;
+        }
+
+        /** forget
+            Puts an anchor back where the map has it
+        */
+        void forget(CourseAnchor anchor) {
+            offsetX[anchor] = 0;
+            offsetY[anchor] = 0;
+        }
+
+        /** point
+            @return Where a waypoint is on this course
+        */
+        Waypoint point(CourseNode node) const {
+            CourseAnchor anchor = COURSE_NODES[node].anchor;
+            Waypoint point = {nodeX(node) + offsetX[anchor], nodeY(node) + offsetY[anchor]};
+            return point;
+        }
+
+        /** route
+            Looks up the shortest route between two waypoints
+            @param from Waypoint the robot is at, which isn't copied
+            @param to Waypoint to drive to
+            @param points Filled with the waypoints after from, ending with to
+            @param max Most waypoints points can hold
+            @return Number of waypoints copied
+        */
+        int route(CourseNode from, CourseNode to, Waypoint *points, int max) const {
+            int count = 0;
+            int node = from;
+            while(node != to && count < max) {
+                node = courseGraph.next(node, to);
+                points[count++] = point((CourseNode)node);
+            }
+            return count;
+        }
+
+    private:
+        float offsetX[ANCHOR_COUNT];
+        float offsetY[ANCHOR_COUNT];
+};
+
+#endif
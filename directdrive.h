@@ -0,0 +1,975 @@
+#ifndef DIRECTDRIVE_H
+#define DIRECTDRIVE_H
+
+#include <FEHLCD.h>
+#include <FEHIO.h>
+#include <FEHUtility.h>
+#include <FEHMotor.h>
+#include <FEHRPS.h>
+#include <FEHServo.h>
+#include <math.h>
+#include "locations.h"
+#include "linefollower.h"
+#include "bench.h"
+
+/**
+ * This is a class which runs the original unchained program: its primitives write straight to the motors
+ * and busy-wait on the sensors, with no control loop, pose estimate, flight recorder or slew limiting, and
+ * its mission walks between RPS coordinates instead of following routes. It is kept exactly as it drove,
+ * down to every LCD write and Sleep(), so a build of the unchained variant reproduces the original run for
+ * run. The values the two robots are tuned differently on come from the variant's policy (see variant.h).
+ */
+template <class Policy>
+class DirectDrive
+{
+    public:
+        //Constants to convert counts to inches or degrees
+        static constexpr double COUNTS_PER_INCH = 33.74;
+        static constexpr double LEFT_COUNTS_PER_DEGREE = 1.955;
+        static constexpr double RIGHT_COUNTS_PER_DEGREE = 1.88;
+        //Fuel light threshold for the blue light
+        static constexpr double BLUE_LIGHT_ON = 0.75;
+        //Drive-straight PI gains
+        static constexpr double TUNING_CONSTANT = 0.12;
+        static constexpr double I_TUNING_CONSTANT = 0.01;
+        static constexpr int SPEED = 40;
+
+        DirectDrive(FEHMotor::FEHMotorPort leftPort, FEHMotor::FEHMotorPort rightPort, DigitalEncoder &left_encoder,
+                    DigitalEncoder &right_encoder, DigitalInputPin &frontLeftBump, DigitalInputPin &frontRightBump,
+                    AnalogInputPin &left, AnalogInputPin &middle, AnalogInputPin &right, AnalogInputPin &cds1,
+                    AnalogInputPin &cds2, FEHServo &arm)
+            : left_motor(leftPort, 12.0), right_motor(rightPort, 12.0), left_encoder(left_encoder),
+              right_encoder(right_encoder), frontLeftBump(frontLeftBump), frontRightBump(frontRightBump), left(left),
+              middle(middle), right(right), cds1(cds1), cds2(cds2), arm(arm) {
+            accum_error = 0;
+            SUPPLIES_X = 29.35;
+            SUPPLIES_Y = 12.3;
+            DROP_OFF_X = 5.5;
+            DROP_OFF_Y = 49.5;
+        }
+
+        /** run
+            Runs the whole program, from setting the arm up to driving home
+            @return Exit status for main
+        */
+        int run() {
+            initialize();
+            waitForStart();
+            goGoGo();
+            return 0;
+        }
+
+    private:
+        void bumpValues() {
+            LCD.WriteLine(frontLeftBump.Value());
+            LCD.WriteLine(frontRightBump.Value());
+        }
+        void setRPSCoords() {
+            LCD.WriteLine("SUPPLIES");
+            float x, y;
+            while(!LCD.Touch(&x, &y)) {
+                LCD.WriteLine(RPS.X());
+                LCD.WriteLine(RPS.Y());
+                Sleep(50);
+                LCD.Clear();
+            }
+            SUPPLIES_X = RPS.X();
+            SUPPLIES_Y = RPS.Y();
+            LCD.Clear();
+            LCD.WriteLine("DROP OFF");
+            Sleep(1.0);
+            while(!LCD.Touch(&x, &y)) {
+                LCD.WriteLine(RPS.X());
+                LCD.WriteLine(RPS.Y());
+                Sleep(50);
+                LCD.Clear();
+            }
+            DROP_OFF_X = RPS.X();
+        }
+
+
+        /** move_forward
+            Moves the robot forward
+            @param percent Motor percent
+            @param inches Distance robot needs to travel
+        */
+        void move_forward(int percent, float inches) //using encoders
+        {
+            BENCH_PRIMITIVE();
+            //Reset encoder counts
+            right_encoder.ResetCounts();
+            left_encoder.ResetCounts();
+            float counts = inches*COUNTS_PER_INCH;
+            //Set both motors to desired percent
+            right_motor.SetPercent(percent);
+            Sleep(1);
+            left_motor.SetPercent(percent);
+            int mp = percent;
+
+            //While the average of the left and right encoder are less than counts,
+            //keep running motors
+            while((left_encoder.Counts() + right_encoder.Counts()) / 2. < counts && (frontLeftBump.Value() && frontRightBump.Value()) ) {
+                double current_error = (left_encoder.Counts()-right_encoder.Counts());
+                accum_error +=current_error;
+                mp = TUNING_CONSTANT*current_error+I_TUNING_CONSTANT*accum_error+(percent);
+                right_motor.SetPercent(mp);
+                bumpValues();
+            }
+
+            right_motor.SetPercent(-20);
+            left_motor.SetPercent(-20);
+            Sleep(100);
+            //Turn off motors
+            right_motor.Stop();
+            left_motor.Stop();
+        }
+
+        /** move_forward_timed
+            Moves the robot forward, stopping when a certain time is reached or a distance is met
+            @param percent Motor percent
+            @param inches Distance robot needs to travel
+            @param time Time robot should be moving (in seconds)
+        */
+        void move_forward_timed(int percent, float inches, double time) //using encoders
+        {
+            BENCH_PRIMITIVE();
+            //Reset encoder counts
+            right_encoder.ResetCounts();
+            left_encoder.ResetCounts();
+            float counts = inches*COUNTS_PER_INCH;
+            //Set both motors to desired percent
+            right_motor.SetPercent(percent);
+            left_motor.SetPercent(percent);
+
+            //While the average of the left and right encoder are less than counts,
+            //keep running motors
+            double start_time = TimeNow();
+            while((left_encoder.Counts() + right_encoder.Counts()) / 2. < counts && TimeNow() - start_time < time && (frontLeftBump.Value() && frontRightBump.Value())) {
+        //        double current_error = (left_encoder.Counts()-right_encoder.Counts());
+        //        accum_error +=current_error;
+        //        mp = TUNING_CONSTANT*current_error+I_TUNING_CONSTANT*accum_error+(percent);
+        //        right_motor.SetPercent(mp);
+        //        bumpValues();
+            }
+
+            //Turn off motors
+            right_motor.Stop();
+            left_motor.Stop();
+        }
+        void pivot_right(int percent, float degrees) {
+            BENCH_PRIMITIVE();
+            //Reset encoder counts
+            right_encoder.ResetCounts();
+            left_encoder.ResetCounts();
+            float counts = degrees * LEFT_COUNTS_PER_DEGREE * 1.05;
+            left_motor.SetPercent(percent);
+            right_motor.SetPercent((-percent) * 0.7);
+            while((right_encoder.Counts() + left_encoder.Counts())/2. < counts);
+
+            //Turn off motors
+            right_motor.Stop();
+            left_motor.Stop();
+        }
+
+        /** move_backwards
+            Moves the robot backwards
+            @param percent Motor percent
+            @param inches Distance robot needs to travel
+        */
+        void move_backwards(int percent, float inches) //using encoders
+        {
+            BENCH_PRIMITIVE();
+            //Reset encoder counts
+            right_encoder.ResetCounts();
+            left_encoder.ResetCounts();
+            float counts = inches*COUNTS_PER_INCH;
+            //Set both motors to desired percent
+            right_motor.SetPercent(-1*percent);
+            left_motor.SetPercent(-1*percent);
+            int mp = percent;
+            //While the average of the left and right encoder are less than counts,
+            //keep running motors
+             while((left_encoder.Counts() + right_encoder.Counts()) / 2. < counts) {
+                 mp = TUNING_CONSTANT*(left_encoder.Counts()-right_encoder.Counts())+(percent);
+                 mp *= -1;
+                 right_motor.SetPercent(mp);
+             }
+
+            //Turn off motors
+            right_motor.Stop();
+            left_motor.Stop();
+        }
+        /** move_backwards_timed
+            Moves the robot backwards, stopping when a certain time is reached or a distance is met
+            @param percent Motor percent
+            @param inches Distance robot needs to travel
+            @param time Time robot should be moving (in seconds)
+        */
+        void move_backwards_timed(int percent, float inches, float time) //using encoders
+        {
+            BENCH_PRIMITIVE();
+            //Reset encoder counts
+            right_encoder.ResetCounts();
+            left_encoder.ResetCounts();
+            float counts = inches*COUNTS_PER_INCH;
+            //Set both motors to desired percent
+            right_motor.SetPercent(-1 * percent);
+            left_motor.SetPercent(-1 * percent);
+
+            //While the average of the left and right encoder are less than counts,
+            //keep running motors
+            float start_time = TimeNow();
+            while((left_encoder.Counts() + right_encoder.Counts()) / 2. < counts && TimeNow() - start_time < time) {
+
+            }
+
+
+            //Turn off motors
+            right_motor.Stop();
+            left_motor.Stop();
+        }
+
+
+        /** driveToWall
+            Moves the robot forward, stopping when it hits a wall
+            @param percent Motor percent
+        */
+        void driveToWall(int percent) {
+            BENCH_PRIMITIVE();
+
+            right_motor.SetPercent(percent);
+            left_motor.SetPercent(percent);
+            int mp = percent;
+            double start_time = TimeNow();
+            while((frontLeftBump.Value() || frontRightBump.Value()) && TimeNow() - start_time < 3.0) {
+                double current_error = (left_encoder.Counts()-right_encoder.Counts());
+                mp = TUNING_CONSTANT*current_error+(percent);
+                right_motor.SetPercent(mp);
+                bumpValues();
+                if(percent < 0) {
+                    mp *= -1;
+                }
+                bumpValues();
+                right_motor.SetPercent(mp);
+                if(!frontRightBump.Value()) {
+                    left_motor.SetPercent(percent+10);
+                    right_motor.SetPercent(Policy::wallBackoff(percent));
+                }
+                else if(!frontLeftBump.Value()) {
+                    right_motor.SetPercent(percent+10);
+                    left_motor.SetPercent(Policy::wallBackoff(percent));
+                }
+            }
+            //Turn off motors
+            right_motor.Stop();
+            left_motor.Stop();
+        }
+
+        /** followLineWith
+            Makes the robot follow a line until it has gone far enough or a stop condition in the options is met.
+            @param speed Motor percent
+            @param distance Distance robot needs to travel
+            @param options Line color, timeout and bump switch behavior
+        */
+        void followLineWith(float speed, float distance, const LineFollowOptions &options) {
+                LineFollower follower(options.color);
+                float counts = distance * COUNTS_PER_INCH;
+                right_encoder.ResetCounts();
+                left_encoder.ResetCounts();
+                double start_time = TimeNow();
+                while(true)
+                {
+                    bool leftBump = frontLeftBump.Value();
+                    bool rightBump = frontRightBump.Value();
+                    bool bumped = options.stopOnEitherBump ? !(leftBump && rightBump) : !(leftBump || rightBump);
+                    if(!((left_encoder.Counts() + right_encoder.Counts()) / 2. < counts && TimeNow() - start_time < options.timeout && !bumped)) {
+                        break;
+                    }
+                    if(options.steerOnBump && !rightBump) {
+                        left_motor.SetPercent(options.bumpPush);
+                        right_motor.SetPercent(options.bumpReverse);
+                    }
+                    else if(options.steerOnBump && !leftBump) {
+                        right_motor.SetPercent(options.bumpPush);
+                        left_motor.SetPercent(options.bumpReverse);
+                    }
+                    else {
+                        const LineSteering &steering = follower.steer(left.Value(), middle.Value(), right.Value());
+                        left_motor.SetPercent(steering.left * speed);
+                        right_motor.SetPercent(steering.right * speed);
+                    }
+                }
+                if(options.stopAtEnd) {
+                    right_motor.Stop();
+                    left_motor.Stop();
+                }
+        }
+
+        /** followLine
+            Makes the robot follow a black line, pivoting into the wall if one bump switch hits.
+            @param speed Motor percent
+            @param distance Distance robot needs to travel
+        */
+        void followLine(float speed, float distance) {
+                BENCH_PRIMITIVE();
+                LineFollowOptions options = {BLACK_LINE, 3, false, true, speed + 10, -15, false, false};
+                followLineWith(speed, distance, options);
+        }
+
+        /** followLineYellow
+            Makes the robot follow a yellow line, stopping as soon as either bump switch hits.
+            @param speed Motor percent
+            @param distance Distance robot needs to travel
+        */
+        void followLineYellow(float speed, float distance) {
+                BENCH_PRIMITIVE();
+                LineFollowOptions options = {YELLOW_LINE, 5, true, false, 0, 0, false, false};
+                followLineWith(speed, distance, options);
+        }
+
+        /** turn_left
+            Turns the robot to the left for a certain amount of degrees
+            @param percent Motor percent
+            @param degrees Amount for robot to turn
+        */
+        void turn_left(int percent, float degrees) //using encoders
+        {
+            BENCH_PRIMITIVE();
+            //Reset encoder counts
+            right_encoder.ResetCounts();
+            left_encoder.ResetCounts();
+            float counts = degrees * LEFT_COUNTS_PER_DEGREE;
+            right_motor.SetPercent(percent);
+            left_motor.SetPercent(-1 * percent);
+            while((right_encoder.Counts() + left_encoder.Counts())/2. < counts);
+
+            //Turn off motors
+            right_motor.Stop();
+            left_motor.Stop();
+        }
+
+        /** turn_right
+            Turns the robot to the right for a certain amount of degrees
+            @param percent Motor percent
+            @param degrees Amount for robot to turn
+        */
+        void turn_right(int percent, float degrees) //using encoders
+        {
+            BENCH_PRIMITIVE();
+            //Reset encoder counts
+            right_encoder.ResetCounts();
+            left_encoder.ResetCounts();
+            float counts = degrees * RIGHT_COUNTS_PER_DEGREE;
+            right_motor.SetPercent(-1 * percent);
+            left_motor.SetPercent(percent);
+            while((right_encoder.Counts() + left_encoder.Counts())/2. < counts);
+
+            //Turn off motors
+            right_motor.Stop();
+            left_motor.Stop();
+        }
+        /** angleBetween
+            Gets the smaller angle between two unit vectors
+            @param degree1 Degree of first vector
+            @param degree2 Degree of second vector
+            @return The angle between the two vectors (angle < 180)
+        */
+        float angleBetween(float degree1, float degree2) {
+            float vect1x = cos(degree1 * M_PI/180);
+            float vect1y = sin(degree1 * M_PI/180);
+            float vect2x = cos(degree2 * M_PI/180);
+            float vect2y = sin(degree2 * M_PI/180);
+            //get dot product of vectors
+            float dot = vect1x*vect2x + vect1y*vect2y;
+            //use dot product definition to get angle between
+            return acos(dot) * 180/M_PI;
+        }
+
+
+        /** faceDegree
+            Uses RPS to face the robot to a certain degree
+            @param degree Degree robot should face
+        */
+        void faceDegree(float degree) {
+            BENCH_PRIMITIVE();
+
+            float headingToZero = 0;
+            float degreeToZero = degree - RPS.Heading();
+            if(degreeToZero < 0) {
+                degreeToZero+=360;
+            }
+            float deltaTheta = angleBetween(headingToZero, degreeToZero);
+            float timeStarted = TimeNow();
+            while(deltaTheta > 0.8 && TimeNow() - timeStarted < 5) {
+                if(RPS.Heading() >= 0)  {
+                    headingToZero = 0;
+                    degreeToZero = degree-RPS.Heading();
+                    if(degreeToZero < 0) {
+                        degreeToZero+=360;
+                    }
+                    deltaTheta = angleBetween(headingToZero, degreeToZero);
+                    if(degreeToZero > 180) {
+                            turn_right(15,0.1);
+                           Sleep(50);
+
+                    }
+                    else {
+                            turn_left(15,0.1);
+                           Sleep(50);
+                        }
+                    }
+                }
+
+
+
+         }
+        float distanceTo(float x, float y) {
+            while(RPS.X() < 0);
+            return sqrt((x - RPS.X()) * (x - RPS.X()) + (y - RPS.Y()) * (y - RPS.Y()));
+        }
+
+        /** check_y_minus
+            Moves the robot to a certain y coordinate while it is facing the negative y direction
+            @param y_coordinate The coordinate the robot should go
+        */
+
+        bool check_y_minus(float y_coordinate) //using RPS while robot is in the -y direction
+        {
+            BENCH_PRIMITIVE();
+            bool condition = true;
+            //check whether the robot is within an acceptable range
+            //The heading read here was never used, but the read still takes as long as any other RPS call
+            RPS.Heading();
+            while(RPS.Y() < y_coordinate - 0.5 || RPS.Y() > y_coordinate + 0.5)
+            {
+                if(RPS.Y() > y_coordinate)
+                {
+                    move_forward_timed(20,0.1, 1);
+                }
+                else if(RPS.Y() < y_coordinate)
+                {
+                    //pulse the motors for a short duration in the correct direction
+
+                    move_backwards(20,0.1);
+                }
+                Sleep(50);
+
+            }
+            return condition;
+        }
+        float locationDegree(float x, float y, int quadrant) {
+            float delY = y - RPS.Y();
+            float delX = x - RPS.X();
+            float angle;
+            if(quadrant == 1) {
+                angle = atan(delY/delX) * 180 / M_PI;
+            }
+            else if(quadrant == 2) {
+                angle = atan(delY/delX) * 180/M_PI;
+                angle += 180;
+            }
+            else if(quadrant == 3) {
+                angle = atan(delY/delX) * 180/M_PI;
+                angle += 180;
+            }
+            else {
+                angle = atan(delY/delX) * 180/M_PI;
+                angle += 360;
+            }
+            return angle;
+        }
+
+        void faceLocation(float x, float y, int quadrant) {
+            BENCH_PRIMITIVE();
+            float angle = locationDegree(x, y, quadrant);
+            float currentHeading = RPS.Heading();
+            float deltaTheta = angleBetween(currentHeading, angle);
+            float tempAngle = angle - currentHeading;
+            if(tempAngle < 0) {
+                tempAngle += 360;
+            }
+            if(tempAngle > 180) {
+                turn_right(30, deltaTheta);
+            }
+            else {
+                turn_left(30, deltaTheta);
+            }
+            LCD.WriteLine("Facing: ");
+            LCD.Write(angle);
+            faceDegree(angle);
+
+        }
+
+        void faceLocationBack(float x, float y, int quadrant) {
+            BENCH_PRIMITIVE();
+            float angle = locationDegree(x, y, quadrant);
+            angle -= 180;
+            if(angle < 0) {
+                angle += 360;
+            }
+            LCD.WriteLine("Current Heading: ");
+            float currentHeading = RPS.Heading();
+            LCD.WriteLine(currentHeading);
+            while(currentHeading < 0) {
+                currentHeading = RPS.Heading();
+            }
+
+            float deltaTheta = angleBetween(currentHeading, angle);
+            LCD.WriteLine("delta theta: ");
+            LCD.WriteLine(deltaTheta);
+            float tempAngle = angle - currentHeading;
+            if(tempAngle < 0) {
+                tempAngle += 360;
+            }
+            if(tempAngle > 180) {
+                turn_right(30, deltaTheta);
+            }
+            else {
+                turn_left(30, deltaTheta);
+            }
+            LCD.WriteLine("Facing: ");
+            LCD.Write(angle);
+
+        }
+        void moveToForwards(float x, float y) {
+            BENCH_PRIMITIVE();
+            int quad;
+            LCD.WriteLine(RPS.X());
+            LCD.WriteLine(RPS.Y());
+            float delY = y - RPS.Y();
+            float delX = x - RPS.X();
+            if(delX > 0) {
+                if(delY >= 0) {
+                    quad = 1;
+                }
+                else {
+                    quad = 4;
+                }
+            }
+            else {
+                if(delY >= 0) {
+                    quad = 2;
+                }
+                else {
+                    quad = 3;
+                }
+            }
+            faceLocation(x, y, quad);
+            move_forward(45, distanceTo(x, y));
+
+        }
+        void moveToBackwards(float x, float y) {
+            BENCH_PRIMITIVE();
+            int quad;
+            float delY = y - RPS.Y();
+            float delX = x - RPS.X();
+            if(delX > 0) {
+                if(delY >= 0) {
+                    quad = 1;
+                }
+                else {
+                    quad = 4;
+                }
+            }
+            else {
+                if(delY >= 0) {
+                    quad = 2;
+                }
+                else {
+                    quad = 3;
+                }
+            }
+            faceLocationBack(x, y, quad);
+            move_backwards_timed(SPEED, distanceTo(x, y), 5);
+        }
+        /** waitForStart
+            Initializes menu, waits for start light to go on.
+        */
+        void waitForStart() {
+            RPS.InitializeTouchMenu();
+            LCD.Clear();
+            setRPSCoords();
+            while(cds2.Value() > 0.8);
+        }
+        /** getLightColor
+            Returns the color of the fuel light.
+            @return 1 if light is blue, 2 if light is red
+        */
+        int getLightColor() {
+            LCD.WriteLine(cds1.Value());
+            if(cds1.Value() < BLUE_LIGHT_ON) {
+                return 0;
+            }
+            else {
+                return 1;
+            }
+        }
+        /** detectingLight
+            Finds out whether the robot is detecting a light or not
+            @return true if robot is detecting light, false otherwise
+        */
+        bool detectingLight(int cell) {
+            if(cell == 1) {
+                if(RPS.CurrentCourse() == 'a' || RPS.CurrentCourse() == 'A') {
+                    return cds1.Value() < Policy::FUEL_LIGHT_ON;
+                }
+                else {
+                    return cds1.Value() < Policy::FUEL_LIGHT_ON;
+                }
+
+
+            }
+            else {
+                return cds2.Value() < 0.8;
+            }
+        }
+
+
+        /** setServo
+            Sets the servo thresholds.
+        */
+        void setServo() {
+            arm.SetMin(884);
+            arm.SetMax(2235);
+        }
+        void moveArm(float currentDegree, float nextDegree) {
+            BENCH_PRIMITIVE();
+            if(currentDegree < nextDegree) {
+                while(currentDegree < nextDegree) {
+                    arm.SetDegree(currentDegree);
+                    currentDegree++;
+                    Sleep(5);
+                }
+            }
+            else {
+                while(currentDegree > nextDegree) {
+                    arm.SetDegree(currentDegree);
+                    currentDegree--;
+                    Sleep( 5);
+                }
+            }
+        }
+
+        /** pullSwitch
+            pulls a switch in front of the robot
+        */
+        void pullSwitch(int s) {
+            if(s == 2) {
+                move_backwards(SPEED, 1.5);
+                moveArm(100, 35);
+
+                move_backwards_timed(SPEED, 2, 1);
+                //move_forward(20, 1);
+                 moveArm(35, 100);
+
+            }
+            else {
+                move_forward_timed(SPEED, 1, 1);
+                 moveArm(100, 35);
+
+                move_backwards_timed(SPEED, 2.5, 1);
+                move_forward(SPEED, 0.5);
+                 moveArm(35, 100);
+            }
+
+
+
+        }
+        /** pushSwitch
+            pushes a switch in front of the robot
+        */
+        void pushSwitch(int s) {
+            if(s == 2) {
+                move_backwards(30, 4);
+                 moveArm(100, 35);
+
+                move_forward_timed(30, 3, Policy::SWITCH_PUSH_TIME);
+                 moveArm(35, 100);
+            }
+            else {
+                move_backwards(30 , Policy::SWITCH_PUSH_BACKUP);
+                moveArm(100, 35);
+                move_forward_timed(30, 3, Policy::SWITCH_PUSH_TIME);
+                moveArm(35, 100);
+            }
+        }
+        /** goUpSideRamp
+            Assuming robot is facing ramp, moves up the side ramp, stopping when robot is completely on top level.
+        */
+        void goUpSideRamp() {
+            move_forward_timed(Policy::SIDE_RAMP_PERCENT, 5, 100);
+            followLine(Policy::SIDE_RAMP_PERCENT, 7);
+            driveToWall(30);
+            move_backwards(Policy::SIDE_RAMP_BACKUP_PERCENT, 0.25);
+            turn_left(30, 90);
+            followLine(45, 30);
+            driveToWall(30);
+            move_backwards(35,1);
+
+            turn_left(30, Policy::SIDE_RAMP_TOP_TURN);
+            LCD.WriteLine("FORWARD");
+
+            move_forward_timed(SPEED, 15, 100);
+            LCD.WriteLine("STOP");
+            right_motor.Stop();
+            left_motor.Stop();
+        }
+        /** flipSwitches
+            Flips all 3 switches to their correct orientation
+            @param red The direction for the red switch to go
+            @param white The direction for the white switch to go
+            @param blue The direction for the blue switch to go
+        */
+        void flipSwitches(int red, int white, int blue) {
+            //Starting at middle switch
+            followLineYellow(SPEED, 5);
+            if(white == 1) {
+                pushSwitch(2);
+            }
+            else {
+                pullSwitch(2);
+            }
+            //followLineYellow(SPEED, 5);
+
+           // move_backwards(30, 1);
+            turn_right(30, 25);
+            move_forward(30, 1);
+            if(red == 1) {
+                pushSwitch(1);
+            }
+            else {
+                pullSwitch(1);
+            }
+            move_backwards(30, 1);
+           // turn_left(30, 25);
+           // followLineYellow(SPEED, 5);
+           // move_backwards(30, 1);
+            turn_left(30, 50);
+            //faceDegree(300);
+            move_forward(30, 1);
+            if(blue == 1) {
+                pushSwitch(3);
+            }
+            else {
+                pullSwitch(3);
+            }
+        }
+        /** completeSwitches
+            moves to switches and flips them
+        */
+        void completeSwitches() {
+            BENCH_PHASE();
+
+            flipSwitches(RPS.RedSwitchDirection(), RPS.WhiteSwitchDirection(), RPS.BlueSwitchDirection());
+        }
+        /** pushButton
+            pushes correct fuel button
+        */
+        void pushButton(int correctButton) {
+
+            if(correctButton == 0) {
+                LCD.WriteLine("RED");
+                move_backwards(SPEED, 4.5);
+                moveArm(100, 33);
+                move_forward_timed(20, 3, 1.5);
+                move_forward_timed(5, 100, 5);
+                move_backwards_timed(30,3, 2);
+                arm.SetDegree(100);
+            }
+            else {
+                LCD.WriteLine("BLUE");
+                arm.SetDegree(120);
+                move_forward_timed(30, 100, 6);
+                move_backwards_timed(30, 3, 2);
+                move_backwards_timed(30, 3, 2);
+                arm.SetDegree(100);
+            }
+        }
+        void pickUpSupplies() {
+
+
+            moveArm(100, 15);
+            LCD.WriteLine("moving arm down");
+            moveArm(15, 100);
+            LCD.WriteLine("Moving arm up");
+        }
+
+
+
+        void dropSupplies() {
+            move_backwards(30, 1);
+            LCD.WriteLine("moving backwards");
+            moveArm(100, 25);
+            LCD.WriteLine("moving arm down");
+            move_backwards_timed(Policy::DROP_BACKUP_PERCENT, 5, 3);
+            LCD.WriteLine("moving backwards");
+            LCD.WriteLine("sleep");
+            arm.SetDegree(100);
+            LCD.WriteLine("arm up");
+
+            pivot_right( 33, Policy::DROP_PIVOT_DEGREES);
+            followLineYellow(20, 5);
+
+        }
+
+        void startToSupplies() {
+            BENCH_PHASE();
+            setServo();
+            arm.SetDegree(100);
+            moveToForwards(SUPPLIES_X, SUPPLIES_Y + 1.8);
+            turn_right(30, angleBetween(RPS.Heading(), 270) - 1);
+            faceDegree(270);
+            check_y_minus(SUPPLIES_Y+1.2);
+
+
+            pickUpSupplies();
+        }
+
+        void suppliesToTop() {
+            BENCH_PHASE();
+            while(RPS.X() < 0);
+            move_backwards(35, distanceTo(RPS.X(), Location::BOTTOM_SIDE_RAMP_Y + 0.5)) ;
+            turn_left(30,90);
+            goUpSideRamp();
+
+        }
+        void goToLight() {
+        //    if(RPS.X() > 0) {
+        //        LCD.WriteLine(RPS.X());
+        //        LCD.WriteLine(distanceTo(RPS.X(), Location::FUEL_LIGHT_Y));
+        //        followLineYellow(25, distanceTo(RPS.X(), Location::FUEL_LIGHT_Y) - 0.3);
+        //    }
+
+                while(!detectingLight(1)) {
+                    followLineYellow(Policy::LIGHT_CREEP_PERCENT, 0.1);
+                }
+
+            right_motor.Stop();
+            left_motor.Stop();
+
+            LCD.WriteLine(cds1.Value());
+            Sleep(250);
+
+            int correctButton = getLightColor();
+            if(correctButton == 0) {
+                LCD.WriteLine("RED");
+            }
+            else {
+                LCD.WriteLine("BLUE");
+
+            }
+            pushButton(correctButton);
+        }
+
+        void doButtons() {
+            BENCH_PHASE();
+            while(RPS.X() < 0);
+            if(RPS.Heading() >= 0) {
+                turn_right(30, angleBetween(RPS.Heading(),90)+1);
+            }
+            else {
+                turn_right(30, 85);
+            }
+            //faceDegree(90);
+
+            goToLight();
+
+
+
+
+        }
+        void dropOff() {
+            BENCH_PHASE();
+            if(RPS.Heading() < 0) {
+                move_backwards(30, 1);
+            }
+            if(RPS.Heading() < 0) {
+                move_backwards(30, 1);
+            }
+            if(RPS.Heading() < 0) {
+                move_backwards(30, 1);
+            }
+            if(RPS.Heading() < 0) {
+                move_backwards(30, 1);
+            }
+            float angle = locationDegree(DROP_OFF_X, DROP_OFF_Y, 3);
+            angle -= 180;
+            moveToBackwards(DROP_OFF_X, DROP_OFF_Y );
+            turn_left(30, angleBetween(angle, 90));
+            LCD.WriteLine("FOLLOWING");
+            followLineYellow(30, 4);
+            LCD.WriteLine("DONE");
+
+
+            //followLineYellow(40, 10);
+            //drop package
+            dropSupplies();
+
+        }
+
+        void goHome() {
+            BENCH_PHASE();
+            turn_left(30, angleBetween(RPS.Heading(), 0));
+            //faceDegree(0);
+            move_forward(SPEED, distanceTo(Location::TOP_MAIN_RAMP_X - 2, RPS.Y()));
+            //check_x_plus(Location::TOP_MAIN_RAMP_X-1);
+            turn_right(30, 90);
+           // faceDegree(270);
+
+            move_forward_timed(35, 17, 3);
+            Sleep(50);
+            if(RPS.Heading() >= 0) {
+                faceLocationBack(Location::START_X, Location::START_Y, 3);
+                move_backwards(50, 17);
+                faceLocationBack(Location::START_X, Location::START_Y, 3);
+                move_backwards(50, 100 );
+
+            }
+            else {
+                turn_left(30, 120);
+                move_backwards(50, 17);
+                faceLocationBack(Location::START_X, Location::START_Y, 3);
+                move_backwards(50, 100);
+            }
+        }
+
+        void goGoGo() {
+            startToSupplies();
+            suppliesToTop();
+            doButtons();
+            dropOff();
+            completeSwitches();
+            goHome();
+            BENCH_REPORT();
+        }
+
+        /** initialize
+            Sets up the arm before the start light.
+        */
+        void initialize() {
+            setServo();
+            arm.SetDegree(100);
+        }
+
+        FEHMotor left_motor;
+        FEHMotor right_motor;
+        DigitalEncoder &left_encoder;
+        DigitalEncoder &right_encoder;
+        DigitalInputPin &frontLeftBump;
+        DigitalInputPin &frontRightBump;
+        AnalogInputPin &left;
+        AnalogInputPin &middle;
+        AnalogInputPin &right;
+        AnalogInputPin &cds1;
+        AnalogInputPin &cds2;
+        FEHServo &arm;
+        //Drive-straight error summed over every move_forward, never reset
+        double accum_error;
+        //Supplies and drop off, moved to where RPS puts them in the setup menu
+        float SUPPLIES_X;
+        float SUPPLIES_Y;
+        float DROP_OFF_X;
+        float DROP_OFF_Y;
+};
+
+#endif
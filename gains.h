@@ -0,0 +1,291 @@
+#ifndef GAINS_H
+#define GAINS_H
+
+#include <FEHSD.h>
+#include <math.h>
+
+//Most speed bands a gain schedule can hold
+#define MAX_GAIN_BANDS 8
+//File on the SD card a tuned schedule is kept in
+#define GAINS_FILE "GAINS.TXT"
+#define GAINS_VERSION 1
+//Relay test: percent added to and taken from the right motor, and how far past zero the wheel difference
+//has to go before the relay switches (in counts)
+#define RELAY_AMPLITUDE 6
+#define RELAY_HYSTERESIS 2
+//Full oscillations measured, each one from the relay switching up to it switching up again
+#define RELAY_CYCLES 3
+//Longest each leg of the relay test drives (in inches) and most legs it takes, backing up between them
+#define RELAY_DISTANCE 24
+#define RELAY_LEGS 4
+
+/**
+ * This is a struct which holds the drive-straight gains for one speed. The right motor is set to
+ * percent + kp * error + ki * (sum of error every control tick), where error is left counts minus right
+ * counts, so ki depends on CONTROL_PERIOD.
+ */
+struct DriveGains
+{
+    float percent;
+    float kp;
+    float ki;
+};
+
+//Gains for each speed band, the pair hand tuned on the robot for every speed. Tuned schedules, from the
+//relay test or sim/gaintune.cpp, are loaded from GAINS_FILE instead until they have been tried on the robot.
+static const DriveGains DEFAULT_DRIVE_GAINS[] = {
+    {15, 0.08, 0.01},
+    {30, 0.08, 0.01},
+    {50, 0.08, 0.01},
+    {75, 0.08, 0.01}
+};
+#define DEFAULT_DRIVE_GAIN_COUNT (int)(sizeof(DEFAULT_DRIVE_GAINS) / sizeof(DEFAULT_DRIVE_GAINS[0]))
+
+/**
+ * This is a class which holds the drive-straight gains for a few speeds, so the move primitives can look
+ * up the gains for whatever percent they drive at.
+ *
+ * Bands are kept in order of percent. Between two bands the gains are interpolated, and outside them the
+ * nearest band's gains are used.
+ */
+class GainSchedule
+{
+    public:
+        GainSchedule() {
+            count = 0;
+        }
+
+        GainSchedule(const DriveGains *bands, int count) {
+            this->count = 0;
+            for(int i = 0; i < count; i++) {
+                set(bands[i].percent, bands[i].kp, bands[i].ki);
+            }
+        }
+
+        /** set
+            Sets the gains for a speed band, adding the band if the schedule doesn't have it
+            @param percent Motor percent the gains are for
+            @param kp Gain on the difference in counts
+            @param ki Gain on the difference summed every tick
+            @return false if the band is new and the schedule is full
+        */
+        bool set(float percent, float kp, float ki) {
+            percent = fabs(percent);
+            int i = 0;
+            while(i < count && bands[i].percent < percent) {
+                i++;
+            }
+            if(i == count || bands[i].percent != percent) {
+                if(count >= MAX_GAIN_BANDS) {
+                    return false;
+                }
+                for(int j = count; j > i; j--) {
+                    bands[j] = bands[j - 1];
+                }
+                count++;
+            }
+            bands[i].percent = percent;
+            bands[i].kp = kp;
+            bands[i].ki = ki;
+            return true;
+        }
+
+        int getCount() const {
+            return count;
+        }
+
+        const DriveGains &getBand(int i) const {
+            return bands[i];
+        }
+
+        /** lookup
+            @param percent Motor percent the robot is driving at, either direction
+            @return Gains for that speed
+        */
+        DriveGains lookup(float percent) const {
+            DriveGains gains = {percent, 0, 0};
+            if(count == 0) {
+                return gains;
+            }
+            float speed = fabs(percent);
+            if(speed <= bands[0].percent) {
+                gains.kp = bands[0].kp;
+                gains.ki = bands[0].ki;
+                return gains;
+            }
+            for(int i = 1; i < count; i++) {
+                if(speed <= bands[i].percent) {
+                    float t = (speed - bands[i - 1].percent) / (bands[i].percent - bands[i - 1].percent);
+                    gains.kp = bands[i - 1].kp + (bands[i].kp - bands[i - 1].kp) * t;
+                    gains.ki = bands[i - 1].ki + (bands[i].ki - bands[i - 1].ki) * t;
+                    return gains;
+                }
+            }
+            gains.kp = bands[count - 1].kp;
+            gains.ki = bands[count - 1].ki;
+            return gains;
+        }
+
+        /** load
+            Reads a schedule saved by save(), keeping the current one if there is no file or it looks wrong
+            @param schedule Set to the saved schedule
+            @param filename File to read
+            @return true if the saved schedule was loaded
+        */
+        static bool load(GainSchedule &schedule, const char *filename = GAINS_FILE) {
+            FEHFile *file = SD.FOpen(filename, "r");
+            if(!file) {
+                return false;
+            }
+            int version = 0;
+            int bandCount = 0;
+            GainSchedule saved;
+            bool ok = SD.FScanf(file, "GAINS %d %d", &version, &bandCount) == 2 &&
+                      version == GAINS_VERSION && bandCount > 0 && bandCount <= MAX_GAIN_BANDS;
+            for(int i = 0; ok && i < bandCount; i++) {
+                DriveGains band;
+                ok = SD.FScanf(file, "%f %f %f", &band.percent, &band.kp, &band.ki) == 3 &&
+                     band.kp >= 0 && band.ki >= 0 && saved.set(band.percent, band.kp, band.ki);
+            }
+            SD.FClose(file);
+            if(ok) {
+                schedule = saved;
+            }
+            return ok;
+        }
+
+        /** save
+            Writes a schedule to the SD card for load() to read at the next startup
+            @param schedule Schedule to save
+            @param filename File to write
+            @return false if the file couldn't be opened
+        */
+        static bool save(const GainSchedule &schedule, const char *filename = GAINS_FILE) {
+            FEHFile *file = SD.FOpen(filename, "w");
+            if(!file) {
+                return false;
+            }
+            SD.FPrintf(file, "GAINS %d %d\n", GAINS_VERSION, schedule.count);
+            for(int i = 0; i < schedule.count; i++) {
+                SD.FPrintf(file, "%f %f %f\n", schedule.bands[i].percent, schedule.bands[i].kp, schedule.bands[i].ki);
+            }
+            SD.FClose(file);
+            return true;
+        }
+
+    private:
+        DriveGains bands[MAX_GAIN_BANDS];
+        int count;
+};
+
+/**
+ * This is a class which finds drive-straight gains with a relay feedback test.
+ *
+ * Both motors are driven at the band's percent and the right motor gets RELAY_AMPLITUDE added or taken
+ * away depending on which wheel is ahead, which makes the difference in counts oscillate. The size and
+ * period of the oscillation give the gain and period the loop would oscillate at under proportional
+ * control alone, and the Ziegler-Nichols rules turn those into PI gains.
+ */
+class RelayTuner
+{
+    public:
+        RelayTuner(float amplitude = RELAY_AMPLITUDE, float hysteresis = RELAY_HYSTERESIS, int cycles = RELAY_CYCLES) {
+            this->amplitude = amplitude;
+            this->hysteresis = hysteresis;
+            this->cycles = cycles;
+            measured = 0;
+            swingTotal = 0;
+            periodTotal = 0;
+            resume();
+        }
+
+        /** resume
+            Starts again after the robot was stopped, e.g. to back up, keeping the oscillations measured so far
+        */
+        void resume() {
+            relay = amplitude;
+            highest = lowest = 0;
+            lastRise = -1;
+        }
+
+        /** output
+            Switches the relay on the latest difference in counts
+            @param error Left counts minus right counts
+            @param now Time of the tick (in seconds)
+            @return Percent to add to the right motor
+        */
+        float output(float error, double now) {
+            if(error > highest) {
+                highest = error;
+            }
+            if(error < lowest) {
+                lowest = error;
+            }
+            if(relay < 0 && error > hysteresis) {
+                //A full oscillation runs from one switch up to the next
+                if(lastRise >= 0 && measured < cycles) {
+                    swingTotal += (highest - lowest) / 2;
+                    periodTotal += now - lastRise;
+                    measured++;
+                }
+                lastRise = now;
+                highest = lowest = error;
+                relay = amplitude;
+            }
+            else if(relay > 0 && error < -hysteresis) {
+                relay = -amplitude;
+            }
+            return relay;
+        }
+
+        /** done
+            @return true once enough oscillations have been measured
+        */
+        bool done() const {
+            return measured >= cycles;
+        }
+
+        /** ultimateGain
+            @return Proportional gain the loop would oscillate at, from the relay's describing function
+        */
+        float ultimateGain() const {
+            float swing = measured > 0 ? swingTotal / measured : 0;
+            return swing > 0 ? 4 * amplitude / (M_PI * swing) : 0;
+        }
+
+        /** ultimatePeriod
+            @return Period the loop would oscillate at (in seconds)
+        */
+        float ultimatePeriod() const {
+            return measured > 0 ? periodTotal / measured : 0;
+        }
+
+        /** gains
+            @param percent Motor percent the test was run at
+            @param tickPeriod Time between control ticks (in seconds), since ki multiplies a sum taken every tick
+            @return Ziegler-Nichols PI gains, or zeros if the test didn't finish
+        */
+        DriveGains gains(float percent, float tickPeriod) const {
+            DriveGains tuned = {percent, 0, 0};
+            if(!done() || ultimatePeriod() <= 0) {
+                return tuned;
+            }
+            tuned.kp = 0.45 * ultimateGain();
+            tuned.ki = tuned.kp * 1.2 / ultimatePeriod() * tickPeriod;
+            return tuned;
+        }
+
+    private:
+        float amplitude;
+        float hysteresis;
+        int cycles;
+        float relay;
+        float highest;
+        float lowest;
+        double lastRise;
+        int measured;
+        float swingTotal;
+        double periodTotal;
+};
+
+#endif
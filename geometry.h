@@ -0,0 +1,183 @@
+#ifndef GEOMETRY_H
+#define GEOMETRY_H
+
+#include <math.h>
+
+/**
+ * Angle and distance helpers for the course, all in degrees with headings measured the same way as RPS
+ * (0 is +x, counterclockwise is positive). None of these call the libm trig functions, so they are safe
+ * to use every control tick. The heading helpers are constexpr so the course map can use them too.
+ */
+
+/** wrapDegrees
+    Wraps an angle difference into the range (-180, 180]
+    @param degrees Angle to wrap, anything between -540 and 540
+    @return The same direction as an angle between -180 and 180
+*/
+constexpr float wrapDegrees(float degrees) {
+    if(degrees > 180) {
+        degrees -= 360;
+    }
+    else if(degrees <= -180) {
+        degrees += 360;
+    }
+    return degrees;
+}
+
+/** normalizeDegrees
+    Wraps a heading into the range [0, 360)
+    @param degrees Heading to wrap, anything between -360 and 720
+    @return The same heading between 0 and 360
+*/
+constexpr float normalizeDegrees(float degrees) {
+    if(degrees >= 360) {
+        degrees -= 360;
+    }
+    else if(degrees < 0) {
+        degrees += 360;
+    }
+    return degrees;
+}
+
+/** angleDifference
+    Gets the signed angle to turn from one heading to another
+    @param target Heading to turn to (0 to 360)
+    @param current Heading turning from (0 to 360)
+    @return Angle to turn (positive is counterclockwise), between -180 and 180
+*/
+constexpr float angleDifference(float target, float current) {
+    return wrapDegrees(target - current);
+}
+
+/** fastAtan2
+    Gets the heading of a vector using a polynomial approximation of arctangent.
+
+    Maximum error against atan2 over all directions:
+        fastAtan2           0.09 degrees
+    The error is zero along the axes and the diagonals.
+    @param y Y component of the vector
+    @param x X component of the vector
+    @return Heading of the vector in degrees (0 to 360), 0 for a zero vector
+*/
+constexpr float fastAtan2(float y, float x) {
+    float ax = x < 0 ? -x : x;
+    float ay = y < 0 ? -y : y;
+    if(ax == 0 && ay == 0) {
+        return 0;
+    }
+    //Work in the first octant, where the ratio is between 0 and 1
+    bool swapped = ay > ax;
+    float z = swapped ? ax / ay : ay / ax;
+    //atan(z) ~= 45z - z(z - 1)(14.02 + 3.80z) for 0 <= z <= 1, in degrees
+    float angle = 45 * z - z * (z - 1) * (14.0206 + 3.7987 * z);
+    if(swapped) {
+        angle = 90 - angle;
+    }
+    if(x < 0) {
+        angle = 180 - angle;
+    }
+    if(y < 0) {
+        angle = 360 - angle;
+    }
+    return normalizeDegrees(angle);
+}
+
+/** distanceBetween
+    Gets the straight line distance between two points
+    @return Distance between (x1, y1) and (x2, y2)
+*/
+inline float distanceBetween(float x1, float y1, float x2, float y2) {
+    float dx = x2 - x1;
+    float dy = y2 - y1;
+    return sqrt(dx * dx + dy * dy);
+}
+
+/**
+ * This is a class which holds a table of sine values for one quarter turn, built at compile time.
+ *
+ * Lookups interpolate linearly between entries. With N entries per quarter turn the error is at most
+ * (pi / 2N)^2 / 8, which is:
+ *      N = 32      0.00030
+ *      N = 64      0.000075
+ *      N = 128     0.000019
+ */
+template <int N>
+class SineTable
+{
+    public:
+        constexpr SineTable() : values() {
+            for(int i = 0; i <= N; i++) {
+                values[i] = taylorSine(i * HALF_PI / N);
+            }
+        }
+
+        /** sine
+            @param degrees Angle (any value)
+            @return Sine of the angle
+        */
+        float sine(float degrees) const {
+            float turns = degrees / 360;
+            //Reduce to [0, 360) without fmod
+            degrees -= 360 * (float)(long)turns;
+            if(degrees < 0) {
+                degrees += 360;
+            }
+            if(degrees < 90) {
+                return quarter(degrees);
+            }
+            if(degrees < 180) {
+                return quarter(180 - degrees);
+            }
+            if(degrees < 270) {
+                return -quarter(degrees - 180);
+            }
+            return -quarter(360 - degrees);
+        }
+
+        /** cosine
+            @param degrees Angle (any value)
+            @return Cosine of the angle
+        */
+        float cosine(float degrees) const {
+            return sine(degrees + 90);
+        }
+
+    private:
+        static constexpr double HALF_PI = 1.57079632679489661923;
+
+        static constexpr double taylorSine(double radians) {
+            double term = radians;
+            double sum = radians;
+            for(int k = 1; k < 12; k++) {
+                term *= -radians * radians / ((2 * k) * (2 * k + 1));
+                sum += term;
+            }
+            return sum;
+        }
+
+        float quarter(float degrees) const {
+            float index = degrees * N / 90;
+            int i = (int)index;
+            if(i >= N) {
+                return values[N];
+            }
+            float fraction = index - i;
+            return values[i] + fraction * (values[i + 1] - values[i]);
+        }
+
+        float values[N + 1];
+};
+
+//Table used by the robot code
+#define TRIG_TABLE_SIZE 64
+constexpr SineTable<TRIG_TABLE_SIZE> trigTable;
+
+inline float sinDegrees(float degrees) {
+    return trigTable.sine(degrees);
+}
+
+inline float cosDegrees(float degrees) {
+    return trigTable.cosine(degrees);
+}
+
+#endif
@@ -0,0 +1,226 @@
+#ifndef LINEFOLLOWER_H
+#define LINEFOLLOWER_H
+
+//Optosensor reading that separates the line from the course
+#ifndef ON_LINE
+#define ON_LINE 3
+#endif
+
+/**
+ * Colors of line on the course. Black lines read above ON_LINE and yellow lines read below it.
+ */
+enum LineColor
+{
+    BLACK_LINE,
+    YELLOW_LINE
+};
+
+/**
+ * This is a struct which holds the wheel speeds for one sensor pattern, as fractions of the follow speed.
+ */
+struct LineSteering
+{
+    float left;
+    float right;
+    const char *name;
+};
+
+/**
+ * Steering for each sensor pattern. The index has the left sensor in bit 2, the middle in bit 1 and the
+ * right in bit 0, with a bit set when that sensor sees the line. Patterns that can't come from a single
+ * line (none, both sides, all three) drive straight.
+ */
+constexpr LineSteering BLACK_LINE_STEERING[8] = {
+    {1, 1, "OFFLINE"},          //000
+    {1, .5, "FAR LEFT"},        //001 line is under the right sensor
+    {1, 1, "CENTER"},           //010
+    {1, .75, "LEFT"},           //011
+    {.5, 1, "FAR RIGHT"},       //100 line is under the left sensor
+    {1, 1, "OFFLINE"},          //101
+    {.75, 1, "RIGHT"},          //110
+    {1, 1, "OFFLINE"}           //111
+};
+
+//Yellow lines are followed with sharper corrections
+constexpr LineSteering YELLOW_LINE_STEERING[8] = {
+    {1, 1, "OFFLINE"},
+    {1, .25, "FAR LEFT"},
+    {1, 1, "CENTER"},
+    {1, .5, "LEFT"},
+    {.25, 1, "FAR RIGHT"},
+    {1, 1, "OFFLINE"},
+    {.5, 1, "RIGHT"},
+    {1, 1, "OFFLINE"}
+};
+
+//Patterns of a line under the sensors, in the order the old followers tried them: center, left, far left,
+//right, far right
+#define LINE_POSITION_COUNT 5
+constexpr int LINE_POSITIONS[LINE_POSITION_COUNT] = {2, 3, 1, 6, 4};
+
+/**
+ * This is a struct which holds when a line follow should stop and how it reacts to the bump switches.
+ */
+struct LineFollowOptions
+{
+    LineColor color;
+    //Longest the follow can run (in seconds)
+    float timeout;
+    //Stop as soon as either bump switch is pressed, otherwise only when both are
+    bool stopOnEitherBump;
+    //Pivot into the wall when only one bump switch is pressed
+    bool steerOnBump;
+    //Motor percents for the free side and pressed side while pivoting into the wall
+    float bumpPush;
+    float bumpReverse;
+    //Stop the motors when the follow ends
+    bool stopAtEnd;
+    //Steer with a LineTracker instead of the steering table
+    bool proportional;
+};
+
+/**
+ * This is a class which turns the three optosensor readings into wheel speeds with a table lookup.
+ */
+class LineFollower
+{
+    public:
+        LineFollower(LineColor color) {
+            this->color = color;
+            table = color == YELLOW_LINE ? YELLOW_LINE_STEERING : BLACK_LINE_STEERING;
+        }
+
+        /** pattern
+            Packs which sensors see the line into a table index. Readings are truncated to whole volts
+            like the old followers, and a reading of exactly ON_LINE counts as both on and off the line,
+            so more than one pattern can fit. The old followers tried center, left, far left, right and
+            far right in that order and took the first that fit, and so does this.
+            @return Index from 0 to 7 (left sensor is bit 2, right sensor is bit 0), 0 if no line
+                    position fits
+        */
+        int pattern(float left, float middle, float right) const {
+            int on = (onLine(left) << 2) | (onLine(middle) << 1) | onLine(right);
+            int off = (offLine(left) << 2) | (offLine(middle) << 1) | offLine(right);
+            for(int i = 0; i < LINE_POSITION_COUNT; i++) {
+                //Every sensor set in the pattern sees the line and every other one sees the course
+                int candidate = LINE_POSITIONS[i];
+                if((candidate & ~on) == 0 && (~candidate & 7 & ~off) == 0) {
+                    return candidate;
+                }
+            }
+            return 0;
+        }
+
+        /** steer
+            @return The wheel speeds for the current sensor readings
+        */
+        const LineSteering &steer(float left, float middle, float right) const {
+            return table[pattern(left, middle, right)];
+        }
+
+    private:
+        int onLine(float value) const {
+            int volts = (int)value;
+            return color == YELLOW_LINE ? volts <= ON_LINE : volts >= ON_LINE;
+        }
+
+        int offLine(float value) const {
+            int volts = (int)value;
+            return color == YELLOW_LINE ? volts >= ON_LINE : volts <= ON_LINE;
+        }
+
+        LineColor color;
+        const LineSteering *table;
+};
+
+//Below this much total line signal the line is considered lost
+#define LINE_LOST_SIGNAL 0.2
+
+/**
+ * This is a class which steers along a line in proportion to how far off center it is.
+ *
+ * Each optosensor reading is scaled so 0 is the course and 1 is the line, and the line position is the
+ * weighted centroid of the three sensors: -1 under the left sensor, 0 under the middle and 1 under the
+ * right. A PD controller turns that into a steering correction. When no sensor sees the line the tracker
+ * keeps steering toward the side it was last seen on instead of driving straight.
+ */
+class LineTracker
+{
+    public:
+        /** LineTracker
+            @param lineReading Sensor reading over the middle of the line
+            @param courseReading Sensor reading over the course next to the line
+            @param kp Correction per unit of line error
+            @param kd Correction per unit of line error per second
+        */
+        LineTracker(float lineReading, float courseReading, float kp, float kd) {
+            this->lineReading = lineReading;
+            this->courseReading = courseReading;
+            this->kp = kp;
+            this->kd = kd;
+            lastError = 0;
+            lastTime = -1;
+            lost = false;
+        }
+
+        /** error
+            @return Line position from -1 (under the left sensor) to 1 (under the right sensor)
+        */
+        float error(float left, float middle, float right) {
+            float l = signal(left);
+            float m = signal(middle);
+            float r = signal(right);
+            float total = l + m + r;
+            if(total < LINE_LOST_SIGNAL) {
+                //Keep turning toward wherever the line was last seen
+                lost = true;
+                return lastError < 0 ? -1 : (lastError > 0 ? 1 : 0);
+            }
+            lost = false;
+            return (r - l) / total;
+        }
+
+        /** correction
+            @param now Current time (in seconds)
+            @return Steering correction as a fraction of speed, positive to turn right
+        */
+        float correction(float left, float middle, float right, double now) {
+            float e = error(left, middle, right);
+            float rate = 0;
+            if(lastTime >= 0 && now > lastTime) {
+                rate = (e - lastError) / (now - lastTime);
+            }
+            lastError = e;
+            lastTime = now;
+            return kp * e + kd * rate;
+        }
+
+        /** isLost
+            @return true if no sensor saw the line on the last reading
+        */
+        bool isLost() const {
+            return lost;
+        }
+
+    private:
+        float signal(float value) const {
+            float s = (value - courseReading) / (lineReading - courseReading);
+            if(s < 0) {
+                return 0;
+            }
+            if(s > 1) {
+                return 1;
+            }
+            return s;
+        }
+
+        float lineReading;
+        float courseReading;
+        float kp;
+        float kd;
+        float lastError;
+        double lastTime;
+        bool lost;
+};
+
+#endif
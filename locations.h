@@ -1,39 +1,40 @@
-#ifndef LOCATIONS_H
-#define LOCATIONS_H
-
-/**
- * This is a class which holds the X and Y coordinates for all locations of interest on the 2016 FEH Robot course.
- */
-class Location
-{
-    public:
-        static const float SUPPLIES_X = 29.35;
-        static const float SUPPLIES_Y = 12.3;
-
-        static const float BOTTOM_SIDE_RAMP_X = 28.1;
-        static const float BOTTOM_SIDE_RAMP_Y = 22.9;
-
-        static const float TOP_SIDE_RAMP_X = 33.1;
-        static const float TOP_SIDE_RAMP_Y = 50;
-
-       static const float BOT_MAIN_RAMP_X = 29.1;
-       static const float BOT_MAIN_RAMP_Y = 24.3;
-
-        static const float TOP_MAIN_RAMP_X = 29.4;
-        static const float TOP_MAIN_RAMP_Y = 44.3;
-
-
-        static const float FUEL_LIGHT_X = 30.5;
-        static const float FUEL_LIGHT_Y = 61.6;
-
-        static const float MID_SWITCH_X = 6.5;
-        static const float MID_SWITCH_Y = 45.4;
-
-        static const float START_X = 7.6;
-        static const float START_Y = 8.9;
-
-        static const float DROP_OFF_X = 5.5;
-        static const float DROP_OFF_Y = 48;
-};
-
-#endif
+#ifndef LOCATIONS_H
+#define LOCATIONS_H
+
+/**
+ * This is a class which holds the X and Y coordinates for all locations of interest on the 2016 FEH Robot course.
+ * The walls, lines and the waypoints the robot drives between are in coursemap.h.
+ */
+class Location
+{
+    public:
+        static constexpr float SUPPLIES_X = 29.35;
+        static constexpr float SUPPLIES_Y = 12.3;
+
+        static constexpr float BOTTOM_SIDE_RAMP_X = 28.1;
+        static constexpr float BOTTOM_SIDE_RAMP_Y = 22.9;
+
+        static constexpr float TOP_SIDE_RAMP_X = 33.1;
+        static constexpr float TOP_SIDE_RAMP_Y = 50;
+
+       static constexpr float BOT_MAIN_RAMP_X = 29.1;
+       static constexpr float BOT_MAIN_RAMP_Y = 24.3;
+
+        static constexpr float TOP_MAIN_RAMP_X = 29.4;
+        static constexpr float TOP_MAIN_RAMP_Y = 44.3;
+
+
+        static constexpr float FUEL_LIGHT_X = 30.5;
+        static constexpr float FUEL_LIGHT_Y = 61.6;
+
+        static constexpr float MID_SWITCH_X = 6.5;
+        static constexpr float MID_SWITCH_Y = 45.4;
+
+        static constexpr float START_X = 7.6;
+        static constexpr float START_Y = 8.9;
+
+        static constexpr float DROP_OFF_X = 5.5;
+        static constexpr float DROP_OFF_Y = 48;
+};
+
+#endif
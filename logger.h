@@ -0,0 +1,202 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <FEHLCD.h>
+#include <FEHUtility.h>
+#include "bench.h"
+
+//Log levels, messages below LOG_LEVEL are compiled out
+#define LOG_LEVEL_DEBUG 0
+#define LOG_LEVEL_INFO 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_OFF 3
+
+//Only warnings unless the build asks for more, e.g. -DLOG_LEVEL=LOG_LEVEL_DEBUG
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_WARN
+#endif
+
+//Number of messages the buffer holds (must be a power of 2)
+#define LOG_BUFFER_SIZE 64
+//Shortest time between two LCD writes (in seconds)
+#define LOG_FLUSH_INTERVAL 0.02
+
+/**
+ * This is a class which queues LCD messages so the control loop never waits on the screen.
+ *
+ * Messages are copied into a ring buffer by the control code and written out one line at a time by
+ * flush(), which the control loop calls while it waits for the next tick. There is one writer and one
+ * reader and neither ever waits on the other; when the buffer is full new messages are dropped and
+ * counted. Text is stored as a pointer, so only pass string literals.
+ */
+class Logger
+{
+    public:
+        Logger() {
+            head = 0;
+            tail = 0;
+            dropped = 0;
+            lastFlush = -LOG_FLUSH_INTERVAL;
+        }
+
+        bool log(const char *text) {
+            return push(text, NONE, 0, 0);
+        }
+
+        bool log(int value) {
+            return push(0, INT, value, 0);
+        }
+
+        bool log(float value) {
+            return push(0, FLOAT, 0, value);
+        }
+
+        bool log(double value) {
+            return push(0, FLOAT, 0, (float)value);
+        }
+
+        bool log(bool value) {
+            return push(0, INT, value, 0);
+        }
+
+        /** log
+            Queues a label and a value to be written on the same line
+            @param label Text written before the value
+            @param value Value to write
+        */
+        bool log(const char *label, int value) {
+            return push(label, INT, value, 0);
+        }
+
+        bool log(const char *label, float value) {
+            return push(label, FLOAT, 0, value);
+        }
+
+        bool log(const char *label, double value) {
+            return push(label, FLOAT, 0, (float)value);
+        }
+
+        /** flush
+            Writes the oldest message to the LCD if enough time has passed since the last write
+            @param now Current time (in seconds)
+            @return true if a message was written
+        */
+        bool flush(double now) {
+            if(now - lastFlush < LOG_FLUSH_INTERVAL || tail == head) {
+                return false;
+            }
+            write(entries[tail]);
+            tail = (tail + 1) & (LOG_BUFFER_SIZE - 1);
+            lastFlush = now;
+            return true;
+        }
+
+        /** flushAll
+            Writes every queued message to the LCD right away
+        */
+        void flushAll() {
+            while(tail != head) {
+                write(entries[tail]);
+                tail = (tail + 1) & (LOG_BUFFER_SIZE - 1);
+            }
+        }
+
+        /** getDropped
+            @return Number of messages thrown away because the buffer was full
+        */
+        unsigned long getDropped() const {
+            return dropped;
+        }
+
+        /** idle
+            Control loop idle task that writes queued messages at the capped rate
+            @param logger The Logger to flush
+            @param now Current time (in seconds)
+        */
+        static void idle(void *logger, double now) {
+            ((Logger *)logger)->flush(now);
+        }
+
+    private:
+        enum ValueType { NONE, INT, FLOAT };
+
+        struct Entry
+        {
+            const char *text;
+            char type;
+            int intValue;
+            float floatValue;
+        };
+
+        bool push(const char *text, ValueType type, int intValue, float floatValue) {
+            unsigned int next = (head + 1) & (LOG_BUFFER_SIZE - 1);
+            if(next == tail) {
+                dropped++;
+                return false;
+            }
+            Entry &entry = entries[head];
+            entry.text = text;
+            entry.type = type;
+            entry.intValue = intValue;
+            entry.floatValue = floatValue;
+            //Only publish the entry once it is completely written
+            head = next;
+            return true;
+        }
+
+        void write(const Entry &entry) {
+            BENCH_SECTION(BENCH_LCD);
+            if(entry.type == NONE) {
+                LCD.WriteLine(entry.text);
+                return;
+            }
+            if(entry.text) {
+                LCD.Write(entry.text);
+            }
+            if(entry.type == INT) {
+                LCD.WriteLine(entry.intValue);
+            }
+            else {
+                LCD.WriteLine(entry.floatValue);
+            }
+        }
+
+        Entry entries[LOG_BUFFER_SIZE];
+        volatile unsigned int head;
+        volatile unsigned int tail;
+        unsigned long dropped;
+        double lastFlush;
+};
+
+//Logging macros, these expect a Logger named logger
+#if LOG_LEVEL <= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(...) logger.log(__VA_ARGS__)
+//Debug message from inside a loop, logged at most once every interval seconds from the same line so it
+//can't fill the buffer and push out the messages that matter
+#define LOG_DEBUG_EVERY(interval, ...) \
+    do { \
+        static double lastLogged = -(interval); \
+        double logTime = TimeNow(); \
+        if(logTime - lastLogged >= (interval)) { \
+            lastLogged = logTime; \
+            logger.log(__VA_ARGS__); \
+        } \
+    } while(0)
+#else
+#define LOG_DEBUG(...) ((void)0)
+#define LOG_DEBUG_EVERY(interval, ...) ((void)0)
+#endif
+
+#if LOG_LEVEL <= LOG_LEVEL_INFO
+#define LOG_INFO(...) logger.log(__VA_ARGS__)
+#else
+#define LOG_INFO(...) ((void)0)
+#endif
+
+#if LOG_LEVEL <= LOG_LEVEL_WARN
+#define LOG_WARN(...) logger.log(__VA_ARGS__)
+#else
+#define LOG_WARN(...) ((void)0)
+#endif
+
+#endif
@@ -0,0 +1,202 @@
+#ifndef MOTION_H
+#define MOTION_H
+
+#include <FEHUtility.h>
+#include "sensors.h"
+#include "bench.h"
+
+//How long the encoders can go without counting while the motors are on before the robot counts as stuck (in seconds)
+#define MOTION_STALL_TIME 0.5
+//How long RPS can go without a valid reading before a primitive that steers by it gives up (in seconds)
+#define MOTION_RPS_LOST_TIME 1.0
+//Deadlines picked from the distance allow this many times as long as the move should take, plus the margin
+#define MOTION_TIMEOUT_FACTOR 2
+#define MOTION_TIMEOUT_MARGIN 1
+//Passed as a primitive's timeout to have the deadline picked from the distance
+#define MOTION_AUTO_TIMEOUT -1
+
+/**
+ * This is a struct which holds how a motion primitive ended, so mission code can tell a move that got where
+ * it was going from one that gave up and recover straight away.
+ */
+struct MotionResult
+{
+    //The primitive reached its goal
+    bool completed;
+    //The deadline passed first
+    bool timedOut;
+    //A bump switch stopped it
+    bool bumped;
+    //The wheels stopped turning while the motors were on
+    bool stalled;
+    //RPS had no valid reading for too long
+    bool rpsLost;
+    //It stalled, lost RPS or ran out of time when the deadline wasn't how it was meant to end
+    bool failed;
+    //Time the primitive ran for (in seconds)
+    float elapsed;
+    //How far from the goal it stopped, in the primitive's own units (inches or degrees)
+    float error;
+};
+
+/**
+ * This is a class which watches a primitive's deadline, encoders and RPS readings each tick and builds its
+ * MotionResult.
+ *
+ * A primitive makes one when it starts, calls check() at the top of every tick and stops when it returns
+ * false, then returns finish() with whether it got there. Stalls and RPS dropouts only stop the primitive
+ * if it asked for them to be watched, since some moves push against a wall on purpose and most don't need
+ * RPS at all.
+ *
+ * A handler set with setFailureHandler() is called with every failed result, so the flight recorder can
+ * hold on to what led up to it.
+ */
+class MotionWatch
+{
+    public:
+        typedef void (*FailureHandler)(void *data, const MotionResult &result);
+
+        MotionWatch(const SensorFrame &frame, float timeout) : frame(frame) {
+            this->timeout = timeout;
+            start = TimeNow();
+            lastProgress = lastRps = start;
+            lastCounts = frame.leftCounts + frame.rightCounts;
+            stopOnStall = false;
+            stopOnRpsLoss = false;
+            timeoutExpected = false;
+            result.completed = false;
+            result.timedOut = false;
+            result.bumped = false;
+            result.stalled = false;
+            result.rpsLost = false;
+            result.failed = false;
+            result.elapsed = 0;
+            result.error = 0;
+        }
+
+        /** watchStalls
+            Makes check() stop the primitive once the wheels stop turning with the motors on
+        */
+        void watchStalls() {
+            stopOnStall = true;
+        }
+
+        /** watchRps
+            Makes check() stop the primitive once RPS has gone MOTION_RPS_LOST_TIME without a valid reading
+        */
+        void watchRps() {
+            stopOnRpsLoss = true;
+        }
+
+        /** expectTimeout
+            Marks the deadline as the way the primitive is meant to end, as with a move that pushes for a set
+            time, so running out of time doesn't count as a failure
+        */
+        void expectTimeout() {
+            timeoutExpected = true;
+        }
+
+        /** check
+            Checks the deadline and the watched sensors against the current frame
+            @param now Time of the tick (in seconds)
+            @param driving false while the primitive has the motors stopped on purpose, so it isn't stalled
+            @return true while the primitive may keep going
+        */
+        bool check(double now, bool driving = true) {
+            int counts = frame.leftCounts + frame.rightCounts;
+            if(counts != lastCounts || !driving) {
+                lastCounts = counts;
+                lastProgress = now;
+            }
+            if(frame.x >= 0) {
+                lastRps = now;
+            }
+            if(timeout >= 0 && now - start >= timeout) {
+                result.timedOut = true;
+            }
+            if(stopOnStall && now - lastProgress >= MOTION_STALL_TIME) {
+                result.stalled = true;
+            }
+            if(stopOnRpsLoss && now - lastRps >= MOTION_RPS_LOST_TIME) {
+                result.rpsLost = true;
+            }
+            return !(result.timedOut || result.stalled || result.rpsLost);
+        }
+
+        /** sawRps
+            Notes a valid RPS reading from ticks that check() didn't see, such as those of a move the
+            primitive made with its own watch
+            @param time Time of the reading (in seconds)
+        */
+        void sawRps(double time) {
+            if(time > lastRps) {
+                lastRps = time;
+            }
+        }
+
+        /** bumped
+            Records that a bump switch stopped the primitive
+        */
+        void bumped() {
+            result.bumped = true;
+        }
+
+        /** finish
+            @param completed true if the primitive reached its goal
+            @param error How far from the goal it stopped
+            @return The primitive's result
+        */
+        const MotionResult &finish(bool completed, float error) {
+            result.completed = completed;
+            result.error = error;
+            result.elapsed = TimeNow() - start;
+            if(result.timedOut) {
+                BENCH_COUNT("Motion timed out");
+            }
+            if(result.stalled) {
+                BENCH_COUNT("Motion stalled");
+            }
+            if(result.rpsLost) {
+                BENCH_COUNT("Motion RPS lost");
+            }
+            result.failed = result.stalled || result.rpsLost || (result.timedOut && !timeoutExpected);
+            if(result.failed && failureHandler().handler) {
+                failureHandler().handler(failureHandler().data, result);
+            }
+            return result;
+        }
+
+        /** setFailureHandler
+            @param handler Function to call with each failed result, 0 for none
+            @param data Pointer handed back to the handler
+        */
+        static void setFailureHandler(FailureHandler handler, void *data) {
+            failureHandler().handler = handler;
+            failureHandler().data = data;
+        }
+
+    private:
+        struct FailureHook
+        {
+            FailureHandler handler;
+            void *data;
+        };
+
+        static FailureHook &failureHandler() {
+            static FailureHook hook = {0, 0};
+            return hook;
+        }
+
+        const SensorFrame &frame;
+        float timeout;
+        double start;
+        double lastProgress;
+        double lastRps;
+        int lastCounts;
+        bool stopOnStall;
+        bool stopOnRpsLoss;
+        bool timeoutExpected;
+        MotionResult result;
+};
+
+#endif
@@ -0,0 +1,209 @@
+#ifndef MOTOR_H
+#define MOTOR_H
+
+#include <FEHMotor.h>
+#include <FEHUtility.h>
+#include <math.h>
+#include "bench.h"
+#include "scheduler.h"
+
+//Fastest a motor's percent may change (in percent per second), 0 to set it straight away. Full forward
+//to full reverse takes a fifth of a second, enough to keep the wheels from slipping on a reversal.
+#define MOTOR_SLEW_RATE 1000
+
+/**
+ * This is a class which drives one wheel motor and remembers the percent it was last set to, so the
+ * flight recorder can log what the motors were told to do alongside what the sensors saw.
+ *
+ * SetPercent() only sets the percent the motor should head for. The percent actually written changes
+ * by at most the slew rate, so a reversal ramps through zero instead of slamming the gearbox and
+ * spinning the wheels. Registered with a control loop, update() keeps the ramp going every tick between
+ * calls. Commands go out in whole percents, and a write that would send the motor the command it already
+ * has is skipped, since the drive loops set the same command tick after tick, often with a fraction of a
+ * percent of steering on top. Stop() is never slew limited.
+ */
+class DriveMotor
+{
+    public:
+        DriveMotor(FEHMotor::FEHMotorPort port, float maxVoltage, float slewRate = MOTOR_SLEW_RATE)
+            : motor(port, maxVoltage) {
+            this->slewRate = slewRate;
+            percent = 0;
+            target = 0;
+            direction = 1;
+            command = 0;
+            lastStep = 0;
+            written = false;
+            resetCounts(0);
+        }
+
+        /** SetPercent
+            Sets the percent the motor should run at, which it ramps to at the slew rate
+            @param percent Motor percent
+        */
+        void SetPercent(float percent) {
+            target = percent;
+            step(TimeNow());
+        }
+
+        void Stop() {
+            target = 0;
+            lastStep = TimeNow();
+            percent = 0;
+            if(written && command == 0) {
+                skipped++;
+                BENCH_COUNT("Motor write skipped");
+                return;
+            }
+            command = 0;
+            written = true;
+            writes++;
+            BENCH_COUNT("Motor write");
+            motor.Stop();
+        }
+
+        /** step
+            Moves the motor's percent towards the one it was set to, as far as the slew rate allows
+            @param now Current time (in seconds)
+        */
+        void step(double now) {
+            float next = target;
+            if(slewRate > 0) {
+                //A motor that sat still since the last step only gets one tick's worth of change
+                double elapsed = now - lastStep;
+                if(elapsed > CONTROL_PERIOD) {
+                    elapsed = CONTROL_PERIOD;
+                }
+                float most = slewRate * elapsed;
+                if(next > percent + most) {
+                    next = percent + most;
+                }
+                else if(next < percent - most) {
+                    next = percent - most;
+                }
+            }
+            lastStep = now;
+            write(next);
+        }
+
+        /** update
+            Background task that keeps a slew limited motor ramping between SetPercent() calls
+            @param data The DriveMotor
+            @param now Time the tick started (in seconds)
+        */
+        static void update(void *data, double now) {
+            DriveMotor *self = (DriveMotor *)data;
+            if(self->percent != self->target) {
+                self->step(now);
+            }
+            else {
+                self->lastStep = now;
+            }
+        }
+
+        /** setSlewRate
+            @param slewRate Fastest the percent may change (in percent per second), 0 for no limit
+        */
+        void setSlewRate(float slewRate) {
+            this->slewRate = slewRate;
+        }
+
+        float getSlewRate() const {
+            return slewRate;
+        }
+
+        /** getPercent
+            @return Percent the motor was last set to
+        */
+        float getPercent() const {
+            return percent;
+        }
+
+        /** getCommand
+            @return Whole percent last sent to the motor
+        */
+        int getCommand() const {
+            return command;
+        }
+
+        /** getTarget
+            @return Percent the motor is ramping towards
+        */
+        float getTarget() const {
+            return target;
+        }
+
+        /** getDirection
+            The encoders only count, so this is the best guess of which way the wheel is turning. A stopped
+            wheel is taken to still be coasting the way it was last driven.
+            @return 1 if the motor was last driven forward, -1 if backward
+        */
+        int getDirection() const {
+            return direction;
+        }
+
+        /** resetCounts
+            Clears the write counters
+            @param now Time to count writes per second from (in seconds)
+        */
+        void resetCounts(double now) {
+            writes = 0;
+            skipped = 0;
+            countStart = now;
+        }
+
+        unsigned long getWrites() const {
+            return writes;
+        }
+
+        /** getSkipped
+            @return Writes left out because the motor already had that command
+        */
+        unsigned long getSkipped() const {
+            return skipped;
+        }
+
+        /** getWriteRate
+            @param now Current time (in seconds)
+            @return Writes sent to the motor per second since the counters were reset
+        */
+        float getWriteRate(double now) const {
+            return now > countStart ? writes / (now - countStart) : 0;
+        }
+
+    private:
+        void write(float next) {
+            percent = next;
+            if(percent != 0) {
+                direction = percent > 0 ? 1 : -1;
+            }
+            int rounded = (int)lroundf(next);
+            if(written && rounded == command) {
+                skipped++;
+                BENCH_COUNT("Motor write skipped");
+                return;
+            }
+            command = rounded;
+            written = true;
+            writes++;
+            BENCH_COUNT("Motor write");
+            motor.SetPercent(command);
+        }
+
+        FEHMotor motor;
+        float slewRate;
+        float percent;
+        float target;
+        int direction;
+        //Whole percent last sent to the motor
+        int command;
+        double lastStep;
+        //false until the first write, so the first command always goes out
+        bool written;
+
+        unsigned long writes;
+        unsigned long skipped;
+        double countStart;
+};
+
+#endif
@@ -0,0 +1,263 @@
+#ifndef ODOMETRY_H
+#define ODOMETRY_H
+
+#include "sensors.h"
+#include "motor.h"
+#include "geometry.h"
+
+//Variance added per inch driven (inches^2) and per degree turned (degrees^2)
+#define ODOMETRY_POSITION_DRIFT 0.02
+#define ODOMETRY_HEADING_DRIFT 0.05
+//Heading variance added per inch driven, from the wheels slipping unevenly (degrees^2)
+#define ODOMETRY_HEADING_DRIFT_PER_INCH 0.02
+//Variance of one RPS reading (inches^2 and degrees^2)
+#define RPS_POSITION_VARIANCE 0.04
+#define RPS_HEADING_VARIANCE 1.0
+//How old an RPS reading is by the time it is read (in seconds)
+#define RPS_LATENCY 0.1
+//How many standard deviations off an RPS reading has to be before the wheels are taken to have slipped
+#define ODOMETRY_SLIP_SIGMAS 3
+//Variance of a pose that hasn't been fixed yet, so the first RPS reading replaces it
+#define POSE_UNKNOWN_VARIANCE 10000
+//Ticks of pose history kept to line RPS readings up with where the robot was when they were taken
+#define POSE_HISTORY 64
+
+/**
+ * This is a struct which holds where the robot is on the course.
+ */
+struct Pose
+{
+    float x;
+    float y;
+    //Degrees, measured the same way as RPS
+    float heading;
+    double time;
+};
+
+/**
+ * This is a class which keeps track of the robot's pose from the wheel encoders and corrects it whenever
+ * RPS has a valid reading, so callers always get a pose straight away instead of waiting for RPS.
+ *
+ * It is registered as a control loop task after the SensorBank. Each tick it turns the change in encoder
+ * counts into a move and a turn, using the direction each motor was last driven since the encoders only
+ * count up. The variance of the position and heading grows with every inch and degree, and shrinks when
+ * an RPS reading is blended in. RPS readings lag, so each one is compared with the pose from RPS_LATENCY
+ * ago and the difference is applied to the current pose, weighted by how much each is trusted. A reading
+ * that is much further off than expected means the wheels slipped, so it is trusted almost completely.
+ *
+ * Primitives reset the encoders, so they should call countsReset() right after they do.
+ */
+class PoseEstimator
+{
+    public:
+        PoseEstimator(const SensorBank &sensors, const DriveMotor &leftMotor, const DriveMotor &rightMotor,
+                      float countsPerInch, float leftCountsPerDegree, float rightCountsPerDegree)
+            : sensors(sensors), leftMotor(leftMotor), rightMotor(rightMotor) {
+            this->countsPerInch = countsPerInch;
+            this->leftCountsPerDegree = leftCountsPerDegree;
+            this->rightCountsPerDegree = rightCountsPerDegree;
+            lastLeft = lastRight = 0;
+            lastFixX = lastFixY = lastFixHeading = -1;
+            fixes = 0;
+            reset(0, 0, 0, POSE_UNKNOWN_VARIANCE);
+        }
+
+        /** reset
+            Sets the pose, for when the robot is placed somewhere known
+            @param variance How far off the pose might be (inches^2 and degrees^2)
+        */
+        void reset(float x, float y, float heading, float variance = 0) {
+            current.x = x;
+            current.y = y;
+            current.heading = normalizeDegrees(heading);
+            current.time = 0;
+            positionVariance = variance;
+            headingVariance = variance;
+            lastFixTime = -1;
+            historyCount = 0;
+            historyNext = 0;
+        }
+
+        /** countsReset
+            Tells the estimator the encoders were just reset to zero
+        */
+        void countsReset() {
+            lastLeft = 0;
+            lastRight = 0;
+        }
+
+        /** setConstants
+            Changes how encoder counts turn into inches and degrees, for when calibrated constants are loaded
+        */
+        void setConstants(float countsPerInch, float leftCountsPerDegree, float rightCountsPerDegree) {
+            this->countsPerInch = countsPerInch;
+            this->leftCountsPerDegree = leftCountsPerDegree;
+            this->rightCountsPerDegree = rightCountsPerDegree;
+        }
+
+        /** estimate
+            Moves the pose by the encoder counts since the last estimate, then blends in the frame's RPS
+            reading if it is a new valid one
+            @param now Time of the frame (in seconds)
+        */
+        void estimate(double now) {
+            const SensorFrame &frame = sensors.frame();
+            if(sensors.getChannels() & SENSE_ENCODERS) {
+                integrate(frame.leftCounts, frame.rightCounts);
+            }
+            current.time = now;
+            remember();
+            if((sensors.getChannels() & SENSE_RPS) && frame.x >= 0 && frame.heading >= 0 &&
+               (frame.x != lastFixX || frame.y != lastFixY || frame.heading != lastFixHeading)) {
+                lastFixX = frame.x;
+                lastFixY = frame.y;
+                lastFixHeading = frame.heading;
+                correct(frame.x, frame.y, frame.heading, now);
+            }
+        }
+
+        /** pose
+            @return The current pose estimate
+        */
+        const Pose &pose() const {
+            return current;
+        }
+
+        /** getPositionUncertainty
+            @return Standard deviation of the position (in inches)
+        */
+        float getPositionUncertainty() const {
+            return sqrt(positionVariance);
+        }
+
+        /** getHeadingUncertainty
+            @return Standard deviation of the heading (in degrees)
+        */
+        float getHeadingUncertainty() const {
+            return sqrt(headingVariance);
+        }
+
+        /** getTimeSinceFix
+            @param now Current time (in seconds)
+            @return Time since the last RPS reading was blended in (in seconds), or -1 if there hasn't been one
+        */
+        double getTimeSinceFix(double now) const {
+            return lastFixTime < 0 ? -1 : now - lastFixTime;
+        }
+
+        unsigned long getFixes() const {
+            return fixes;
+        }
+
+        /** update
+            Control loop task that keeps the estimate up to date
+            @param estimator The PoseEstimator to update
+            @param now Time the tick started (in seconds)
+        */
+        static void update(void *estimator, double now) {
+            ((PoseEstimator *)estimator)->estimate(now);
+        }
+
+    private:
+        void integrate(int leftCounts, int rightCounts) {
+            //A count lower than last time means the encoders were reset without countsReset()
+            int leftDelta = leftCounts >= lastLeft ? leftCounts - lastLeft : leftCounts;
+            int rightDelta = rightCounts >= lastRight ? rightCounts - lastRight : rightCounts;
+            lastLeft = leftCounts;
+            lastRight = rightCounts;
+            if(leftDelta == 0 && rightDelta == 0) {
+                return;
+            }
+            float left = leftMotor.getDirection() * leftDelta;
+            float right = rightMotor.getDirection() * rightDelta;
+            float inches = (left + right) / 2 / countsPerInch;
+            float turn = (right - left) / 2;
+            float degrees = turn / (turn > 0 ? leftCountsPerDegree : rightCountsPerDegree);
+            //Move along the heading halfway through the turn
+            float midHeading = current.heading + degrees / 2;
+            current.x += inches * cosDegrees(midHeading);
+            current.y += inches * sinDegrees(midHeading);
+            current.heading = normalizeDegrees(current.heading + degrees);
+            positionVariance += ODOMETRY_POSITION_DRIFT * fabs(inches);
+            headingVariance += ODOMETRY_HEADING_DRIFT * fabs(degrees) + ODOMETRY_HEADING_DRIFT_PER_INCH * fabs(inches);
+        }
+
+        void remember() {
+            history[historyNext] = current;
+            historyNext = (historyNext + 1) % POSE_HISTORY;
+            if(historyCount < POSE_HISTORY) {
+                historyCount++;
+            }
+        }
+
+        /** poseAt
+            @return The newest remembered pose from at or before a time, or the oldest one kept
+        */
+        const Pose &poseAt(double time) const {
+            int index = historyNext;
+            for(int i = 0; i < historyCount; i++) {
+                index = (index + POSE_HISTORY - 1) % POSE_HISTORY;
+                if(history[index].time <= time) {
+                    return history[index];
+                }
+            }
+            return history[index];
+        }
+
+        void correct(float x, float y, float heading, double now) {
+            const Pose &then = poseAt(now - RPS_LATENCY);
+            //A reading further off than the variances allow means the wheels slipped, against a wall or
+            //on the ramp, so the encoders can't be trusted over RPS until the next reading
+            float dx = x - then.x;
+            float dy = y - then.y;
+            float dHeading = angleDifference(heading, then.heading);
+            if(dx * dx + dy * dy > ODOMETRY_SLIP_SIGMAS * ODOMETRY_SLIP_SIGMAS * (positionVariance + RPS_POSITION_VARIANCE)) {
+                positionVariance += dx * dx + dy * dy;
+            }
+            if(dHeading * dHeading > ODOMETRY_SLIP_SIGMAS * ODOMETRY_SLIP_SIGMAS * (headingVariance + RPS_HEADING_VARIANCE)) {
+                headingVariance += dHeading * dHeading;
+            }
+            float positionGain = positionVariance / (positionVariance + RPS_POSITION_VARIANCE);
+            float headingGain = headingVariance / (headingVariance + RPS_HEADING_VARIANCE);
+            dx *= positionGain;
+            dy *= positionGain;
+            dHeading *= headingGain;
+            current.x += dx;
+            current.y += dy;
+            current.heading = normalizeDegrees(current.heading + dHeading);
+            //Shift the history too so the next reading isn't compared against the uncorrected poses
+            for(int i = 0; i < historyCount; i++) {
+                history[i].x += dx;
+                history[i].y += dy;
+                history[i].heading = normalizeDegrees(history[i].heading + dHeading);
+            }
+            positionVariance *= 1 - positionGain;
+            headingVariance *= 1 - headingGain;
+            lastFixTime = now;
+            fixes++;
+        }
+
+        const SensorBank &sensors;
+        const DriveMotor &leftMotor;
+        const DriveMotor &rightMotor;
+        float countsPerInch;
+        float leftCountsPerDegree;
+        float rightCountsPerDegree;
+
+        Pose current;
+        float positionVariance;
+        float headingVariance;
+        int lastLeft;
+        int lastRight;
+        float lastFixX;
+        float lastFixY;
+        float lastFixHeading;
+        double lastFixTime;
+        unsigned long fixes;
+
+        Pose history[POSE_HISTORY];
+        int historyCount;
+        int historyNext;
+};
+
+#endif
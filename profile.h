@@ -0,0 +1,110 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <math.h>
+
+/**
+ * This is a class which plans a trapezoidal velocity profile for a straight move.
+ *
+ * The robot accelerates at a constant rate up to the maximum velocity, cruises, then decelerates at the
+ * same rate so it arrives at the end with zero velocity. Moves too short to reach the maximum velocity
+ * become a triangle that peaks halfway. Distances and velocities can be in any units as long as they
+ * agree (the drive code uses inches and seconds).
+ */
+class TrapezoidProfile
+{
+    public:
+        /** TrapezoidProfile
+            @param distance Length of the move (must not be negative)
+            @param maxVelocity Fastest speed allowed during the move
+            @param acceleration Rate used to speed up and slow down
+        */
+        TrapezoidProfile(float distance, float maxVelocity, float acceleration) {
+            this->distance = distance;
+            this->acceleration = acceleration;
+            if(distance * acceleration < maxVelocity * maxVelocity) {
+                //Triangle profile, never reaches max velocity
+                peakVelocity = sqrt(distance * acceleration);
+            }
+            else {
+                peakVelocity = maxVelocity;
+            }
+            accelTime = acceleration > 0 ? peakVelocity / acceleration : 0;
+            float accelDistance = 0.5 * peakVelocity * accelTime;
+            cruiseTime = peakVelocity > 0 ? (distance - 2 * accelDistance) / peakVelocity : 0;
+            duration = 2 * accelTime + cruiseTime;
+        }
+
+        /** position
+            @param t Time since the start of the move
+            @return Distance the robot should have covered
+        */
+        float position(float t) const {
+            if(t <= 0) {
+                return 0;
+            }
+            if(t < accelTime) {
+                return 0.5 * acceleration * t * t;
+            }
+            if(t < accelTime + cruiseTime) {
+                return 0.5 * peakVelocity * accelTime + peakVelocity * (t - accelTime);
+            }
+            if(t < duration) {
+                float remaining = duration - t;
+                return distance - 0.5 * acceleration * remaining * remaining;
+            }
+            return distance;
+        }
+
+        /** velocity
+            @param t Time since the start of the move
+            @return Speed the robot should be moving at
+        */
+        float velocity(float t) const {
+            if(t <= 0 || t >= duration) {
+                return 0;
+            }
+            if(t < accelTime) {
+                return acceleration * t;
+            }
+            if(t < accelTime + cruiseTime) {
+                return peakVelocity;
+            }
+            return acceleration * (duration - t);
+        }
+
+        /** accelerationAt
+            @param t Time since the start of the move
+            @return Acceleration the robot should have (negative while slowing down)
+        */
+        float accelerationAt(float t) const {
+            if(t <= 0 || t >= duration) {
+                return 0;
+            }
+            if(t < accelTime) {
+                return acceleration;
+            }
+            if(t < accelTime + cruiseTime) {
+                return 0;
+            }
+            return -acceleration;
+        }
+
+        float getDuration() const {
+            return duration;
+        }
+
+        float getPeakVelocity() const {
+            return peakVelocity;
+        }
+
+    private:
+        float distance;
+        float acceleration;
+        float peakVelocity;
+        float accelTime;
+        float cruiseTime;
+        float duration;
+};
+
+#endif
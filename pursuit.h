@@ -0,0 +1,211 @@
+#ifndef PURSUIT_H
+#define PURSUIT_H
+
+#include "geometry.h"
+#include "odometry.h"
+
+//Most waypoints in one path, not counting where the robot starts
+#define MAX_WAYPOINTS 8
+
+/**
+ * This is a struct which holds a point on the course for the robot to drive through.
+ */
+struct Waypoint
+{
+    float x;
+    float y;
+};
+
+/**
+ * This is a class which steers the robot along a path of straight segments using pure pursuit.
+ *
+ * Each tick the robot's pose is projected onto the path and a goal point is picked a fixed lookahead
+ * distance further along it. The robot drives the arc that passes through the goal point, so it curves
+ * smoothly onto each new segment instead of stopping to turn at the corners. A shorter lookahead follows
+ * the corners more tightly, a longer one is smoother. A goal point behind the robot turns it in place
+ * until the goal is in front again. The robot stops once it is level with the last waypoint.
+ *
+ * When driving backwards the robot is steered as if its back were its front.
+ */
+class PurePursuit
+{
+    public:
+        PurePursuit(float lookahead, float trackWidth) {
+            this->lookahead = lookahead;
+            this->trackWidth = trackWidth;
+            count = 0;
+            segment = 0;
+            remaining = 0;
+        }
+
+        /** start
+            Sets the path to follow from where the robot is now
+            @param x Where the robot is
+            @param y Where the robot is
+            @param points Waypoints to drive through in order
+            @param pointCount Number of waypoints, at most MAX_WAYPOINTS
+        */
+        void start(float x, float y, const Waypoint *points, int pointCount) {
+            if(pointCount > MAX_WAYPOINTS) {
+                pointCount = MAX_WAYPOINTS;
+            }
+            path[0].x = x;
+            path[0].y = y;
+            for(int i = 0; i < pointCount; i++) {
+                path[i + 1] = points[i];
+            }
+            count = pointCount + 1;
+            segment = 0;
+            remaining = length();
+        }
+
+        /** steer
+            Picks the wheel speeds that keep the robot on the path
+            @param pose Where the robot is
+            @param backwards true to drive the path in reverse
+            @param tolerance How close to the last waypoint counts as there (in inches)
+            @param left Set to the left wheel's share of the speed (-1 to 1)
+            @param right Set to the right wheel's share of the speed (-1 to 1)
+            @return false once the robot has reached the end of the path
+        */
+        bool steer(const Pose &pose, bool backwards, float tolerance, float &left, float &right) {
+            left = right = 0;
+            if(count < 2) {
+                return false;
+            }
+            //Move on to the next segment once the robot is past the end of this one, or closer to the next
+            //one, which it is after cutting a sharp corner
+            float t = project(pose.x, pose.y, segment);
+            while(segment < count - 2) {
+                float next = project(pose.x, pose.y, segment + 1);
+                if(t < 1 && distanceFrom(pose.x, pose.y, segment, t) < distanceFrom(pose.x, pose.y, segment + 1, next)) {
+                    break;
+                }
+                segment++;
+                t = next;
+            }
+            const Waypoint &end = path[count - 1];
+            float segmentLength = distanceBetween(path[segment].x, path[segment].y, path[segment + 1].x, path[segment + 1].y);
+            remaining = (1 - t) * segmentLength;
+            for(int i = segment + 1; i < count - 1; i++) {
+                remaining += distanceBetween(path[i].x, path[i].y, path[i + 1].x, path[i + 1].y);
+            }
+            if(distanceBetween(pose.x, pose.y, end.x, end.y) < tolerance || (segment == count - 2 && t >= 1)) {
+                remaining = 0;
+                return false;
+            }
+
+            Waypoint goal = pointAlong(segment, t, lookahead);
+            float heading = backwards ? pose.heading + 180 : pose.heading;
+            float cosine = cosDegrees(heading);
+            float sine = sinDegrees(heading);
+            float dx = goal.x - pose.x;
+            float dy = goal.y - pose.y;
+            //Goal point in the robot's frame, ahead is +x and to the left is +y
+            float ahead = cosine * dx + sine * dy;
+            float side = -sine * dx + cosine * dy;
+            float forwardLeft, forwardRight;
+            if(ahead <= 0) {
+                forwardLeft = side >= 0 ? -1 : 1;
+                forwardRight = -forwardLeft;
+            }
+            else {
+                float curvature = 2 * side / (dx * dx + dy * dy);
+                forwardLeft = 1 - curvature * trackWidth / 2;
+                forwardRight = 1 + curvature * trackWidth / 2;
+                float largest = fabs(forwardLeft) > fabs(forwardRight) ? fabs(forwardLeft) : fabs(forwardRight);
+                if(largest > 1) {
+                    forwardLeft /= largest;
+                    forwardRight /= largest;
+                }
+            }
+            if(backwards) {
+                //The back is the front, so the sides swap and the wheels run the other way
+                left = -forwardRight;
+                right = -forwardLeft;
+            }
+            else {
+                left = forwardLeft;
+                right = forwardRight;
+            }
+            return true;
+        }
+
+        /** getRemaining
+            @return Distance left along the path from the robot's last position (in inches)
+        */
+        float getRemaining() const {
+            return remaining;
+        }
+
+        /** length
+            @return Length of the whole path (in inches)
+        */
+        float length() const {
+            float total = 0;
+            for(int i = 0; i < count - 1; i++) {
+                total += distanceBetween(path[i].x, path[i].y, path[i + 1].x, path[i + 1].y);
+            }
+            return total;
+        }
+
+    private:
+        /** project
+            @return How far along a segment the closest point to (x, y) is, 0 at its start and 1 at its end
+        */
+        float project(float x, float y, int i) const {
+            float sx = path[i + 1].x - path[i].x;
+            float sy = path[i + 1].y - path[i].y;
+            float lengthSquared = sx * sx + sy * sy;
+            if(lengthSquared == 0) {
+                return 1;
+            }
+            float t = ((x - path[i].x) * sx + (y - path[i].y) * sy) / lengthSquared;
+            return t < 0 ? 0 : t;
+        }
+
+        /** distanceFrom
+            @return Distance from (x, y) to a point part way along a segment
+        */
+        float distanceFrom(float x, float y, int i, float t) const {
+            if(t > 1) {
+                t = 1;
+            }
+            return distanceBetween(x, y, path[i].x + t * (path[i + 1].x - path[i].x),
+                                   path[i].y + t * (path[i + 1].y - path[i].y));
+        }
+
+        /** pointAlong
+            @return The point a distance further along the path from a point on a segment. Past the end the
+                    last segment is carried on in a straight line, so the goal never ends up right next to the
+                    robot, where it would circle the last waypoint instead of stopping on it.
+        */
+        Waypoint pointAlong(int i, float t, float distance) const {
+            Waypoint point;
+            point.x = path[i].x + t * (path[i + 1].x - path[i].x);
+            point.y = path[i].y + t * (path[i + 1].y - path[i].y);
+            while(true) {
+                float left = distanceBetween(point.x, point.y, path[i + 1].x, path[i + 1].y);
+                if(distance <= left || i == count - 2) {
+                    float length = distanceBetween(path[i].x, path[i].y, path[i + 1].x, path[i + 1].y);
+                    if(length > 0) {
+                        point.x += distance * (path[i + 1].x - path[i].x) / length;
+                        point.y += distance * (path[i + 1].y - path[i].y) / length;
+                    }
+                    return point;
+                }
+                distance -= left;
+                point = path[i + 1];
+                i++;
+            }
+        }
+
+        float lookahead;
+        float trackWidth;
+        Waypoint path[MAX_WAYPOINTS + 1];
+        int count;
+        int segment;
+        float remaining;
+};
+
+#endif
@@ -0,0 +1,222 @@
+#ifndef RECORDER_H
+#define RECORDER_H
+
+#include <FEHSD.h>
+#include <stdint.h>
+#include "sensors.h"
+#include "motor.h"
+#include "motion.h"
+#include "bench.h"
+
+//Records kept in memory, one per control tick, so the ring holds the last 4 seconds or so at 500 Hz
+//(24 bytes each). The whole run, or even its longest phase, would take more memory than the Proteus has.
+#define FLIGHT_RECORD_COUNT 2048
+//Bumped whenever FlightRecord or the file layout changes so old dumps aren't decoded wrong
+#define FLIGHT_RECORD_VERSION 2
+//File the records are written to on the SD card
+#define FLIGHT_LOG_FILE "FLIGHT.TXT"
+//Stored value per second, inch, degree and volt
+#define FLIGHT_TIME_SCALE 10000
+#define FLIGHT_POSITION_SCALE 100
+#define FLIGHT_HEADING_SCALE 100
+#define FLIGHT_VOLTS_SCALE 50
+//Bits of FlightRecord::flags, the bump bits are set while the switch is pressed
+#define FLIGHT_LEFT_BUMP 1
+#define FLIGHT_RIGHT_BUMP 2
+#define FLIGHT_RPS_VALID 4
+//Primitive stored when no phase or primitive is running
+#define FLIGHT_NO_PRIMITIVE 255
+
+/**
+ * This is a struct which holds one control tick of the flight recorder, packed into 24 bytes.
+ * Times are in 0.1 ms, positions in 0.01 inch, headings in 0.01 degree and voltages in 0.02 V.
+ * Sensors that weren't selected for the tick hold the last value read, channels says which were fresh.
+ */
+struct FlightRecord
+{
+    uint32_t time;
+    int16_t leftCounts;
+    int16_t rightCounts;
+    int16_t x;
+    int16_t y;
+    uint16_t heading;
+    int8_t leftPercent;
+    int8_t rightPercent;
+    uint8_t lineLeft;
+    uint8_t lineMiddle;
+    uint8_t lineRight;
+    uint8_t cds1;
+    uint8_t cds2;
+    uint8_t flags;
+    uint8_t primitive;
+    uint8_t channels;
+};
+
+static_assert(sizeof(FlightRecord) == 24, "FlightRecord is written to the SD card byte for byte");
+
+/**
+ * This is a class which keeps the last few seconds of sensor readings and motor commands so a bad run
+ * can be looked at afterwards.
+ *
+ * It is registered as a control loop task after the SensorBank, so every tick it copies the new frame,
+ * the percent each motor was running at while it was read, and the phase or primitive running (from the
+ * BENCH_PHASE() and BENCH_PRIMITIVE() markers) into a fixed ring of records. Set as the MotionWatch
+ * failure handler, it stops recording when the first primitive fails, so the ring still holds what led
+ * up to it when the run is over. Nothing is allocated and nothing is written to the card until save() is
+ * called after the run.
+ *
+ * FEHSD only has formatted writes, so save() writes each record as a line of hex. sim/flightdecode.cpp
+ * turns the file back into a CSV and a per-primitive timeline.
+ */
+class FlightRecorder
+{
+    public:
+        FlightRecorder(const SensorBank &sensors, const DriveMotor &leftMotor, const DriveMotor &rightMotor)
+            : sensors(sensors), leftMotor(leftMotor), rightMotor(rightMotor) {
+            next = 0;
+            total = 0;
+            frozen = false;
+        }
+
+        /** record
+            Adds one record made from the current frame and motor percents
+            @param now Time the tick started (in seconds)
+        */
+        void record(double now) {
+            BENCH_SECTION(BENCH_RECORDER);
+            const SensorFrame &frame = sensors.frame();
+            FlightRecord &entry = records[next];
+            entry.time = (uint32_t)(now * FLIGHT_TIME_SCALE);
+            entry.leftCounts = (int16_t)frame.leftCounts;
+            entry.rightCounts = (int16_t)frame.rightCounts;
+            entry.x = (int16_t)(frame.x * FLIGHT_POSITION_SCALE);
+            entry.y = (int16_t)(frame.y * FLIGHT_POSITION_SCALE);
+            entry.heading = (uint16_t)(int)(frame.heading * FLIGHT_HEADING_SCALE);
+            entry.leftPercent = (int8_t)leftMotor.getPercent();
+            entry.rightPercent = (int8_t)rightMotor.getPercent();
+            entry.lineLeft = volts(frame.lineLeft);
+            entry.lineMiddle = volts(frame.lineMiddle);
+            entry.lineRight = volts(frame.lineRight);
+            entry.cds1 = volts(frame.cds1);
+            entry.cds2 = volts(frame.cds2);
+            entry.flags = 0;
+            if(!frame.leftBump) {
+                entry.flags |= FLIGHT_LEFT_BUMP;
+            }
+            if(!frame.rightBump) {
+                entry.flags |= FLIGHT_RIGHT_BUMP;
+            }
+            if(frame.x >= 0) {
+                entry.flags |= FLIGHT_RPS_VALID;
+            }
+            int primitive = bench.getCurrent();
+            entry.primitive = primitive < 0 ? FLIGHT_NO_PRIMITIVE : (uint8_t)primitive;
+            entry.channels = (uint8_t)sensors.getChannels();
+            next = (next + 1) % FLIGHT_RECORD_COUNT;
+            total++;
+        }
+
+        /** freeze
+            Stops recording, keeping the records held
+        */
+        void freeze() {
+            frozen = true;
+        }
+
+        bool isFrozen() const {
+            return frozen;
+        }
+
+        /** getTotal
+            @return Number of records made so far, including ones that have been overwritten
+        */
+        unsigned long getTotal() const {
+            return total;
+        }
+
+        /** getCount
+            @return Number of records held
+        */
+        int getCount() const {
+            return total < FLIGHT_RECORD_COUNT ? (int)total : FLIGHT_RECORD_COUNT;
+        }
+
+        /** getRecord
+            @param i Index of the record, 0 is the oldest one held
+        */
+        const FlightRecord &getRecord(int i) const {
+            int first = total < FLIGHT_RECORD_COUNT ? 0 : next;
+            return records[(first + i) % FLIGHT_RECORD_COUNT];
+        }
+
+        /** save
+            Writes the primitive names and the records, oldest first, to a file on the SD card
+            @param filename File to write
+            @return false if the file couldn't be opened
+        */
+        bool save(const char *filename = FLIGHT_LOG_FILE) {
+            FEHFile *file = SD.FOpen(filename, "w");
+            if(!file) {
+                return false;
+            }
+            SD.FPrintf(file, "FLIGHT %d %d %lu %d\n", FLIGHT_RECORD_VERSION, (int)sizeof(FlightRecord), total,
+                       frozen ? 1 : 0);
+            for(int i = 0; i < bench.getCount(); i++) {
+                SD.FPrintf(file, "P %d %s\n", i, bench.getEntry(i).name);
+            }
+            static const char HEX_DIGITS[] = "0123456789abcdef";
+            char line[2 * sizeof(FlightRecord) + 1];
+            for(int i = 0; i < getCount(); i++) {
+                const unsigned char *bytes = (const unsigned char *)&getRecord(i);
+                for(unsigned int b = 0; b < sizeof(FlightRecord); b++) {
+                    line[2 * b] = HEX_DIGITS[bytes[b] >> 4];
+                    line[2 * b + 1] = HEX_DIGITS[bytes[b] & 15];
+                }
+                line[2 * sizeof(FlightRecord)] = 0;
+                SD.FPrintf(file, "R %s\n", line);
+            }
+            SD.FPrintf(file, "END\n");
+            SD.FClose(file);
+            return true;
+        }
+
+        /** update
+            Control loop task that makes a record every tick until the recorder is frozen
+            @param recorder The FlightRecorder to update
+            @param now Time the tick started (in seconds)
+        */
+        static void update(void *recorder, double now) {
+            FlightRecorder *self = (FlightRecorder *)recorder;
+            if(!self->frozen) {
+                self->record(now);
+            }
+        }
+
+        /** primitiveFailed
+            MotionWatch failure handler that freezes the recorder
+            @param recorder The FlightRecorder to freeze
+        */
+        static void primitiveFailed(void *recorder, const MotionResult &) {
+            ((FlightRecorder *)recorder)->freeze();
+        }
+
+    private:
+        static uint8_t volts(float value) {
+            float scaled = value * FLIGHT_VOLTS_SCALE + 0.5f;
+            if(scaled <= 0) {
+                return 0;
+            }
+            return scaled >= 255 ? 255 : (uint8_t)scaled;
+        }
+
+        const SensorBank &sensors;
+        const DriveMotor &leftMotor;
+        const DriveMotor &rightMotor;
+
+        FlightRecord records[FLIGHT_RECORD_COUNT];
+        int next;
+        unsigned long total;
+        bool frozen;
+};
+
+#endif
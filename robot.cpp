@@ -1,1295 +1,1800 @@
-//Including FEH libraries
-#include <FEHLCD.h>
-#include <FEHIO.h>
-#include <FEHUtility.h>
-#include <FEHMotor.h>
-#include <FEHRPS.h>
-#include <math.h>
-#include <FEHServo.h>
-#include "locations.h"
-//Defining states for following lines
-#define ON_LINE 3
-#define CENTER 0
-#define LEFT -1
-#define FAR_LEFT -2
-#define RIGHT 1
-#define FAR_RIGHT 2
-#define OFF_LINE 4
-//Defining constants to convert counts to inches or degrees
-#define COUNTS_PER_INCH 33.74
-#define LEFT_COUNTS_PER_DEGREE 1.955
-#define RIGHT_COUNTS_PER_DEGREE 1.88
-//Define thresholds for line following/start light
-#define START_LIGHT_ON 1.5
-#define BLUE_LIGHT_ON 0.75
-//Tuning constant
-#define TUNING_CONSTANT 0.08
-#define I_TUNING_CONSTANT 0.01
-//PI
-# define M_PI           3.14159265358979323846
-#define SPEED 40
-#define MAX_SPEED 45
-
-//Declarations for encoders & motors
-ButtonBoard buttons(FEHIO::Bank3);
-DigitalEncoder right_encoder(FEHIO::P0_1);
-DigitalEncoder left_encoder(FEHIO::P0_0);
-FEHMotor right_motor(FEHMotor::Motor2,12.0);
-FEHMotor left_motor(FEHMotor::Motor3,12.0);
-FEHServo arm(FEHServo::Servo0);
-
-AnalogInputPin right(FEHIO::P1_2);
-AnalogInputPin middle(FEHIO::P1_4);
-AnalogInputPin left(FEHIO::P1_6);
-AnalogInputPin cds1(FEHIO::P3_0);
-AnalogInputPin cds2(FEHIO::P3_1);
-
-
-DigitalInputPin frontLeftBump(FEHIO::P2_0);
-DigitalInputPin frontRightBump(FEHIO::P2_1);
-
-double accum_error = 0;
-
-float SUPPLIES_X = 29.35;
-float SUPPLIES_Y = 12.3;
-float DROP_OFF_X = 5.5;
-float DROP_OFF_Y = 49.5;
-float START_X = 7.6;
-float START_Y = 8.9 ;
-int lightColor;
-void bumpValues() {
-    LCD.WriteLine(frontLeftBump.Value());
-    LCD.WriteLine(frontRightBump.Value());
-}
-void setRPSCoords() {
-    LCD.WriteLine("SUPPLIES");
-    float x, y;
-    while(!LCD.Touch(&x, &y)) {
-        LCD.WriteLine(RPS.X());
-        LCD.WriteLine(RPS.Y());
-        LCD.DrawRectangle(289, 219, 30, 20);
-        Sleep(50);
-        LCD.Clear();
-    }
-    if(x > 289 && y > 219) {
-        return;
-    }
-    SUPPLIES_X = RPS.X();
-    SUPPLIES_Y = RPS.Y();\
-    LCD.Clear();
-    LCD.WriteLine("DROP OFF");
-    Sleep(1.0);
-    while(!LCD.Touch(&x, &y)) {
-        LCD.WriteLine(RPS.X());
-        LCD.WriteLine(RPS.Y());
-        LCD.DrawRectangle(289, 219, 30, 20);
-        Sleep(50);
-        LCD.Clear();
-    }
-    if(x > 289 && y > 219) {
-        SUPPLIES_X = 29.35;
-        SUPPLIES_Y = 12.3;
-        return;
-    }
-    DROP_OFF_X = RPS.X();
-}
-
-
-
-/** move_forward
-    Moves the robot forward
-    @param percent Motor percent
-    @param inches Distance robot needs to travel
-*/
-void move_forward(int percent, float inches) //using encoders
-{
-    //Reset encoder counts
-    right_encoder.ResetCounts();
-    left_encoder.ResetCounts();
-    float counts = inches*COUNTS_PER_INCH;
-    //Set both motors to desired percent
-    right_motor.SetPercent(percent);
-    Sleep(1);
-    left_motor.SetPercent(percent);
-    int mp = percent;
-
-    //While the average of the left and right encoder are less than counts,
-    //keep running motors
-    while((left_encoder.Counts() + right_encoder.Counts()) / 2. < counts && (frontLeftBump.Value() && frontRightBump.Value()) ) {
-        double current_error = (left_encoder.Counts()-right_encoder.Counts());
-        accum_error +=current_error;
-        mp = TUNING_CONSTANT*current_error+I_TUNING_CONSTANT*accum_error+(percent);
-        right_motor.SetPercent(mp);
-        bumpValues();
-    }
-
-    right_motor.SetPercent(-20);
-    left_motor.SetPercent(-20);
-    Sleep(100);
-    //Turn off motors
-    right_motor.Stop();
-    left_motor.Stop();
-}
-
-/** move_forward_timed
-    Moves the robot forward, stopping when a certain time is reached or a distance is met
-    @param percent Motor percent
-    @param inches Distance robot needs to travel
-    @param time Time robot should be moving (in seconds)
-*/
-void move_forward_timed(int percent, float inches, double time) //using encoders
-{
-    //Reset encoder counts
-    right_encoder.ResetCounts();
-    left_encoder.ResetCounts();
-    float counts = inches*COUNTS_PER_INCH;
-    //Set both motors to desired percent
-    right_motor.SetPercent(percent);
-    left_motor.SetPercent(percent);
-    int mp = percent;
-
-    //While the average of the left and right encoder are less than counts,
-    //keep running motors
-    double start_time = TimeNow();
-    while((left_encoder.Counts() + right_encoder.Counts()) / 2. < counts && TimeNow() - start_time < time && (frontLeftBump.Value() && frontRightBump.Value())) {
-//        double current_error = (left_encoder.Counts()-right_encoder.Counts());
-//        accum_error +=current_error;
-//        mp = TUNING_CONSTANT*current_error+I_TUNING_CONSTANT*accum_error+(percent);
-//        right_motor.SetPercent(mp);
-//        bumpValues();
-    }
-
-    //Turn off motors
-    right_motor.Stop();
-    left_motor.Stop();
-}
-void pivot_right(int percent, float degrees) {
-    //Reset encoder counts
-    right_encoder.ResetCounts();
-    left_encoder.ResetCounts();
-    float counts = degrees * LEFT_COUNTS_PER_DEGREE * 1.05;
-    left_motor.SetPercent(percent);
-    right_motor.SetPercent((-percent) * 0.7);
-    while((right_encoder.Counts() + left_encoder.Counts())/2. < counts);
-
-    //Turn off motors
-    right_motor.Stop();
-    left_motor.Stop();
-}
-
-/** move_backwards
-    Moves the robot backwards
-    @param percent Motor percent
-    @param inches Distance robot needs to travel
-*/
-void move_backwards(int percent, double inches) //using encoders
-{
-    //Reset encoder counts
-    right_encoder.ResetCounts();
-    left_encoder.ResetCounts();
-    double counts = inches*COUNTS_PER_INCH;
-    //Set both motors to desired percent
-    right_motor.SetPercent(-1*percent);
-    left_motor.SetPercent(-1*percent);
-    int mp = percent;
-    //While the average of the left and right encoder are less than counts,
-    //keep running motors
-     while((left_encoder.Counts() + right_encoder.Counts()) / 2. < counts) {
-         mp = TUNING_CONSTANT*(left_encoder.Counts()-right_encoder.Counts())+(percent);
-         mp *= -1;
-         right_motor.SetPercent(mp);
-     }
-
-    //Turn off motors
-    right_motor.Stop();
-    left_motor.Stop();
-}
-/** move_backwards_timed
-    Moves the robot backwards, stopping when a certain time is reached or a distance is met
-    @param percent Motor percent
-    @param inches Distance robot needs to travel
-    @param time Time robot should be moving (in seconds)
-*/
-void move_backwards_timed(int percent, float inches, float time) //using encoders
-{
-    //Reset encoder counts
-    right_encoder.ResetCounts();
-    left_encoder.ResetCounts();
-    float counts = inches*COUNTS_PER_INCH;
-    //Set both motors to desired percent
-    right_motor.SetPercent(-1 * percent);
-    left_motor.SetPercent(-1 * percent);
-    int mp = percent;
-
-    //While the average of the left and right encoder are less than counts,
-    //keep running motors
-    float start_time = TimeNow();
-    while((left_encoder.Counts() + right_encoder.Counts()) / 2. < counts && TimeNow() - start_time < time) {
-
-    }
-
-
-    //Turn off motors
-    right_motor.Stop();
-    left_motor.Stop();
-}
-
-
-/** driveToWall
-    Moves the robot forward, stopping when it hits a wall
-    @param percent Motor percent
-*/
-void driveToWall(int percent) {
-
-    right_motor.SetPercent(percent);
-    left_motor.SetPercent(percent);
-    int mp = percent;
-    double start_time = TimeNow();
-    while((frontLeftBump.Value() || frontRightBump.Value()) && TimeNow() - start_time < 3.0) {
-
-        if(!frontRightBump.Value()) {
-            left_motor.SetPercent(percent+ 10);
-            right_motor.SetPercent(-1 * percent * .1);
-        }
-        else if(!frontLeftBump.Value()) {
-            right_motor.SetPercent(percent+10);
-            left_motor.SetPercent(-1 * percent * .1);
-        }
-        else {
-            double current_error = (left_encoder.Counts()-right_encoder.Counts());
-            mp = TUNING_CONSTANT*current_error+(percent);
-            right_motor.SetPercent(mp);
-            if(percent < 0) {
-                mp *= -1;
-            }
-        }
-    }
-    //Turn off motors
-    right_motor.Stop();
-    left_motor.Stop();
-}
-
-/** followLine
-    Makes the robot follow a line.
-    @param speed Motor percent
-*/
-void followLine(float speed, float distance) {
-        int leftValue, rightValue, midValue, state;
-        float counts = distance * COUNTS_PER_INCH;
-        right_encoder.ResetCounts();
-        left_encoder.ResetCounts();
-        int start_time = TimeNow();
-        while((left_encoder.Counts() + right_encoder.Counts()) / 2. < counts && TimeNow() - start_time < 3 && (frontLeftBump.Value() || frontRightBump.Value()))
-        {
-            leftValue = left.Value();
-            rightValue = right.Value();
-            midValue = middle.Value();
-
-            if(midValue >= ON_LINE && rightValue <= ON_LINE && leftValue<= ON_LINE) {
-                state = CENTER;
-            }
-            else if(midValue >= ON_LINE && rightValue>= ON_LINE && leftValue <= ON_LINE) {
-                state = LEFT;
-            }
-            else if(midValue <= ON_LINE && rightValue>= ON_LINE && leftValue <= ON_LINE) {
-                state = FAR_LEFT;
-            }
-            else if(midValue >= ON_LINE && rightValue<= ON_LINE && leftValue >= ON_LINE) {
-                state = RIGHT;
-            }
-            else if(midValue <= ON_LINE && rightValue<= ON_LINE && leftValue >= ON_LINE) {
-                state = FAR_RIGHT;
-            }
-            else {
-                state = OFF_LINE;
-            }
-
-
-            if(!(frontLeftBump.Value() && frontRightBump.Value()))
-            {
-                if(!frontRightBump.Value()) {
-                    left_motor.SetPercent(speed+10);
-                    right_motor.SetPercent(-15);
-                }
-                else if(!frontLeftBump.Value()) {
-                    right_motor.SetPercent(speed+10);
-                    left_motor.SetPercent(-15);
-                }
-            }
-            else {
-                switch(state) {
-                    case CENTER:
-                        LCD.WriteLine("CENTER");
-                        left_motor.SetPercent(speed);
-                        right_motor.SetPercent(speed);
-                        break;
-                    case LEFT:
-                    LCD.WriteLine("LEFT");
-                        left_motor.SetPercent(speed);
-                        right_motor.SetPercent(.75 *speed);
-                        break;
-                    case FAR_LEFT:
-                    LCD.WriteLine("FAR LEFT");
-                        left_motor.SetPercent(speed);
-                        right_motor.SetPercent(.5*speed);
-                        break;
-                    case RIGHT:
-                    LCD.WriteLine("RIGHT");
-                        left_motor.SetPercent(.75*speed);
-                        right_motor.SetPercent(speed);
-                        break;
-                    case FAR_RIGHT:
-                    LCD.WriteLine("FAR RIGHT");
-                        left_motor.SetPercent(.5*speed);
-                        right_motor.SetPercent(speed);
-                        break;
-                    case OFF_LINE:
-                    LCD.WriteLine("OFFLINE");
-                        left_motor.SetPercent(speed);
-                        right_motor.SetPercent(speed);
-                        break;
-
-
-                }
-            }
-
-        }
-}
-void followLineYellowSquare(float speed, float distance) {
-        int leftValue, rightValue, midValue, state;
-        float counts = distance * COUNTS_PER_INCH;
-        right_encoder.ResetCounts();
-        left_encoder.ResetCounts();
-        int start_time = TimeNow();
-        while((left_encoder.Counts() + right_encoder.Counts()) / 2. < counts && (TimeNow() - start_time < 5) && (frontLeftBump.Value() || frontRightBump.Value()))
-        {
-            leftValue = left.Value();
-            rightValue = right.Value();
-            midValue = middle.Value();
-            bumpValues();
-
-            if(midValue <= ON_LINE && rightValue >= ON_LINE && leftValue>= ON_LINE) {
-                state = CENTER;
-            }
-            else if(midValue <= ON_LINE && rightValue<= ON_LINE && leftValue >= ON_LINE) {
-                state = LEFT;
-            }
-            else if(midValue >= ON_LINE && rightValue<= ON_LINE && leftValue >= ON_LINE) {
-                state = FAR_LEFT;
-            }
-            else if(midValue <= ON_LINE && rightValue>= ON_LINE && leftValue <= ON_LINE) {
-                state = RIGHT;
-            }
-            else if(midValue >= ON_LINE && rightValue>= ON_LINE && leftValue <= ON_LINE) {
-                state = FAR_RIGHT;
-            }
-            else {
-                state = OFF_LINE;
-            }
-            if(!(frontLeftBump.Value() && frontRightBump.Value()))
-            {
-                if(!frontRightBump.Value()) {
-                    LCD.WriteLine("right");
-                    left_motor.SetPercent(2 * speed);
-                    right_motor.SetPercent(-speed * .01);
-                }
-                else if(!frontLeftBump.Value()) {
-                    LCD.WriteLine("left");
-
-                    right_motor.SetPercent( 2 * speed);
-                    left_motor.SetPercent(-speed * .1);
-                }
-            }
-            else {
-                switch(state) {
-                    case CENTER:
-                        //LCD.WriteLine("CENTER");
-                        left_motor.SetPercent(speed);
-                        right_motor.SetPercent(speed);
-                        break;
-                    case LEFT:
-                   // LCD.WriteLine("LEFT");
-                        left_motor.SetPercent(speed);
-                        right_motor.SetPercent(.5 *speed);
-                        break;
-                    case FAR_LEFT:
-                   //LCD.WriteLine("FAR LEFT");
-                        left_motor.SetPercent(speed);
-                        right_motor.SetPercent(.25*speed);
-                        break;
-                    case RIGHT:
-                   // LCD.WriteLine("RIGHT");
-                        left_motor.SetPercent(0.5*speed);
-                        right_motor.SetPercent(speed);
-                        break;
-                    case FAR_RIGHT:
-                    //LCD.WriteLine("FAR RIGHT");
-                        left_motor.SetPercent(.25*speed);
-                        right_motor.SetPercent(speed);
-                        break;
-                    case OFF_LINE:
-                    //LCD.WriteLine("OFFLINE");
-                        left_motor.SetPercent(speed);
-                        right_motor.SetPercent(speed);
-                        break;
-
-            }
-        }
-        }
-        right_motor.Stop();
-        left_motor.Stop();
-
-}
-
-void followLineYellow(float speed, float distance) {
-        int leftValue, rightValue, midValue, state;
-        float counts = distance * COUNTS_PER_INCH;
-        right_encoder.ResetCounts();
-        left_encoder.ResetCounts();
-        int start_time = TimeNow();
-        while((left_encoder.Counts() + right_encoder.Counts()) / 2. < counts && (TimeNow() - start_time < 5) && (frontLeftBump.Value() && frontRightBump.Value()))
-        {
-            leftValue = left.Value();
-            rightValue = right.Value();
-            midValue = middle.Value();
-
-
-            if(midValue <= ON_LINE && rightValue >= ON_LINE && leftValue>= ON_LINE) {
-                state = CENTER;
-            }
-            else if(midValue <= ON_LINE && rightValue<= ON_LINE && leftValue >= ON_LINE) {
-                state = LEFT;
-            }
-            else if(midValue >= ON_LINE && rightValue<= ON_LINE && leftValue >= ON_LINE) {
-                state = FAR_LEFT;
-            }
-            else if(midValue <= ON_LINE && rightValue>= ON_LINE && leftValue <= ON_LINE) {
-                state = RIGHT;
-            }
-            else if(midValue >= ON_LINE && rightValue>= ON_LINE && leftValue <= ON_LINE) {
-                state = FAR_RIGHT;
-            }
-            else {
-                state = OFF_LINE;
-            }
-
-            switch(state) {
-                case CENTER:
-                    //LCD.WriteLine("CENTER");
-                    left_motor.SetPercent(speed);
-                    right_motor.SetPercent(speed);
-                    break;
-                case LEFT:
-               // LCD.WriteLine("LEFT");
-                    left_motor.SetPercent(speed);
-                    right_motor.SetPercent(.5 *speed);
-                    break;
-                case FAR_LEFT:
-               //LCD.WriteLine("FAR LEFT");
-                    left_motor.SetPercent(speed);
-                    right_motor.SetPercent(.25*speed);
-                    break;
-                case RIGHT:
-               // LCD.WriteLine("RIGHT");
-                    left_motor.SetPercent(0.5*speed);
-                    right_motor.SetPercent(speed);
-                    break;
-                case FAR_RIGHT:
-                //LCD.WriteLine("FAR RIGHT");
-                    left_motor.SetPercent(.25*speed);
-                    right_motor.SetPercent(speed);
-                    break;
-                case OFF_LINE:
-                //LCD.WriteLine("OFFLINE");
-                    left_motor.SetPercent(speed);
-                    right_motor.SetPercent(speed);
-                    break;
-
-
-            }
-            if(!frontRightBump.Value()) {
-                left_motor.SetPercent(speed);
-                right_motor.SetPercent(-15);
-            }
-            else if(!frontLeftBump.Value()) {
-                right_motor.SetPercent(speed);
-                left_motor.SetPercent(-15);
-            }
-        }
-}
-
-/** turn_left
-    Turns the robot to the left for a certain amount of degrees
-    @param percent Motor percent
-    @param degrees Amount for robot to turn
-*/
-void turn_left(int percent, float degrees) //using encoders
-{
-    //Reset encoder counts
-    right_encoder.ResetCounts();
-    left_encoder.ResetCounts();
-    float counts = degrees * LEFT_COUNTS_PER_DEGREE;
-    right_motor.SetPercent(percent);
-    left_motor.SetPercent(-1 * percent);
-    int mp = percent;
-    while((right_encoder.Counts() + left_encoder.Counts())/2. < counts);
-
-    //Turn off motors
-    right_motor.Stop();
-    left_motor.Stop();
-}
-
-/** turn_right
-    Turns the robot to the right for a certain amount of degrees
-    @param percent Motor percent
-    @param degrees Amount for robot to turn
-*/
-void turn_right(int percent, float degrees) //using encoders
-{
-    //Reset encoder counts
-    right_encoder.ResetCounts();
-    left_encoder.ResetCounts();
-    float counts = degrees * RIGHT_COUNTS_PER_DEGREE;
-    right_motor.SetPercent(-1 * percent);
-    left_motor.SetPercent(percent);
-    while((right_encoder.Counts() + left_encoder.Counts())/2. < counts);
-
-    //Turn off motors
-    right_motor.Stop();
-    left_motor.Stop();
-}
-/** angleBetween
-    Gets the smaller angle between two unit vectors
-    @param degree1 Degree of first vector
-    @param degree2 Degree of second vector
-    @return The angle between the two vectors (angle < 180)
-*/
-float angleBetween(float degree1, float degree2) {
-    float vect1x = cos(degree1 * M_PI/180);
-    float vect1y = sin(degree1 * M_PI/180);
-    float vect2x = cos(degree2 * M_PI/180);
-    float vect2y = sin(degree2 * M_PI/180);
-    //get dot product of vectors
-    float dot = vect1x*vect2x + vect1y*vect2y;
-    //use dot product definition to get angle between
-    return acos(dot) * 180/M_PI;
-}
-
-
-/** faceDegree
-    Uses RPS to face the robot to a certain degree
-    @param degree Degree robot should face
-*/
-void faceDegree(float degree) {
-
-    float headingToZero = 0;
-    float degreeToZero = degree - RPS.Heading();
-    if(degreeToZero < 0) {
-        degreeToZero+=360;
-    }
-    float deltaTheta = angleBetween(headingToZero, degreeToZero);
-    float timeStarted = TimeNow();
-    while(deltaTheta > 0.8 && TimeNow() - timeStarted < 5) {
-        if(RPS.Heading() >= 0)  {
-            headingToZero = 0;
-            degreeToZero = degree-RPS.Heading();
-            if(degreeToZero < 0) {
-                degreeToZero+=360;
-            }
-            deltaTheta = angleBetween(headingToZero, degreeToZero);
-            if(degreeToZero > 180) {
-                    turn_right(15,0.1);
-                   Sleep(50);
-
-            }
-            else {
-                    turn_left(15,0.1);
-                   Sleep(50);
-                }
-            }
-        }
-
-
-
- }
-float distanceTo(float x, float y) {
-    while(RPS.X() < 0);
-    return sqrt((x - RPS.X()) * (x - RPS.X()) + (y - RPS.Y()) * (y - RPS.Y()));
-}
-
-/** check_x_plus
-    Moves the robot to a certain x coordinate while it is facing the positive x direction
-    @param x_coordinate The coordinate the robot should go
-*/
-
-bool check_x_plus(float x_coordinate) //using RPS while robot is in the +x direction
-{
-    bool condition = true;
-    //check whether the robot is within an acceptable range
-    while((RPS.X() < x_coordinate - 1 || RPS.X() > x_coordinate + 1) && (frontLeftBump.Value() || frontRightBump.Value()))
-    {
-        LCD.WriteLine(frontLeftBump.Value());
-        LCD.WriteLine(frontRightBump.Value());
-
-        if(RPS.X() > x_coordinate)
-        {
-            move_backwards(20,0.1);
-        }
-        else if(RPS.X() < x_coordinate)
-        {
-            //pulse the motos for a short duration in the correct direction
-            move_forward(20,0.1);
-        }
-
-        Sleep(50);
-    }
-    return condition;
-}
-/** check_x_minus
-    Moves the robot to a certain x coordinate while it is facing the negative x direction
-    @param x_coordinate The coordinate the robot should go
-*/
-
-bool check_x_minus(float x_coordinate) //using RPS while robot is in the +x direction
-{
-    bool condition = true;
-    //check whether the robot is within an acceptable range
-    float startingDegree = RPS.Heading();
-    while(RPS.X() < x_coordinate - 1 || RPS.X() > x_coordinate + 1)
-    {
-       if(RPS.X() > x_coordinate)
-        {
-            move_forward_timed(20,0.1,1);
-        }
-        else if(RPS.X() < x_coordinate)
-        {
-            //pulse the motors for a short duration in the correct direction
-            move_backwards(20,0.1);
-        }
-
-
-    }
-
-    return condition;
-}
-/** check_y_minus
-    Moves the robot to a certain y coordinate while it is facing the negative y direction
-    @param y_coordinate The coordinate the robot should go
-*/
-
-bool check_y_minus(float y_coordinate) //using RPS while robot is in the -y direction
-{
-    bool condition = true;
-    //check whether the robot is within an acceptable range
-    float startingDegree = RPS.Heading();
-    while(RPS.Y() < y_coordinate - 0.5 || RPS.Y() > y_coordinate + 0.5)
-    {
-        if(RPS.Y() > y_coordinate)
-        {
-            move_forward_timed(20,0.1, 1);
-        }
-        else if(RPS.Y() < y_coordinate)
-        {
-            //pulse the motors for a short duration in the correct direction
-
-            move_backwards(20,0.1);
-        }
-        Sleep(50);
-
-    }
-    return condition;
-}
-bool on_line() {
-    float leftValue = left.Value();
-    float rightValue = right.Value();
-   float midValue = middle.Value();
-    return (midValue >= ON_LINE && rightValue >= ON_LINE && leftValue>= ON_LINE);
-}
-
-/** check_y_plus
-    Moves the robot to a certain y coordinate while it is facing the positive y direction
-    @param y_coordinate The coordinate the robot should go
-*/
-bool check_y_plus(float y_coordinate) //using RPS while robot is in the +y direction
-{
-    bool condition = true;
-    //check whether the robot is within an acceptable range
-    float startingDegree = RPS.Heading();
-    while(RPS.Y() < y_coordinate - 1 || RPS.Y() > y_coordinate + 1)
-    {
-        if(RPS.Y() > y_coordinate)
-        {
-            move_backwards(20,0.1);
-        }
-        else if(RPS.Y() < y_coordinate)
-        {
-            //pulse the motors for a short duration in the correct direction
-
-            move_forward(20,0.1);
-        }
-
-    }
-    return condition;
-}
-float locationDegree(float x, float y, int quadrant) {
-    float delY = y - RPS.Y();
-    float delX = x - RPS.X();
-    float angle;
-    if(quadrant == 1) {
-        angle = atan(delY/delX) * 180 / M_PI;
-    }
-    else if(quadrant == 2) {
-        angle = atan(delY/delX) * 180/M_PI;
-        angle += 180;
-    }
-    else if(quadrant == 3) {
-        angle = atan(delY/delX) * 180/M_PI;
-        angle += 180;
-    }
-    else {
-        angle = atan(delY/delX) * 180/M_PI;
-        angle += 360;
-    }
-    return angle;
-}
-
-void faceLocation(float x, float y, int quadrant) {
-    float angle = locationDegree(x, y, quadrant);
-    float currentHeading = RPS.Heading();
-    float deltaTheta = angleBetween(currentHeading, angle);
-    float tempAngle = angle - currentHeading;
-    if(tempAngle < 0) {
-        tempAngle += 360;
-    }
-    if(tempAngle > 180) {
-        turn_right(30, deltaTheta);
-    }
-    else {
-        turn_left(30, deltaTheta);
-    }
-    LCD.WriteLine("Facing: ");
-    LCD.Write(angle);
-    faceDegree(angle);
-
-}
-
-void faceLocationBack(float x, float y, int quadrant) {
-    float angle = locationDegree(x, y, quadrant);
-    angle -= 180;
-    if(angle < 0) {
-        angle += 360;
-    }
-    LCD.WriteLine("Current Heading: ");
-    float currentHeading = RPS.Heading();
-    LCD.WriteLine(currentHeading);
-    while(currentHeading < 0) {
-        currentHeading = RPS.Heading();
-    }
-
-    float deltaTheta = angleBetween(currentHeading, angle);
-    LCD.WriteLine("delta theta: ");
-    LCD.WriteLine(deltaTheta);
-    float tempAngle = angle - currentHeading;
-    if(tempAngle < 0) {
-        tempAngle += 360;
-    }
-    if(tempAngle > 180) {
-        turn_right(30, deltaTheta);
-    }
-    else {
-        turn_left(30, deltaTheta);
-    }
-    LCD.WriteLine("Facing: ");
-    LCD.Write(angle);
-
-}
-void moveToForwards(float x, float y) {
-    int quad;
-    LCD.WriteLine(RPS.X());
-    LCD.WriteLine(RPS.Y());
-    float delY = y - RPS.Y();
-    float delX = x - RPS.X();
-    if(delX > 0) {
-        if(delY >= 0) {
-            quad = 1;
-        }
-        else {
-            quad = 4;
-        }
-    }
-    else {
-        if(delY >= 0) {
-            quad = 2;
-        }
-        else {
-            quad = 3;
-        }
-    }
-    faceLocation(x, y, quad);
-    LCD.WriteLine(distanceTo(x,y));
-    move_forward(45, distanceTo(x, y));
-
-
-}
-void moveToBackwards(float x, float y) {
-    int quad;
-    float delY = y - RPS.Y();
-    float delX = x - RPS.X();
-    if(delX > 0) {
-        if(delY >= 0) {
-            quad = 1;
-        }
-        else {
-            quad = 4;
-        }
-    }
-    else {
-        if(delY >= 0) {
-            quad = 2;
-        }
-        else {
-            quad = 3;
-        }
-    }
-    faceLocationBack(x, y, quad);
-    move_backwards_timed(SPEED, distanceTo(x, y), 5);
-}
-/** moveTo
-    Moves the robot to a certain coordinate.
-    @param x The x coordinate the robot should go to
-    @param y The y coordinate the robot should go to
-*/
-void moveTo(float x, float y) {
-    float robotX = RPS.X();
-    float robotY = RPS.Y();
-    double deltaX = x - robotX;
-    double deltaY = y - robotY;
-    faceDegree(0);
-    move_forward(SPEED , distanceTo(x, RPS.Y()));
-    turn_right(20, 90);
-    faceDegree(270);
-    move_forward(35, distanceTo(RPS.X(), y));
-}
-/** waitForStart
-    Initializes menu, waits for start light to go on.
-*/
-void waitForStart() {
-    RPS.InitializeTouchMenu();
-    LCD.Clear();
-    setRPSCoords();
-    while(cds2.Value() > 0.8);
-}
-/** getLightColor
-    Returns the color of the fuel light.
-    @return 1 if light is blue, 2 if light is red
-*/
-int getLightColor() {
-    LCD.WriteLine(cds1.Value());
-    if(cds1.Value() < BLUE_LIGHT_ON) {
-        return 0;
-    }
-    else {
-        return 1;
-    }
-}
-/** detectingLight
-    Finds out whether the robot is detecting a light or not
-    @return true if robot is detecting light, false otherwise
-*/
-bool detectingLight(int cell) {
-    if(cell == 1) {
-        if(RPS.CurrentCourse() == 'a' || RPS.CurrentCourse() == 'A') {
-            return cds1.Value() < 1.1;
-        }
-        else {
-            return cds1.Value() < 1.1;
-        }
-
-
-    }
-    else {
-        return cds2.Value() < 0.8;
-    }
-}
-
-
-/** setServo
-    Sets the servo thresholds.
-*/
-void setServo() {
-    arm.SetMin(884);
-    arm.SetMax(2235);
-}
-void moveArm(float currentDegree, float nextDegree) {
-    if(currentDegree < nextDegree) {
-        while(currentDegree < nextDegree) {
-            arm.SetDegree(currentDegree);
-            currentDegree++;
-            Sleep(5);
-        }
-    }
-    else {
-        while(currentDegree > nextDegree) {
-            arm.SetDegree(currentDegree);
-            currentDegree--;
-            Sleep( 5);
-        }
-    }
-}
-
-/** pullSwitch
-    pulls a switch in front of the robot
-*/
-void pullSwitch(int s) {
-    if(s == 2) {
-        move_backwards(SPEED, 1.5);
-        moveArm(100, 35);
-
-        move_backwards_timed(SPEED, 2, 1);
-        //move_forward(20, 1);
-         moveArm(35, 100);
-
-    }
-    else {
-        move_forward_timed(SPEED, 1, 1);
-         moveArm(100, 35);
-
-        move_backwards_timed(SPEED, 2.5, 1);
-        move_forward(SPEED, 0.5);
-         moveArm(35, 100);
-    }
-
-
-
-}
-/** pushSwitch
-    pushes a switch in front of the robot
-*/
-void pushSwitch(int s) {
-    if(s == 2) {
-        move_backwards(30, 4);
-         moveArm(100, 35);
-
-        move_forward_timed(30, 3, .25);
-         moveArm(35, 100);
-    }
-    else {
-        move_backwards(30 , 2.5);
-        moveArm(100, 35);
-        move_forward_timed(30, 3, .25 );
-        moveArm(35, 100);
-    }
-}
-/** goUpSideRamp
-    Assuming robot is facing ramp, moves up the side ramp, stopping when robot is completely on top level.
-*/
-void goUpSideRamp() {
-    move_forward_timed(50, 5, 100);
-    followLine(50, 7);
-    driveToWall(30);
-    move_backwards(50, 0.25);
-    turn_left(30, 90);
-    followLine(50, 30);
-    driveToWall(30);
-    move_backwards(35,1);
-
-    turn_left(30, 90);
-    LCD.WriteLine("FORWARD");
-
-    move_forward_timed(SPEED, 15, 100);
-    LCD.WriteLine("STOP");
-    right_motor.Stop();
-    left_motor.Stop();
-}
-/** flipSwitches
-    Flips all 3 switches to their correct orientation
-    @param red The direction for the red switch to go
-    @param white The direction for the white switch to go
-    @param blue The direction for the blue switch to go
-*/
-void flipSwitches(int red, int white, int blue) {
-    //Starting at middle switch
-    followLineYellowSquare(SPEED, 3);
-    if(white == 1) {
-        pushSwitch(2);
-    }
-    else {
-        pullSwitch(2);
-    }
-    driveToWall(SPEED);
-    move_forward_timed(30, 1, 0.5);
-    move_backwards(30, 1);
-    turn_right(30, 25);
-    move_forward(30, 1);
-    if(red == 1) {
-        pushSwitch(1);
-    }
-    else {
-        pullSwitch(1);
-    }
-    move_backwards(30, 0.5);
-   turn_left(30, 20);
-   driveToWall(SPEED);
-   move_forward_timed(30, 1, 0.5);
-   move_backwards(30, 1);
-    turn_left(30, 25);
-    //faceDegree(300);
-    move_forward(30, 1);
-    if(blue == 1) {
-        pushSwitch(3);
-    }
-    else {
-        pullSwitch(3);
-    }
-}
-/** completeSwitches
-    moves to switches and flips them
-*/
-void completeSwitches() {
-
-    flipSwitches(RPS.RedSwitchDirection(), RPS.WhiteSwitchDirection(), RPS.BlueSwitchDirection());
-}
-/** pushButton
-    pushes correct fuel button
-*/
-void pushButton(int correctButton) {
-
-    if(correctButton == 0) {
-        LCD.WriteLine("RED");
-        move_backwards(SPEED, 4.5);
-        moveArm(100, 33);
-        move_forward_timed(20, 3, 1.5);
-        move_forward_timed(5, 100, 5);
-        move_backwards_timed(30,3, 2);
-        arm.SetDegree(100);
-    }
-    else {
-        LCD.WriteLine("BLUE");
-        arm.SetDegree(120);
-        move_forward_timed(30, 100, 6);
-        move_backwards_timed(30, 3, 2);
-        move_backwards_timed(30, 3, 2);
-        arm.SetDegree(100);
-    }
-}
-void wiggle() {
-    turn_right(15, 5);
-    turn_left(15, 5);
-    turn_right(15, 5);
-    turn_left(15, 5);
-    turn_right(15, 5);
-    turn_left(15, 5);
-}
-void pickUpSupplies() {
-
-
-    moveArm(100, 15);
-    LCD.WriteLine("moving arm down");
-    moveArm(15, 100);
-    LCD.WriteLine("Moving arm up");
-}
-
-
-
-void dropSupplies() {
-    move_backwards(30, 1);
-    LCD.WriteLine("moving backwards");
-    moveArm(100, 25);
-    LCD.WriteLine("moving arm down");
-    move_backwards_timed(30, 5, 3);
-    LCD.WriteLine("moving backwards");
-    LCD.WriteLine("sleep");
-    arm.SetDegree(100);
-    LCD.WriteLine("arm up");
-
-    pivot_right( 33, 175);
-    followLineYellowSquare(20, 5);
-
-}
-
-/** findRPSPoints
-    Test program to get coordinates of important places on the course.
-*/
-void findRPSPoints() {
-    RPS.InitializeTouchMenu();
-    while(true) {
-        LCD.WriteLine(RPS.X());
-        LCD.WriteLine(RPS.Y());
-        LCD.WriteLine(RPS.Heading());
-        Sleep(100);
-        LCD.Clear();
-    }
-}
-void startToSupplies() {
-    setServo();
-    arm.SetDegree(100);
-    moveToForwards(SUPPLIES_X, SUPPLIES_Y + 1.8);
-    turn_right(30, angleBetween(RPS.Heading(), 270) - 1);
-    faceDegree(270);
-    check_y_minus(SUPPLIES_Y+1.2);
-
-
-    pickUpSupplies();
-}
-
-void suppliesToTop() {
-    while(RPS.X() < 0);
-    move_backwards(35, distanceTo(RPS.X(), Location::BOTTOM_SIDE_RAMP_Y + 0.5)) ;
-    turn_left(30,90);
-    goUpSideRamp();
-
-}
-bool inYLightPostition() {
-    if(RPS.Y() > 0) {
-        return RPS.Y() <= Location::FUEL_LIGHT_Y;
-    }
-    else return true;
-}
-
-void goToLight() {
-//    if(RPS.X() > 0) {
-//        LCD.WriteLine(RPS.X());
-//        LCD.WriteLine(distanceTo(RPS.X(), Location::FUEL_LIGHT_Y));
-//        followLineYellow(25, distanceTo(RPS.X(), Location::FUEL_LIGHT_Y) - 0.3);
-//    }
-    move_forward_timed(30, 5, 5);
-    double time = TimeNow();
-    while(!detectingLight(1) && TimeNow() - time < 1.5) {
-        followLineYellow(25, 0.1);
-    }
-
-    right_motor.Stop();
-    left_motor.Stop();
-
-    LCD.WriteLine(cds1.Value());
-    Sleep(250);
-
-    int correctButton = getLightColor();
-    lightColor = correctButton;
-    if(correctButton == 0) {
-        LCD.WriteLine("RED");
-    }
-    else {
-        LCD.WriteLine("BLUE");
-
-    }
-    pushButton(correctButton);
-}
-
-void doButtons() {
-    while(RPS.X() < 0);
-    //check_x_minus(Location::FUEL_LIGHT_X);
-    if(RPS.Heading() >= 0) {
-        turn_right(30, angleBetween(RPS.Heading(),91));
-    }
-    else {
-        turn_right(30, 85);
-    }
-    if(RPS.X()>Location::FUEL_LIGHT_X) {
-        check_x_minus(Location::FUEL_LIGHT_X);
-    }
-    faceDegree(91);
-
-    goToLight();
-
-
-
-
-}
-void dropOff() {
-    turn_right(30, 10);
-    move_backwards(30, 2);
-    if(RPS.Heading() < 0) {
-        move_backwards(30, 1);
-    }
-    if(RPS.Heading() < 0) {
-        move_backwards(30, 1);
-    }
-    while(RPS.Heading() < 0);
-    float angle = locationDegree(4.8, DROP_OFF_Y, 3);
-    angle -= 180;
-    if(lightColor != 0) {
-        moveToBackwards(DROP_OFF_X, DROP_OFF_Y -2);
-
-    }
-    else {
-        moveToBackwards(DROP_OFF_X, DROP_OFF_Y );
-
-    }
-    turn_left(35, angleBetween(angle, 90)+1);
-    LCD.WriteLine("FOLLOWING");
-    driveToWall(30);
-    LCD.WriteLine("DONE");
-    move_forward_timed(SPEED, 1, 0.75);
-
-    //followLineYellow(40, 10);
-    //drop package
-    dropSupplies();
-
-}
-
-void goHome() {
-    if(RPS.X() < 0) {
-        move_forward(30, 1);
-    }
-    if(RPS.X() < 0) {
-        move_forward(30, 1);
-    }
-
-    turn_left(30, angleBetween(RPS.Heading(), 0));
-    //faceDegree(0);
-    move_forward(SPEED, distanceTo(Location::TOP_MAIN_RAMP_X - 2, RPS.Y()));
-    //check_x_plus(Location::TOP_MAIN_RAMP_X-1);
-    turn_right(30, 93);
-   // faceDegree(270);
-
-    move_forward_timed(35, 16.5, 3);
-    Sleep(50);
-        turn_left(30, 100);
-        move_backwards(50, 17);
-        faceLocationBack(0, 0, 3);
-        move_backwards_timed(50, 100, 3);
-
-        move_forward(SPEED, 5);
-        faceLocationBack(0, 0, 3);
-        move_backwards(50, 10);
-
-}
-
-void goGoGo() {
-    startToSupplies();
-    suppliesToTop();
-    doButtons();
-    dropOff();
-    completeSwitches();
-    goHome();
-}
-
-
-void cdsCheck() {
-    while(true) {
-        LCD.WriteLine(cds1.Value());
-        Sleep(50);
-        LCD.Clear();
-    }
-}
-
-int main(void)
-{
-    setServo();
-    arm.SetDegree(100);
-    waitForStart();
-    START_X = RPS.X();
-    START_Y = RPS.Y();
-    goGoGo();
-
-
-
-
-
-
-
-
-    return 0;
-
-}
+//Including FEH libraries
+#include <FEHLCD.h>
+#include <FEHIO.h>
+#include <FEHUtility.h>
+#include <FEHMotor.h>
+#include <FEHRPS.h>
+#include <math.h>
+#include <assert.h>
+#include <FEHServo.h>
+#include "locations.h"
+#include "coursemap.h"
+#include "scheduler.h"
+#include "sensors.h"
+#include "logger.h"
+#include "profile.h"
+#include "geometry.h"
+#include "linefollower.h"
+#include "bench.h"
+#include "motor.h"
+#include "recorder.h"
+#include "odometry.h"
+#include "pursuit.h"
+#include "arm.h"
+#include "motion.h"
+#include "calibration.h"
+#include "gains.h"
+#include "sweep.h"
+#include "variant.h"
+#include "directdrive.h"
+//Which robot this program is built as (see variant.h), the competition robot unless a build picks another
+#ifndef ROBOT_VARIANT
+#define ROBOT_VARIANT CompetitionRobot
+#endif
+typedef ROBOT_VARIANT Variant;
+//Defining threshold for following lines
+#define ON_LINE 3
+//Optosensor readings and gains for proportional line tracking
+#define BLACK_LINE_VOLTS 3.3
+#define YELLOW_LINE_VOLTS 2.0
+#define COURSE_VOLTS 1.2
+#define LINE_TRACK_KP 0.8
+#define LINE_TRACK_KD 0.03
+#define LINE_TRACK_SPEED SWEEP_PARAM("LINE_TRACK_SPEED", 65)
+//Defining constants to convert counts to inches or degrees, used until a calibration run saves fitted ones
+#define COUNTS_PER_INCH 33.74
+#define LEFT_COUNTS_PER_DEGREE 1.955
+#define RIGHT_COUNTS_PER_DEGREE 1.88
+//Extra counts pivot_right needs on top of LEFT_COUNTS_PER_DEGREE, tuned by hand with the defaults above
+#define PIVOT_RIGHT_FUDGE 1.05
+//Define thresholds for line following/start light
+#define START_LIGHT_ON 1.5
+#define BLUE_LIGHT_ON 0.75
+#define SPEED SWEEP_PARAM("SPEED", 40)
+#define MAX_SPEED 45
+//Profiled straight moves (inches and seconds)
+#define PROFILE_MAX_VELOCITY SWEEP_PARAM("PROFILE_MAX_VELOCITY", 18)
+#define PROFILE_ACCELERATION SWEEP_PARAM("PROFILE_ACCELERATION", 30)
+#define PROFILE_TOLERANCE 0.25
+#define PROFILE_SETTLE_TIME 0.5
+//Feed-forward: motor percent per inch/second and per inch/second^2
+#define PROFILE_KV 2.6
+#define PROFILE_KA 0.25
+//PI on position error (in counts)
+#define PROFILE_KP 0.2
+#define PROFILE_KI 0.002
+//Heading controller (degrees and seconds)
+#define HEADING_KP 1.2
+#define HEADING_KD 0.06
+#define HEADING_MIN_PERCENT 12
+#define HEADING_MAX_PERCENT SWEEP_PARAM("HEADING_MAX_PERCENT", 35)
+#define HEADING_TOLERANCE 0.8
+#define HEADING_SETTLE_TIME 0.1
+#define HEADING_TIMEOUT 5
+//Heading the robot is set down facing in the start box
+#define START_HEADING 45
+//Longest driveToWall keeps pushing for a wall (in seconds)
+#define WALL_TIMEOUT 3.0
+//Longest the check_* functions keep stepping towards an RPS coordinate (in seconds)
+#define RPS_CHECK_TIMEOUT 4.0
+//Calibration run: each leg is driven there and back this many times, somewhere RPS can see the robot
+#define CALIBRATION_REPEATS 3
+#define CALIBRATION_DISTANCE 12
+#define CALIBRATION_DEGREES 90
+#define CALIBRATION_TURN_PERCENT 25
+//RPS readings averaged for each measurement and the time between them (in seconds)
+#define CALIBRATION_SAMPLES 5
+#define CALIBRATION_SAMPLE_PERIOD 0.1
+//Time for the robot to stop coasting before the first reading, on top of RPS_LATENCY (in seconds)
+#define CALIBRATION_SETTLE_TIME 0.4
+
+//Distance between the wheels (in inches), from how far each wheel rolls per degree the robot turns
+#define TRACK_WIDTH ((calibration.leftCountsPerDegree + calibration.rightCountsPerDegree) * 180 / M_PI / calibration.countsPerInch)
+//How far ahead along the path the robot steers towards (in inches)
+#define PURSUIT_LOOKAHEAD SWEEP_PARAM("PURSUIT_LOOKAHEAD", 4)
+#define PURSUIT_SPEED SWEEP_PARAM("PURSUIT_SPEED", 45)
+//Speed the robot slows to over the last PURSUIT_SLOW_DISTANCE inches of a path
+#define PURSUIT_MIN_PERCENT 15
+#define PURSUIT_SLOW_DISTANCE 5
+#define PURSUIT_TOLERANCE 0.5
+//Time allowed on top of driving the whole path at PURSUIT_MIN_PERCENT (in seconds)
+#define PURSUIT_TIMEOUT_MARGIN 2
+//Lowest the robot can be on the fuel line and still back over the top of the alcove wall (in inches)
+#define ALCOVE_TOP_CLEAR_Y 55.5
+//Speed the robot climbs the side ramp at
+#define SIDE_RAMP_PERCENT SWEEP_PARAM("SIDE_RAMP_PERCENT", Variant::SIDE_RAMP_PERCENT)
+//How far past the bottom of the side ramp the robot backs up to before turning onto it (in inches)
+#define SIDE_RAMP_OFFSET SWEEP_PARAM("SIDE_RAMP_OFFSET", 0.5)
+//Turn off the drop off back towards the line, after the supplies are left
+#define DROP_PIVOT_PERCENT SWEEP_PARAM("DROP_PIVOT_PERCENT", 33)
+#define DROP_PIVOT_DEGREES SWEEP_PARAM("DROP_PIVOT_DEGREES", Variant::DROP_PIVOT_DEGREES)
+//Drive from the alcove exit down to the start area (in inches)
+#define HOME_DASH_PERCENT SWEEP_PARAM("HOME_DASH_PERCENT", 35)
+#define HOME_DASH_DISTANCE SWEEP_PARAM("HOME_DASH_DISTANCE", 16.5)
+
+//Declarations for encoders & motors
+ButtonBoard buttons(FEHIO::Bank3);
+DigitalEncoder right_encoder(FEHIO::P0_1);
+DigitalEncoder left_encoder(FEHIO::P0_0);
+DriveMotor right_motor(FEHMotor::Motor2,12.0);
+DriveMotor left_motor(FEHMotor::Motor3,12.0);
+FEHServo arm(FEHServo::Servo0);
+//Sweeps the arm in the background so it can move while the robot drives
+ArmController armController(arm);
+
+AnalogInputPin right(FEHIO::P1_2);
+AnalogInputPin middle(FEHIO::P1_4);
+AnalogInputPin left(FEHIO::P1_6);
+AnalogInputPin cds1(FEHIO::P3_0);
+AnalogInputPin cds2(FEHIO::P3_1);
+
+
+DigitalInputPin frontLeftBump(FEHIO::P2_0);
+DigitalInputPin frontRightBump(FEHIO::P2_1);
+
+ControlLoop controlLoop;
+SensorBank sensors(left_encoder, right_encoder, frontLeftBump, frontRightBump, left, middle, right, cds1, cds2);
+//Sensor readings for the current control tick
+const SensorFrame &frame = sensors.frame();
+//Hard-coded counts per inch and per degree, which calibration runs are checked against
+const OdometryConstants DEFAULT_CALIBRATION = {COUNTS_PER_INCH, LEFT_COUNTS_PER_DEGREE, RIGHT_COUNTS_PER_DEGREE};
+//Counts per inch and per degree, loaded from the SD card at startup if the robot has been calibrated
+OdometryConstants calibration = DEFAULT_CALIBRATION;
+//Whether calibration holds fitted constants, so the angles tuned to make up for the defaults aren't needed
+bool calibrated = false;
+PoseEstimator odometry(sensors, left_motor, right_motor, COUNTS_PER_INCH, LEFT_COUNTS_PER_DEGREE, RIGHT_COUNTS_PER_DEGREE);
+FlightRecorder recorder(sensors, left_motor, right_motor);
+Logger logger;
+//Phase and primitive timing, only filled in when built with BENCHMARK
+Bench bench;
+
+//Drive-straight gains for each speed, loaded from the SD card at startup if the robot has been tuned
+GainSchedule driveGains(DEFAULT_DRIVE_GAINS, DEFAULT_DRIVE_GAIN_COUNT);
+
+//Waypoints, moved to where RPS puts the start, supplies and drop off on this course
+CourseMap courseMap;
+int lightColor;
+//Shortest time between two debug messages from the same place in a drive loop (in seconds)
+#define LOOP_LOG_INTERVAL 0.5
+void bumpValues() {
+    LOG_DEBUG_EVERY(LOOP_LOG_INTERVAL, "Left bump: ", (int)frame.leftBump);
+    LOG_DEBUG_EVERY(LOOP_LOG_INTERVAL, "Right bump: ", (int)frame.rightBump);
+}
+void setRPSCoords() {
+    LCD.WriteLine("SUPPLIES");
+    float x, y;
+    while(!LCD.Touch(&x, &y)) {
+        LCD.WriteLine(RPS.X());
+        LCD.WriteLine(RPS.Y());
+        LCD.DrawRectangle(289, 219, 30, 20);
+        Sleep(50);
+        LCD.Clear();
+    }
+    if(x > 289 && y > 219) {
+        return;
+    }
+    //Keep the map's position if RPS dropped out just as the screen was touched
+    if(RPS.X() >= 0) {
+        courseMap.locate(ANCHOR_SUPPLIES, RPS.X(), RPS.Y());
+    }
+    LCD.Clear();
+    LCD.WriteLine("DROP OFF");
+    Sleep(1.0);
+    while(!LCD.Touch(&x, &y)) {
+        LCD.WriteLine(RPS.X());
+        LCD.WriteLine(RPS.Y());
+        LCD.DrawRectangle(289, 219, 30, 20);
+        Sleep(50);
+        LCD.Clear();
+    }
+    if(x > 289 && y > 219) {
+        courseMap.forget(ANCHOR_SUPPLIES);
+        return;
+    }
+    //Only the x is used, the robot finds the drop off's y by driving into the wall
+    if(RPS.X() >= 0) {
+        courseMap.locate(ANCHOR_DROP_OFF, RPS.X(), Location::DROP_OFF_Y);
+    }
+}
+
+
+
+/** currentPose
+    Brings the pose estimate up to date, without waiting for RPS
+    @return Best guess of where the robot is
+*/
+const Pose &currentPose() {
+    sensors.capture(TimeNow());
+    odometry.estimate(frame.time);
+    return odometry.pose();
+}
+
+/** resetEncoders
+    Zeroes the encoder counts, counting whatever the wheels turned since the last tick into the pose first
+*/
+void resetEncoders() {
+    currentPose();
+    right_encoder.ResetCounts();
+    left_encoder.ResetCounts();
+    odometry.countsReset();
+}
+
+/** motionTimeout
+    Picks the deadline for a primitive
+    @param inches Distance the wheels have to roll
+    @param percent Motor percent
+    @param timeout Deadline the caller asked for, or MOTION_AUTO_TIMEOUT to pick one from the distance
+    @return Time the primitive is allowed (in seconds)
+*/
+float motionTimeout(float inches, float percent, float timeout) {
+    if(timeout != MOTION_AUTO_TIMEOUT) {
+        return timeout;
+    }
+    if(percent == 0) {
+        return MOTION_TIMEOUT_MARGIN;
+    }
+    return fabs(inches) * PROFILE_KV / fabs(percent) * MOTION_TIMEOUT_FACTOR + MOTION_TIMEOUT_MARGIN;
+}
+
+/** inchesTraveled
+    @return How far the wheels have rolled since the encoders were last reset, on average
+*/
+float inchesTraveled() {
+    return (frame.leftCounts + frame.rightCounts) / 2. / calibration.countsPerInch;
+}
+
+/** move_forward
+    Moves the robot forward
+    @param percent Motor percent
+    @param inches Distance robot needs to travel
+    @param timeout Time allowed (in seconds), picked from the distance by default
+    @return How the move ended
+*/
+MotionResult move_forward(int percent, float inches, float timeout = MOTION_AUTO_TIMEOUT) //using encoders
+{
+    BENCH_PRIMITIVE();
+    //Reset encoder counts
+    resetEncoders();
+    float counts = inches*calibration.countsPerInch;
+    //Set both motors to desired percent
+    right_motor.SetPercent(percent);
+    Sleep(1);
+    left_motor.SetPercent(percent);
+    int mp = percent;
+    DriveGains gains = driveGains.lookup(percent);
+    double accum_error = 0;
+
+    //While the average of the left and right encoder are less than counts,
+    //keep running motors
+    MotionWatch watch(frame, motionTimeout(inches, percent, timeout));
+    watch.watchStalls();
+    sensors.setChannels(SENSE_ENCODERS | SENSE_BUMPS);
+    controlLoop.run([&](double now) {
+        if(!((frame.leftCounts + frame.rightCounts) / 2. < counts && (frame.leftBump && frame.rightBump))) {
+            return false;
+        }
+        if(!watch.check(now)) {
+            return false;
+        }
+        double current_error = (frame.leftCounts-frame.rightCounts);
+        accum_error +=current_error;
+        mp = gains.kp*current_error+gains.ki*accum_error+(percent);
+        right_motor.SetPercent(mp);
+        bumpValues();
+        return true;
+    });
+    if(!(frame.leftBump && frame.rightBump)) {
+        watch.bumped();
+    }
+    float remaining = inches - inchesTraveled();
+
+    right_motor.SetPercent(-20);
+    left_motor.SetPercent(-20);
+    //Brake under the control loop, so the motors ramp through zero instead of reversing in one step
+    double braking = TimeNow();
+    controlLoop.run([&](double now) {
+        return now - braking < 0.1;
+    });
+    //Turn off motors
+    right_motor.Stop();
+    left_motor.Stop();
+    return watch.finish(remaining <= 0, remaining);
+}
+
+/** move_forward_timed
+    Moves the robot forward, stopping when a certain time is reached or a distance is met
+    @param percent Motor percent
+    @param inches Distance robot needs to travel
+    @param time Time robot should be moving (in seconds)
+    @return How the move ended, timed out if the time ran out before the distance was covered
+*/
+MotionResult move_forward_timed(int percent, float inches, double time) //using encoders
+{
+    BENCH_PRIMITIVE();
+    //Reset encoder counts
+    resetEncoders();
+    float counts = inches*calibration.countsPerInch;
+    //Set both motors to desired percent
+    right_motor.SetPercent(percent);
+    left_motor.SetPercent(percent);
+
+    //While the average of the left and right encoder are less than counts,
+    //keep running motors
+    //The time is how long to keep pushing, so a stall against a wall is expected and not watched for
+    MotionWatch watch(frame, time);
+    watch.expectTimeout();
+    sensors.setChannels(SENSE_ENCODERS | SENSE_BUMPS);
+    controlLoop.run([&](double now) {
+//        double current_error = (frame.leftCounts-frame.rightCounts);
+//        accum_error +=current_error;
+//        mp = gains.kp*current_error+gains.ki*accum_error+(percent);
+//        right_motor.SetPercent(mp);
+//        bumpValues();
+        return (frame.leftCounts + frame.rightCounts) / 2. < counts && watch.check(now) && (frame.leftBump && frame.rightBump);
+    });
+    if(!(frame.leftBump && frame.rightBump)) {
+        watch.bumped();
+    }
+    float remaining = inches - inchesTraveled();
+
+    //Turn off motors
+    right_motor.Stop();
+    left_motor.Stop();
+    return watch.finish(remaining <= 0, remaining);
+}
+/** pivot_right
+    Swings the robot to the right, mostly around its right wheel
+    @param percent Motor percent
+    @param degrees Amount for robot to turn
+    @param timeout Time allowed (in seconds), picked from the angle by default
+    @return How the turn ended, with the error in degrees
+*/
+MotionResult pivot_right(int percent, float degrees, float timeout = MOTION_AUTO_TIMEOUT) {
+    BENCH_PRIMITIVE();
+    //Reset encoder counts
+    resetEncoders();
+    float countsPerDegree = calibration.leftCountsPerDegree * (calibrated ? 1 : PIVOT_RIGHT_FUDGE);
+    float counts = degrees * countsPerDegree;
+    left_motor.SetPercent(percent);
+    right_motor.SetPercent((-percent) * 0.7);
+    MotionWatch watch(frame, motionTimeout(counts / calibration.countsPerInch, percent, timeout));
+    watch.watchStalls();
+    sensors.setChannels(SENSE_ENCODERS);
+    controlLoop.run([&](double now) {
+        return (frame.rightCounts + frame.leftCounts)/2. < counts && watch.check(now);
+    });
+    float remaining = (counts - (frame.rightCounts + frame.leftCounts) / 2.) / countsPerDegree;
+
+    //Turn off motors
+    right_motor.Stop();
+    left_motor.Stop();
+    return watch.finish(remaining <= 0, remaining);
+}
+
+/** move_backwards
+    Moves the robot backwards
+    @param percent Motor percent
+    @param inches Distance robot needs to travel
+    @param timeout Time allowed (in seconds), picked from the distance by default
+    @return How the move ended
+*/
+MotionResult move_backwards(int percent, double inches, float timeout = MOTION_AUTO_TIMEOUT) //using encoders
+{
+    BENCH_PRIMITIVE();
+    //Reset encoder counts
+    resetEncoders();
+    double counts = inches*calibration.countsPerInch;
+    //Set both motors to desired percent
+    right_motor.SetPercent(-1*percent);
+    left_motor.SetPercent(-1*percent);
+    int mp = percent;
+    DriveGains gains = driveGains.lookup(percent);
+    double accum_error = 0;
+    //While the average of the left and right encoder are less than counts,
+    //keep running motors
+    MotionWatch watch(frame, motionTimeout(inches, percent, timeout));
+    watch.watchStalls();
+    sensors.setChannels(SENSE_ENCODERS);
+    controlLoop.run([&](double now) {
+        if(!((frame.leftCounts + frame.rightCounts) / 2. < counts)) {
+            return false;
+        }
+        if(!watch.check(now)) {
+            return false;
+        }
+        double current_error = (frame.leftCounts-frame.rightCounts);
+        accum_error +=current_error;
+        mp = gains.kp*current_error+gains.ki*accum_error+(percent);
+        mp *= -1;
+        right_motor.SetPercent(mp);
+        return true;
+    });
+    float remaining = inches - inchesTraveled();
+
+    //Turn off motors
+    right_motor.Stop();
+    left_motor.Stop();
+    return watch.finish(remaining <= 0, remaining);
+}
+/** move_backwards_timed
+    Moves the robot backwards, stopping when a certain time is reached or a distance is met
+    @param percent Motor percent
+    @param inches Distance robot needs to travel
+    @param time Time robot should be moving (in seconds)
+    @return How the move ended, timed out if the time ran out before the distance was covered
+*/
+MotionResult move_backwards_timed(int percent, float inches, float time) //using encoders
+{
+    BENCH_PRIMITIVE();
+    //Reset encoder counts
+    resetEncoders();
+    float counts = inches*calibration.countsPerInch;
+    //Set both motors to desired percent
+    right_motor.SetPercent(-1 * percent);
+    left_motor.SetPercent(-1 * percent);
+
+    //While the average of the left and right encoder are less than counts,
+    //keep running motors
+    MotionWatch watch(frame, time);
+    watch.expectTimeout();
+    sensors.setChannels(SENSE_ENCODERS);
+    controlLoop.run([&](double now) {
+        return (frame.leftCounts + frame.rightCounts) / 2. < counts && watch.check(now);
+    });
+    float remaining = inches - inchesTraveled();
+
+
+    //Turn off motors
+    right_motor.Stop();
+    left_motor.Stop();
+    return watch.finish(remaining <= 0, remaining);
+}
+
+/** move_profiled
+    Moves the robot straight following a trapezoidal velocity profile, tracking the planned position
+    against the encoders with feed-forward plus PI, so it speeds up and slows down smoothly
+    @param inches Distance robot needs to travel (negative to move backwards)
+    @param maxVelocity Fastest the robot should go (in inches per second)
+    @param acceleration Rate used to speed up and slow down (in inches per second squared)
+    @return How the move ended
+*/
+MotionResult move_profiled(float inches, float maxVelocity = PROFILE_MAX_VELOCITY, float acceleration = PROFILE_ACCELERATION)
+{
+    BENCH_PRIMITIVE();
+    int direction = inches < 0 ? -1 : 1;
+    TrapezoidProfile profile(fabs(inches), maxVelocity, acceleration);
+    //Reset encoder counts
+    resetEncoders();
+    double position_accum = 0;
+    double heading_accum = 0;
+    double start_time = TimeNow();
+    bool arrived = false;
+    MotionWatch watch(frame, profile.getDuration() + PROFILE_SETTLE_TIME);
+    watch.watchStalls();
+    sensors.setChannels(direction > 0 ? SENSE_ENCODERS | SENSE_BUMPS : SENSE_ENCODERS);
+    controlLoop.run([&](double now) {
+        float t = now - start_time;
+        double traveled = (frame.leftCounts + frame.rightCounts) / 2.;
+        double position_error = profile.position(t) * calibration.countsPerInch - traveled;
+        //Stop once the profile is finished and the robot is close enough, or we ran into a wall
+        if(t >= profile.getDuration() && fabs(position_error) < PROFILE_TOLERANCE * calibration.countsPerInch) {
+            arrived = true;
+            return false;
+        }
+        if(direction > 0 && !(frame.leftBump && frame.rightBump)) {
+            watch.bumped();
+            return false;
+        }
+        //The robot barely moves before the profile gets going, so it only counts as stalled once it should be moving
+        if(!watch.check(now, t > 0 && profile.velocity(t) > 0)) {
+            return false;
+        }
+        position_accum += position_error;
+        float mp = PROFILE_KV * profile.velocity(t) + PROFILE_KA * profile.accelerationAt(t)
+                + PROFILE_KP * position_error + PROFILE_KI * position_accum;
+        if(mp > 100) {
+            mp = 100;
+        }
+        else if(mp < -100) {
+            mp = -100;
+        }
+        //Keep the wheels together the same way move_forward does, with the gains for the current speed
+        DriveGains gains = driveGains.lookup(mp);
+        double wheel_error = frame.leftCounts - frame.rightCounts;
+        heading_accum += wheel_error;
+        float heading_error = gains.kp * wheel_error + gains.ki * heading_accum;
+        left_motor.SetPercent(direction * mp);
+        right_motor.SetPercent(direction * (mp + heading_error));
+        return true;
+    });
+    float remaining = fabs(inches) - inchesTraveled();
+
+    //Turn off motors
+    right_motor.Stop();
+    left_motor.Stop();
+    return watch.finish(arrived, remaining);
+}
+
+/** driveToWall
+    Moves the robot forward, stopping when it hits a wall
+    @param percent Motor percent
+    @param timeout Time allowed to find the wall (in seconds)
+    @return How the move ended, completed once both bump switches are pressed
+*/
+MotionResult driveToWall(int percent, float timeout = WALL_TIMEOUT) {
+    BENCH_PRIMITIVE();
+    //Reset encoder counts, so the wheels are kept together from here rather than from the last move
+    resetEncoders();
+    right_motor.SetPercent(percent);
+    left_motor.SetPercent(percent);
+    int mp = percent;
+    DriveGains gains = driveGains.lookup(percent);
+    double accum_error = 0;
+    MotionWatch watch(frame, timeout);
+    watch.watchStalls();
+    //Running out of time with one switch pressed is as square as the robot gets against some walls
+    watch.expectTimeout();
+    sensors.setChannels(SENSE_ENCODERS | SENSE_BUMPS);
+    controlLoop.run([&](double now) {
+        if(!((frame.leftBump || frame.rightBump) && watch.check(now))) {
+            return false;
+        }
+        if(!frame.rightBump) {
+            left_motor.SetPercent(percent+ 10);
+            right_motor.SetPercent(Variant::wallBackoff(percent));
+        }
+        else if(!frame.leftBump) {
+            right_motor.SetPercent(percent+10);
+            left_motor.SetPercent(Variant::wallBackoff(percent));
+        }
+        else {
+            double current_error = (frame.leftCounts-frame.rightCounts);
+            accum_error +=current_error;
+            mp = gains.kp*current_error+gains.ki*accum_error+(percent);
+            right_motor.SetPercent(mp);
+        }
+        return true;
+    });
+    bool squared = !frame.leftBump && !frame.rightBump;
+    if(!frame.leftBump || !frame.rightBump) {
+        watch.bumped();
+    }
+    //Turn off motors
+    right_motor.Stop();
+    left_motor.Stop();
+    return watch.finish(squared, 0);
+}
+
+/** followLineWith
+    Makes the robot follow a line until it has gone far enough or a stop condition in the options is met.
+    @param speed Motor percent
+    @param distance Distance robot needs to travel
+    @param options Line color, timeout and bump switch behavior
+    @return How the move ended, completed once the distance is covered
+*/
+MotionResult followLineWith(float speed, float distance, const LineFollowOptions &options) {
+        LineFollower follower(options.color);
+        LineTracker tracker(options.color == YELLOW_LINE ? YELLOW_LINE_VOLTS : BLACK_LINE_VOLTS, COURSE_VOLTS,
+                            LINE_TRACK_KP, LINE_TRACK_KD);
+        float counts = distance * calibration.countsPerInch;
+        resetEncoders();
+        MotionWatch watch(frame, options.timeout);
+        watch.watchStalls();
+        sensors.setChannels(SENSE_ENCODERS | SENSE_BUMPS | SENSE_LINE);
+        controlLoop.run([&](double now) {
+            bool bumped = options.stopOnEitherBump ? !(frame.leftBump && frame.rightBump) : !(frame.leftBump || frame.rightBump);
+            if(bumped) {
+                watch.bumped();
+            }
+            if(!((frame.leftCounts + frame.rightCounts) / 2. < counts && !bumped && watch.check(now))) {
+                return false;
+            }
+            if(options.steerOnBump && !frame.rightBump) {
+                left_motor.SetPercent(options.bumpPush);
+                right_motor.SetPercent(options.bumpReverse);
+            }
+            else if(options.steerOnBump && !frame.leftBump) {
+                right_motor.SetPercent(options.bumpPush);
+                left_motor.SetPercent(options.bumpReverse);
+            }
+            else if(options.proportional) {
+                float correction = tracker.correction(frame.lineLeft, frame.lineMiddle, frame.lineRight, now);
+                if(tracker.isLost()) {
+                    BENCH_COUNT("Line lost");
+                }
+                float left_percent = speed * (1 + correction);
+                float right_percent = speed * (1 - correction);
+                left_motor.SetPercent(left_percent > 100 ? 100 : (left_percent < -100 ? -100 : left_percent));
+                right_motor.SetPercent(right_percent > 100 ? 100 : (right_percent < -100 ? -100 : right_percent));
+            }
+            else {
+                const LineSteering &steering = follower.steer(frame.lineLeft, frame.lineMiddle, frame.lineRight);
+                LOG_DEBUG_EVERY(LOOP_LOG_INTERVAL, steering.name);
+                left_motor.SetPercent(steering.left * speed);
+                right_motor.SetPercent(steering.right * speed);
+            }
+            return true;
+        });
+        float remaining = distance - inchesTraveled();
+        if(options.stopAtEnd) {
+            right_motor.Stop();
+            left_motor.Stop();
+        }
+        return watch.finish(remaining <= 0, remaining);
+}
+
+/** followLine
+    Makes the robot follow a black line, pivoting into the wall if one bump switch hits.
+    @param speed Motor percent
+    @param distance Distance robot needs to travel
+    @return How the move ended
+*/
+MotionResult followLine(float speed, float distance) {
+        BENCH_PRIMITIVE();
+        LineFollowOptions options = {BLACK_LINE, 3, false, true, speed + 10, -15, false, false};
+        return followLineWith(speed, distance, options);
+}
+
+/** followLineTracking
+    Makes the robot follow a black line steering in proportion to the line error, which stays smooth at
+    higher speeds than followLine. Stops and reacts to the bump switches the same way as followLine.
+    @param speed Motor percent
+    @param distance Distance robot needs to travel
+    @return How the move ended
+*/
+MotionResult followLineTracking(float speed, float distance) {
+        BENCH_PRIMITIVE();
+        LineFollowOptions options = {BLACK_LINE, 3, false, true, speed + 10, -15, false, true};
+        return followLineWith(speed, distance, options);
+}
+
+/** followLineYellowSquare
+    Makes the robot follow a yellow line until it is squared up against a wall.
+    @param speed Motor percent
+    @param distance Distance robot needs to travel
+    @return How the move ended
+*/
+MotionResult followLineYellowSquare(float speed, float distance) {
+        BENCH_PRIMITIVE();
+        LineFollowOptions options = {YELLOW_LINE, 5, false, true, 2 * speed, -speed * .1f, true, false};
+        return followLineWith(speed, distance, options);
+}
+
+/** followLineYellow
+    Makes the robot follow a yellow line, stopping as soon as either bump switch hits.
+    @param speed Motor percent
+    @param distance Distance robot needs to travel
+    @return How the move ended
+*/
+MotionResult followLineYellow(float speed, float distance) {
+        BENCH_PRIMITIVE();
+        LineFollowOptions options = {YELLOW_LINE, 5, true, false, 0, 0, false, false};
+        return followLineWith(speed, distance, options);
+}
+
+/** turn_left
+    Turns the robot to the left for a certain amount of degrees
+    @param percent Motor percent
+    @param degrees Amount for robot to turn
+    @param timeout Time allowed (in seconds), picked from the angle by default
+    @return How the turn ended, with the error in degrees
+*/
+MotionResult turn_left(int percent, float degrees, float timeout = MOTION_AUTO_TIMEOUT) //using encoders
+{
+    BENCH_PRIMITIVE();
+    //Reset encoder counts
+    resetEncoders();
+    float counts = degrees * calibration.leftCountsPerDegree;
+    right_motor.SetPercent(percent);
+    left_motor.SetPercent(-1 * percent);
+    MotionWatch watch(frame, motionTimeout(counts / calibration.countsPerInch, percent, timeout));
+    watch.watchStalls();
+    sensors.setChannels(SENSE_ENCODERS);
+    controlLoop.run([&](double now) {
+        return (frame.rightCounts + frame.leftCounts)/2. < counts && watch.check(now);
+    });
+    float remaining = (counts - (frame.rightCounts + frame.leftCounts) / 2.) / calibration.leftCountsPerDegree;
+
+    //Turn off motors
+    right_motor.Stop();
+    left_motor.Stop();
+    return watch.finish(remaining <= 0, remaining);
+}
+
+/** turn_right
+    Turns the robot to the right for a certain amount of degrees
+    @param percent Motor percent
+    @param degrees Amount for robot to turn
+    @param timeout Time allowed (in seconds), picked from the angle by default
+    @return How the turn ended, with the error in degrees
+*/
+MotionResult turn_right(int percent, float degrees, float timeout = MOTION_AUTO_TIMEOUT) //using encoders
+{
+    BENCH_PRIMITIVE();
+    //Reset encoder counts
+    resetEncoders();
+    float counts = degrees * calibration.rightCountsPerDegree;
+    right_motor.SetPercent(-1 * percent);
+    left_motor.SetPercent(percent);
+    MotionWatch watch(frame, motionTimeout(counts / calibration.countsPerInch, percent, timeout));
+    watch.watchStalls();
+    sensors.setChannels(SENSE_ENCODERS);
+    controlLoop.run([&](double now) {
+        return (frame.rightCounts + frame.leftCounts)/2. < counts && watch.check(now);
+    });
+    float remaining = (counts - (frame.rightCounts + frame.leftCounts) / 2.) / calibration.rightCountsPerDegree;
+
+    //Turn off motors
+    right_motor.Stop();
+    left_motor.Stop();
+    return watch.finish(remaining <= 0, remaining);
+}
+/** angleBetween
+    Gets the smaller angle between two unit vectors
+    @param degree1 Degree of first vector
+    @param degree2 Degree of second vector
+    @return The angle between the two vectors (angle < 180)
+*/
+float angleBetween(float degree1, float degree2) {
+    return fabs(angleDifference(degree1, degree2));
+}
+
+
+/** faceDegree
+    Turns the robot in place to face a certain degree in one smooth motion. The heading comes from the
+    pose estimate, which follows the encoders between RPS updates, and a PD controller sets the turn speed
+    from the remaining error.
+    @param degree Degree robot should face
+    @param timeout Time allowed to settle on the heading (in seconds)
+    @return How the turn ended, with the heading error in degrees
+*/
+MotionResult faceDegree(float degree, float timeout = HEADING_TIMEOUT) {
+    BENCH_PRIMITIVE();
+    double start_time = TimeNow();
+    float last_heading = currentPose().heading;
+    float rate = 0;
+    float mp = 0;
+    double settled_since = -1;
+    double last_time = start_time;
+    bool settled = false;
+    MotionWatch watch(frame, timeout);
+    watch.watchStalls();
+    sensors.setChannels(SENSE_ENCODERS | SENSE_RPS);
+    controlLoop.run([&](double now) {
+        float heading = odometry.pose().heading;
+        if(now > last_time) {
+            rate = angleDifference(heading, last_heading) / (now - last_time);
+        }
+        last_heading = heading;
+        last_time = now;
+        float error = angleDifference(degree, heading);
+        if(fabs(error) < HEADING_TOLERANCE) {
+            if(settled_since < 0) {
+                settled_since = now;
+            }
+            right_motor.Stop();
+            left_motor.Stop();
+            mp = 0;
+            if(now - settled_since >= HEADING_SETTLE_TIME) {
+                settled = true;
+                return false;
+            }
+            return watch.check(now, false);
+        }
+        if(!watch.check(now)) {
+            return false;
+        }
+        settled_since = -1;
+        mp = HEADING_KP * error - HEADING_KD * rate;
+        //Don't command less than it takes to overcome friction, or more than the encoders can keep up with
+        if(fabs(mp) < HEADING_MIN_PERCENT) {
+            mp = error > 0 ? HEADING_MIN_PERCENT : -HEADING_MIN_PERCENT;
+        }
+        else if(fabs(mp) > HEADING_MAX_PERCENT) {
+            mp = mp > 0 ? HEADING_MAX_PERCENT : -HEADING_MAX_PERCENT;
+        }
+        right_motor.SetPercent(mp);
+        left_motor.SetPercent(-mp);
+        return true;
+    });
+
+    //Turn off motors
+    right_motor.Stop();
+    left_motor.Stop();
+    return watch.finish(settled, angleDifference(degree, odometry.pose().heading));
+}
+/** readRps
+    Takes a new sensor frame, so frame.x, frame.y and frame.heading hold the latest RPS reading
+    @return Time of the reading
+*/
+double readRps() {
+    currentPose();
+    return frame.time;
+}
+
+/** distanceTo
+    Gets how far the robot is from a point on the course
+    @return Distance from the robot's estimated position to (x, y)
+*/
+float distanceTo(float x, float y) {
+    const Pose &pose = currentPose();
+    return distanceBetween(pose.x, pose.y, x, y);
+}
+
+/** correctPosition
+    Drives the robot straight along the axis it is facing until RPS puts it within a tolerance of a
+    coordinate. Each correction covers the whole error from one RPS reading in a single profiled move, and
+    the next reading is only taken once RPS has caught up with where the robot stopped.
+    @param alongX true if the robot is facing along the x axis, false for the y axis
+    @param facing 1 if the robot is facing the positive direction along the axis, -1 for the negative
+    @param coordinate The coordinate the robot should go to
+    @param tolerance How close to the coordinate is close enough (in inches)
+    @param timeout Time allowed (in seconds)
+    @return How the move ended, with how far RPS puts the robot from the coordinate
+*/
+MotionResult correctPosition(bool alongX, int facing, float coordinate, float tolerance, float timeout)
+{
+    MotionWatch watch(frame, timeout);
+    watch.watchRps();
+    float position = -1;
+    while(watch.check(readRps()))
+    {
+        position = alongX ? frame.x : frame.y;
+        if(position < 0) {
+            //Wait for RPS to come back instead of moving blind, until the deadline or it has been gone too long
+            controlLoop.run([&](double now) {
+                return frame.x < 0 && watch.check(now, false);
+            });
+            continue;
+        }
+        if(fabs(position - coordinate) <= tolerance) {
+            break;
+        }
+        BENCH_COUNT("RPS correction");
+        MotionResult move = move_profiled(facing * (coordinate - position));
+        if(move.bumped) {
+            watch.bumped();
+            break;
+        }
+        //The move checked its own ticks, so count the RPS fixes taken during it
+        double sinceFix = odometry.getTimeSinceFix(TimeNow());
+        if(sinceFix >= 0) {
+            watch.sawRps(TimeNow() - sinceFix);
+        }
+        //RPS readings lag behind the robot, so wait until one from after it stopped is in
+        double stopped = TimeNow();
+        controlLoop.run([&](double now) {
+            return now - stopped < RPS_LATENCY && watch.check(now, false);
+        });
+    }
+    float error = position - coordinate;
+    return watch.finish(position >= 0 && fabs(error) <= tolerance, error);
+}
+
+/** check_x_plus
+    Moves the robot to a certain x coordinate while it is facing the positive x direction
+    @param x_coordinate The coordinate the robot should go
+    @param timeout Time allowed (in seconds)
+    @return How the move ended, with how far RPS puts the robot from the coordinate
+*/
+MotionResult check_x_plus(float x_coordinate, float timeout = RPS_CHECK_TIMEOUT) //using RPS while robot is in the +x direction
+{
+    BENCH_PRIMITIVE();
+    return correctPosition(true, 1, x_coordinate, 1, timeout);
+}
+/** check_x_minus
+    Moves the robot to a certain x coordinate while it is facing the negative x direction
+    @param x_coordinate The coordinate the robot should go
+    @param timeout Time allowed (in seconds)
+    @return How the move ended, with how far RPS puts the robot from the coordinate
+*/
+MotionResult check_x_minus(float x_coordinate, float timeout = RPS_CHECK_TIMEOUT) //using RPS while robot is in the -x direction
+{
+    BENCH_PRIMITIVE();
+    return correctPosition(true, -1, x_coordinate, 1, timeout);
+}
+/** check_y_minus
+    Moves the robot to a certain y coordinate while it is facing the negative y direction
+    @param y_coordinate The coordinate the robot should go
+    @param timeout Time allowed (in seconds)
+    @return How the move ended, with how far RPS puts the robot from the coordinate
+*/
+MotionResult check_y_minus(float y_coordinate, float timeout = RPS_CHECK_TIMEOUT) //using RPS while robot is in the -y direction
+{
+    BENCH_PRIMITIVE();
+    return correctPosition(false, -1, y_coordinate, 0.5, timeout);
+}
+bool on_line() {
+    float leftValue = left.Value();
+    float rightValue = right.Value();
+   float midValue = middle.Value();
+    return (midValue >= ON_LINE && rightValue >= ON_LINE && leftValue>= ON_LINE);
+}
+
+/** check_y_plus
+    Moves the robot to a certain y coordinate while it is facing the positive y direction
+    @param y_coordinate The coordinate the robot should go
+    @param timeout Time allowed (in seconds)
+    @return How the move ended, with how far RPS puts the robot from the coordinate
+*/
+MotionResult check_y_plus(float y_coordinate, float timeout = RPS_CHECK_TIMEOUT) //using RPS while robot is in the +y direction
+{
+    BENCH_PRIMITIVE();
+    return correctPosition(false, 1, y_coordinate, 1, timeout);
+}
+/** locationDegree
+    Gets the heading from the robot to a point on the course
+    @param x The x coordinate of the point
+    @param y The y coordinate of the point
+    @return Heading the robot would need to face the point (0 to 360)
+*/
+float locationDegree(float x, float y) {
+    const Pose &pose = currentPose();
+    float delY = y - pose.y;
+    float delX = x - pose.x;
+    return fastAtan2(delY, delX);
+}
+
+/** faceLocation
+    Turns the robot to face a point on the course
+    @param x The x coordinate of the point
+    @param y The y coordinate of the point
+    @return How the turn ended: the first turn's result if it stalled or timed out, otherwise the final
+            heading correction's, timed from the start of the first turn
+*/
+MotionResult faceLocation(float x, float y) {
+    BENCH_PRIMITIVE();
+    float angle = locationDegree(x, y);
+    float currentHeading = currentPose().heading;
+    float deltaTheta = angleBetween(currentHeading, angle);
+    float tempAngle = angle - currentHeading;
+    if(tempAngle < 0) {
+        tempAngle += 360;
+    }
+    MotionResult turn;
+    if(tempAngle > 180) {
+        turn = turn_right(30, deltaTheta);
+    }
+    else {
+        turn = turn_left(30, deltaTheta);
+    }
+    //A robot that couldn't turn the first time won't do better correcting the heading
+    if(turn.stalled || turn.timedOut) {
+        return turn;
+    }
+    LOG_INFO("Facing: ", angle);
+    MotionResult result = faceDegree(angle);
+    result.elapsed += turn.elapsed;
+    return result;
+
+}
+
+/** faceLocationBack
+    Turns the robot so its back faces a point on the course
+    @param x The x coordinate of the point
+    @param y The y coordinate of the point
+    @return How the turn ended
+*/
+MotionResult faceLocationBack(float x, float y) {
+    BENCH_PRIMITIVE();
+    float angle = normalizeDegrees(locationDegree(x, y) - 180);
+    float currentHeading = currentPose().heading;
+    LOG_INFO("Current Heading: ", currentHeading);
+
+    float deltaTheta = angleBetween(currentHeading, angle);
+    LOG_INFO("delta theta: ", deltaTheta);
+    float tempAngle = angle - currentHeading;
+    if(tempAngle < 0) {
+        tempAngle += 360;
+    }
+    MotionResult result;
+    if(tempAngle > 180) {
+        result = turn_right(30, deltaTheta);
+    }
+    else {
+        result = turn_left(30, deltaTheta);
+    }
+    LOG_INFO("Facing: ", angle);
+    return result;
+
+}
+/** followPath
+    Drives through a list of waypoints in one smooth motion, steering towards a point further along the
+    path from the pose estimate every tick instead of stopping to turn at each waypoint. It slows down
+    over the last few inches and stops at the last waypoint, at a wall when going forwards, or if the
+    path takes much longer than it should.
+    @param points Waypoints to drive through in order, starting from wherever the robot is
+    @param count Number of waypoints
+    @param percent Motor percent
+    @param backwards true to drive the path with the back of the robot leading
+    @return How the move ended, with the distance left along the path in inches
+*/
+MotionResult followPath(const Waypoint *points, int count, float percent = PURSUIT_SPEED, bool backwards = false) {
+    BENCH_PRIMITIVE();
+    PurePursuit pursuit(PURSUIT_LOOKAHEAD, TRACK_WIDTH);
+    const Pose &start = currentPose();
+    pursuit.start(start.x, start.y, points, count);
+    bool arrived = false;
+    MotionWatch watch(frame, pursuit.length() * PROFILE_KV / PURSUIT_MIN_PERCENT + PURSUIT_TIMEOUT_MARGIN);
+    watch.watchStalls();
+    sensors.setChannels(backwards ? SENSE_ENCODERS : SENSE_ENCODERS | SENSE_BUMPS);
+    controlLoop.run([&](double now) {
+        float left_share, right_share;
+        if(!pursuit.steer(odometry.pose(), backwards, PURSUIT_TOLERANCE, left_share, right_share)) {
+            arrived = true;
+            return false;
+        }
+        bool bumped = !backwards && !(frame.leftBump && frame.rightBump);
+        if(bumped) {
+            watch.bumped();
+        }
+        if(bumped || !watch.check(now)) {
+            LOG_WARN("Path stopped short: ", pursuit.getRemaining());
+            return false;
+        }
+        float mp = percent;
+        if(pursuit.getRemaining() < PURSUIT_SLOW_DISTANCE) {
+            mp = PURSUIT_MIN_PERCENT + (percent - PURSUIT_MIN_PERCENT) * pursuit.getRemaining() / PURSUIT_SLOW_DISTANCE;
+        }
+        left_motor.SetPercent(mp * left_share);
+        right_motor.SetPercent(mp * right_share);
+        return true;
+    });
+
+    //Turn off motors
+    right_motor.Stop();
+    left_motor.Stop();
+    return watch.finish(arrived, pursuit.getRemaining());
+}
+
+/** followRoute
+    Drives the shortest route through the course map's waypoints from one to another
+    @param from Waypoint the robot is at
+    @param to Waypoint to drive to
+    @param backwards true to drive the route with the back of the robot leading
+    @return How the move ended
+*/
+MotionResult followRoute(CourseNode from, CourseNode to, bool backwards = false) {
+    Waypoint path[MAX_WAYPOINTS];
+    int count = courseMap.route(from, to, path, MAX_WAYPOINTS);
+    return followPath(path, count, PURSUIT_SPEED, backwards);
+}
+
+/** moveToForwards
+    Drives the robot forwards to a point on the course, curving towards it from whichever way it faces
+    @param x The x coordinate the robot should go to
+    @param y The y coordinate the robot should go to
+    @return How the move ended
+*/
+MotionResult moveToForwards(float x, float y) {
+    Waypoint target = {x, y};
+    return followPath(&target, 1);
+}
+
+/** moveToBackwards
+    Drives the robot backwards to a point on the course, curving towards it from whichever way it faces
+    @param x The x coordinate the robot should go to
+    @param y The y coordinate the robot should go to
+    @return How the move ended
+*/
+MotionResult moveToBackwards(float x, float y) {
+    Waypoint target = {x, y};
+    return followPath(&target, 1, PURSUIT_SPEED, true);
+}
+/** moveTo
+    Moves the robot to a certain coordinate.
+    @param x The x coordinate the robot should go to
+    @param y The y coordinate the robot should go to
+    @return How the move ended
+*/
+MotionResult moveTo(float x, float y) {
+    return moveToForwards(x, y);
+}
+/** waitForStart
+    Initializes menu, waits for start light to go on.
+*/
+void waitForStart() {
+    RPS.InitializeTouchMenu();
+    LCD.Clear();
+    setRPSCoords();
+    while(cds2.Value() > 0.8);
+}
+/** getLightColor
+    Returns the color of the fuel light.
+    @return 1 if light is blue, 2 if light is red
+*/
+int getLightColor() {
+    LOG_INFO(cds1.Value());
+    if(cds1.Value() < BLUE_LIGHT_ON) {
+        return 0;
+    }
+    else {
+        return 1;
+    }
+}
+/** detectingLight
+    Finds out whether the robot is detecting a light or not
+    @return true if robot is detecting light, false otherwise
+*/
+bool detectingLight(int cell) {
+    if(cell == 1) {
+        if(RPS.CurrentCourse() == 'a' || RPS.CurrentCourse() == 'A') {
+            return cds1.Value() < Variant::FUEL_LIGHT_ON;
+        }
+        else {
+            return cds1.Value() < Variant::FUEL_LIGHT_ON;
+        }
+
+
+    }
+    else {
+        return cds2.Value() < 0.8;
+    }
+}
+
+
+/** setServo
+    Sets the servo thresholds.
+*/
+void setServo() {
+    arm.SetMin(884);
+    arm.SetMax(2235);
+}
+/** waitForArm
+    Keeps the control loop running until an arm move started earlier is done
+    @param move The move to wait for
+*/
+void waitForArm(const ArmMove &move) {
+    BENCH_PRIMITIVE();
+    controlLoop.run([&](double) {
+        return !move.done();
+    });
+}
+
+/** moveArm
+    Sweeps the arm from one angle to another and waits for it to get there
+    @param currentDegree Angle the arm is at
+    @param nextDegree Angle to move the arm to
+*/
+void moveArm(float currentDegree, float nextDegree) {
+    BENCH_PRIMITIVE();
+    ArmMove move = armController.moveFrom(currentDegree, nextDegree);
+    controlLoop.run([&](double) {
+        return !move.done();
+    });
+}
+
+/** pullSwitch
+    pulls a switch in front of the robot
+    @return The move raising the arm again, which is still going when this returns
+*/
+ArmMove pullSwitch(int s) {
+    if(s == 2) {
+        move_backwards(SPEED, 1.5);
+        moveArm(100, 35);
+
+        move_backwards_timed(SPEED, 2, 1);
+        //move_forward(20, 1);
+        return armController.moveFrom(35, 100);
+
+    }
+    else {
+        move_forward_timed(SPEED, 1, 1);
+         moveArm(100, 35);
+
+        move_backwards_timed(SPEED, 2.5, 1);
+        move_forward(SPEED, 0.5);
+        return armController.moveFrom(35, 100);
+    }
+
+
+
+}
+/** pushSwitch
+    pushes a switch in front of the robot
+    @return The move raising the arm again, which is still going when this returns
+*/
+ArmMove pushSwitch(int s) {
+    if(s == 2) {
+        move_backwards(30, 4);
+         moveArm(100, 35);
+
+        move_forward_timed(30, 3, Variant::SWITCH_PUSH_TIME);
+        return armController.moveFrom(35, 100);
+    }
+    else {
+        move_backwards(30 , Variant::SWITCH_PUSH_BACKUP);
+        moveArm(100, 35);
+        move_forward_timed(30, 3, Variant::SWITCH_PUSH_TIME);
+        return armController.moveFrom(35, 100);
+    }
+}
+/** tunedAngle
+    Picks between a turn angle tuned by hand on the robot and the angle the robot is meant to turn
+    @param tuned Angle that makes up for the hard-coded counts per degree
+    @param nominal Angle the turn is actually for
+    @return nominal once fitted constants are loaded, otherwise tuned
+*/
+float tunedAngle(float tuned, float nominal) {
+    return calibrated ? nominal : tuned;
+}
+
+/** goUpSideRamp
+    Assuming robot is facing ramp, moves up the side ramp, stopping when robot is completely on top level.
+*/
+void goUpSideRamp() {
+    move_forward_timed(SIDE_RAMP_PERCENT, 5, 100);
+    followLine(SIDE_RAMP_PERCENT, 7);
+    driveToWall(30);
+    move_backwards(Variant::SIDE_RAMP_BACKUP_PERCENT, 0.25);
+    turn_left(30, 90);
+    followLineTracking(LINE_TRACK_SPEED, 30);
+    driveToWall(30);
+    move_backwards(35,1);
+
+    turn_left(30, Variant::SIDE_RAMP_TOP_TURN);
+    LOG_INFO("FORWARD");
+
+    move_forward_timed(SPEED, 15, 100);
+    LOG_INFO("STOP");
+    right_motor.Stop();
+    left_motor.Stop();
+}
+/** flipSwitches
+    Flips all 3 switches to their correct orientation
+    @param red The direction for the red switch to go
+    @param white The direction for the white switch to go
+    @param blue The direction for the blue switch to go
+*/
+void flipSwitches(int red, int white, int blue) {
+    //The arm comes up while the robot drives on, as long as the robot is moving the way the switch was
+    //flipped. Otherwise the arm has to be clear of the switch before the robot moves.
+    ArmMove raise;
+    //Starting at middle switch
+    followLineYellowSquare(SPEED, 3);
+    if(white == 1) {
+        raise = pushSwitch(2);
+    }
+    else {
+        raise = pullSwitch(2);
+        waitForArm(raise);
+    }
+    driveToWall(SPEED);
+    move_forward_timed(30, 1, 0.5);
+    move_backwards(30, 1);
+    turn_right(30, 25);
+    move_forward(30, 1);
+    if(red == 1) {
+        raise = pushSwitch(1);
+        waitForArm(raise);
+    }
+    else {
+        raise = pullSwitch(1);
+    }
+    move_backwards(30, 0.5);
+    waitForArm(raise);
+   turn_left(30, 20);
+   driveToWall(SPEED);
+   move_forward_timed(30, 1, 0.5);
+   move_backwards(30, 1);
+    turn_left(30, 25);
+    //faceDegree(300);
+    move_forward(30, 1);
+    if(blue == 1) {
+        raise = pushSwitch(3);
+    }
+    else {
+        raise = pullSwitch(3);
+    }
+    waitForArm(raise);
+}
+/** completeSwitches
+    moves to switches and flips them
+*/
+void completeSwitches() {
+    BENCH_PHASE();
+
+    flipSwitches(RPS.RedSwitchDirection(), RPS.WhiteSwitchDirection(), RPS.BlueSwitchDirection());
+}
+/** pushButton
+    pushes correct fuel button
+*/
+void pushButton(int correctButton) {
+
+    if(correctButton == 0) {
+        LOG_INFO("RED");
+        move_backwards(SPEED, 4.5);
+        moveArm(100, 33);
+        move_forward_timed(20, 3, 1.5);
+        move_forward_timed(5, 100, 5);
+        move_backwards_timed(30,3, 2);
+        armController.hold(100);
+    }
+    else {
+        LOG_INFO("BLUE");
+        armController.hold(120);
+        move_forward_timed(30, 100, 6);
+        move_backwards_timed(30, 3, 2);
+        move_backwards_timed(30, 3, 2);
+        armController.hold(100);
+    }
+}
+void wiggle() {
+    turn_right(15, 5);
+    turn_left(15, 5);
+    turn_right(15, 5);
+    turn_left(15, 5);
+    turn_right(15, 5);
+    turn_left(15, 5);
+}
+void pickUpSupplies() {
+
+
+    moveArm(100, 15);
+    LOG_INFO("moving arm down");
+    //The supplies are on the arm now, so it can come up while the robot backs away
+    armController.moveFrom(15, 100);
+    LOG_INFO("Moving arm up");
+}
+
+
+
+void dropSupplies() {
+    move_backwards(30, 1);
+    LOG_INFO("moving backwards");
+    moveArm(100, 25);
+    LOG_INFO("moving arm down");
+    move_backwards_timed(Variant::DROP_BACKUP_PERCENT, 5, 3);
+    LOG_INFO("moving backwards");
+    //Straight up without waiting, the supplies are off the arm
+    armController.hold(100);
+    LOG_INFO("setting arm up");
+
+    pivot_right(DROP_PIVOT_PERCENT, tunedAngle(DROP_PIVOT_DEGREES, 180));
+    followLineYellowSquare(20, 5);
+
+}
+
+/** findRPSPoints
+    Test program to get coordinates of important places on the course.
+*/
+void findRPSPoints() {
+    RPS.InitializeTouchMenu();
+    while(true) {
+        LCD.WriteLine(RPS.X());
+        LCD.WriteLine(RPS.Y());
+        LCD.WriteLine(RPS.Heading());
+        Sleep(100);
+        LCD.Clear();
+    }
+}
+void startToSupplies() {
+    BENCH_PHASE();
+    setServo();
+    armController.hold(100);
+    followRoute(NODE_START, NODE_SUPPLIES);
+    faceDegree(courseGraph.arrival(NODE_START, NODE_SUPPLIES));
+    check_y_minus(courseMap.point(NODE_SUPPLIES).y);
+
+
+    pickUpSupplies();
+}
+
+void suppliesToTop() {
+    BENCH_PHASE();
+    move_backwards(35, distanceTo(currentPose().x, Location::BOTTOM_SIDE_RAMP_Y + SIDE_RAMP_OFFSET)) ;
+    turn_left(30,90);
+    goUpSideRamp();
+
+}
+bool inYLightPostition() {
+    return currentPose().y <= Location::FUEL_LIGHT_Y;
+}
+
+void goToLight() {
+//    if(RPS.X() > 0) {
+//        LCD.WriteLine(RPS.X());
+//        LCD.WriteLine(distanceTo(RPS.X(), Location::FUEL_LIGHT_Y));
+//        followLineYellow(25, distanceTo(RPS.X(), Location::FUEL_LIGHT_Y) - 0.3);
+//    }
+    move_forward_timed(30, 5, 5);
+    double time = TimeNow();
+    while(!detectingLight(1) && TimeNow() - time < 1.5) {
+        followLineYellow(Variant::LIGHT_CREEP_PERCENT, 0.1);
+    }
+
+    right_motor.Stop();
+    left_motor.Stop();
+
+    LOG_INFO(cds1.Value());
+    Sleep(250);
+
+    int correctButton = getLightColor();
+    lightColor = correctButton;
+    if(correctButton == 0) {
+        LOG_INFO("RED");
+    }
+    else {
+        LOG_INFO("BLUE");
+
+    }
+    pushButton(correctButton);
+}
+
+void doButtons() {
+    BENCH_PHASE();
+    //check_x_minus(Location::FUEL_LIGHT_X);
+    turn_right(30, angleBetween(currentPose().heading,91));
+    if(currentPose().x>Location::FUEL_LIGHT_X) {
+        check_x_minus(Location::FUEL_LIGHT_X);
+    }
+    faceDegree(91);
+
+    goToLight();
+
+
+
+
+}
+void dropOff() {
+    BENCH_PHASE();
+    //Back round the top of the alcove wall to the drop off. A robot that never got up to the buttons is still
+    //beside the wall, so it backs out below it instead.
+    CourseNode from = currentPose().y >= ALCOVE_TOP_CLEAR_Y ? NODE_FUEL_BUTTONS : NODE_ALCOVE_EXIT;
+    followRoute(from, lightColor != 0 ? NODE_DROP_OFF_BLUE : NODE_DROP_OFF_RED, true);
+    //driveToWall squares the robot up against the wall, so an encoder turn is close enough
+    turn_left(35, angleBetween(currentPose().heading, 90));
+    LOG_INFO("FOLLOWING");
+    driveToWall(30);
+    LOG_INFO("DONE");
+    move_forward_timed(SPEED, 1, 0.75);
+
+    //followLineYellow(40, 10);
+    //drop package
+    dropSupplies();
+
+}
+
+void goHome() {
+    BENCH_PHASE();
+    //Through the gap between the end of the switch wall and the fuel light alcove, wherever the switches left the robot
+    followRoute(NODE_MID_SWITCH, NODE_ALCOVE_EXIT);
+    faceDegree(270);
+
+    move_forward_timed(HOME_DASH_PERCENT, HOME_DASH_DISTANCE, 3);
+    Sleep(50);
+        turn_left(30, tunedAngle(100, 90));
+        move_backwards(50, 17);
+        faceLocationBack(0, 0);
+        move_backwards_timed(50, 100, 3);
+
+        move_forward(SPEED, 5);
+        faceLocationBack(0, 0);
+        move_backwards(50, 10);
+
+}
+
+void goGoGo() {
+    startToSupplies();
+    suppliesToTop();
+    doButtons();
+    dropOff();
+    completeSwitches();
+    goHome();
+    BENCH_REPORT();
+}
+
+
+void cdsCheck() {
+    while(true) {
+        LCD.WriteLine(cds1.Value());
+        Sleep(50);
+        LCD.Clear();
+    }
+}
+
+/** measurePose
+    Waits for the robot to stop and RPS to catch up with it, then averages several readings
+    @param x Set to the average x
+    @param y Set to the average y
+    @param heading Set to the average heading
+    @return false if RPS didn't have enough valid readings
+*/
+bool measurePose(float &x, float &y, float &heading) {
+    BENCH_PRIMITIVE();
+    int samples = 0;
+    float sumX = 0;
+    float sumY = 0;
+    float sumTurn = 0;
+    float first = 0;
+    double start = TimeNow();
+    double next = start + CALIBRATION_SETTLE_TIME + RPS_LATENCY;
+    sensors.setChannels(SENSE_ENCODERS | SENSE_RPS);
+    controlLoop.run([&](double now) {
+        if(now < next) {
+            return true;
+        }
+        next = now + CALIBRATION_SAMPLE_PERIOD;
+        if(frame.x >= 0 && frame.heading >= 0) {
+            if(samples == 0) {
+                first = frame.heading;
+            }
+            sumX += frame.x;
+            sumY += frame.y;
+            //Average the headings as turns from the first one so readings either side of 0 don't cancel out
+            sumTurn += angleDifference(frame.heading, first);
+            samples++;
+        }
+        return samples < CALIBRATION_SAMPLES &&
+               now - start < CALIBRATION_SETTLE_TIME + RPS_LATENCY + 2 * CALIBRATION_SAMPLES * CALIBRATION_SAMPLE_PERIOD;
+    });
+    if(samples < CALIBRATION_SAMPLES) {
+        return false;
+    }
+    x = sumX / samples;
+    y = sumY / samples;
+    heading = normalizeDegrees(first + sumTurn / samples);
+    return true;
+}
+
+/** calibrateOdometry
+    Drives forwards and back and turns left and right by set amounts while RPS watches, fits the counts per
+    inch and per degree to what RPS saw, and saves them to the SD card for the next startup. The robot
+    needs CALIBRATION_DISTANCE inches clear in front of it.
+*/
+void calibrateOdometry() {
+    OdometryCalibration fit;
+    float lastX, lastY, lastHeading;
+    LCD.WriteLine("Calibrating");
+    if(!measurePose(lastX, lastY, lastHeading)) {
+        LCD.WriteLine("No RPS");
+        return;
+    }
+    for(int i = 0; i < CALIBRATION_REPEATS * 4; i++) {
+        int leg = i % 4;
+        if(leg == 0) {
+            move_profiled(CALIBRATION_DISTANCE);
+        }
+        else if(leg == 1) {
+            move_profiled(-CALIBRATION_DISTANCE);
+        }
+        else if(leg == 2) {
+            turn_left(CALIBRATION_TURN_PERCENT, CALIBRATION_DEGREES);
+        }
+        else {
+            turn_right(CALIBRATION_TURN_PERCENT, CALIBRATION_DEGREES);
+        }
+        float x, y, heading;
+        if(!measurePose(x, y, heading)) {
+            LCD.WriteLine("RPS lost");
+            return;
+        }
+        //The primitive reset the encoders, so these are the counts for this leg including any coasting
+        float counts = (frame.leftCounts + frame.rightCounts) / 2.;
+        if(leg < 2) {
+            fit.addStraight(distanceBetween(lastX, lastY, x, y), counts);
+        }
+        else {
+            fit.addTurn(angleDifference(heading, lastHeading), counts);
+        }
+        lastX = x;
+        lastY = y;
+        lastHeading = heading;
+    }
+
+    //Checked against the hard-coded constants, so a bad fit saved earlier can't let a worse one through
+    OdometryConstants fitted = DEFAULT_CALIBRATION;
+    if(!fit.fit(fitted)) {
+        LCD.WriteLine("Fit out of range, not saved");
+        return;
+    }
+    calibration = fitted;
+    calibrated = true;
+    odometry.setConstants(calibration.countsPerInch, calibration.leftCountsPerDegree, calibration.rightCountsPerDegree);
+    LCD.Write("Counts/in: ");
+    LCD.WriteLine(calibration.countsPerInch);
+    LCD.Write("Left counts/deg: ");
+    LCD.WriteLine(calibration.leftCountsPerDegree);
+    LCD.Write("Right counts/deg: ");
+    LCD.WriteLine(calibration.rightCountsPerDegree);
+    LCD.Write("RMS straight counts: ");
+    LCD.WriteLine(fit.getStraight().residual());
+    LCD.Write("RMS left counts: ");
+    LCD.WriteLine(fit.getLeft().residual());
+    LCD.Write("RMS right counts: ");
+    LCD.WriteLine(fit.getRight().residual());
+    if(!OdometryCalibration::save(calibration)) {
+        LCD.WriteLine("Calibration not saved");
+    }
+}
+
+/** relayLeg
+    Drives forward with the relay test on the right motor until the tuner has measured enough oscillations
+    or the robot has gone RELAY_DISTANCE inches
+    @param percent Motor percent the gains are being tuned for
+    @param tuner Relay test to run
+    @return How the leg ended, completed if the tuner finished
+*/
+MotionResult relayLeg(float percent, RelayTuner &tuner) {
+    BENCH_PRIMITIVE();
+    resetEncoders();
+    float counts = RELAY_DISTANCE * calibration.countsPerInch;
+    tuner.resume();
+    right_motor.SetPercent(percent);
+    left_motor.SetPercent(percent);
+    MotionWatch watch(frame, motionTimeout(RELAY_DISTANCE, percent, MOTION_AUTO_TIMEOUT));
+    watch.watchStalls();
+    sensors.setChannels(SENSE_ENCODERS | SENSE_BUMPS);
+    controlLoop.run([&](double now) {
+        if(tuner.done() || (frame.leftCounts + frame.rightCounts) / 2. >= counts) {
+            return false;
+        }
+        if(!(frame.leftBump && frame.rightBump)) {
+            watch.bumped();
+            return false;
+        }
+        if(!watch.check(now)) {
+            return false;
+        }
+        right_motor.SetPercent(percent + tuner.output(frame.leftCounts - frame.rightCounts, now));
+        return true;
+    });
+
+    //Turn off motors
+    right_motor.Stop();
+    left_motor.Stop();
+    return watch.finish(tuner.done(), 0);
+}
+
+/** tuneDriveGains
+    Runs the relay test at each speed in the gain schedule and saves the gains it finds to the SD card for
+    the next startup. Each speed takes up to RELAY_LEGS legs, backing up after each one, so the robot needs
+    RELAY_DISTANCE inches clear in front of it. If something gets in the way the speeds tuned so far are
+    still saved and the rest keep their gains.
+*/
+void tuneDriveGains() {
+    LCD.WriteLine("Tuning drive gains");
+    bool blocked = false;
+    for(int i = 0; i < driveGains.getCount() && !blocked; i++) {
+        float percent = driveGains.getBand(i).percent;
+        RelayTuner tuner;
+        for(int leg = 0; leg < RELAY_LEGS && !tuner.done() && !blocked; leg++) {
+            MotionResult result = relayLeg(percent, tuner);
+            //Back up to where the leg started so the next one has room
+            move_profiled(-inchesTraveled());
+            blocked = result.bumped || result.stalled;
+        }
+        LCD.Write((int)percent);
+        if(!tuner.done()) {
+            LCD.WriteLine("%: not tuned");
+            continue;
+        }
+        DriveGains tuned = tuner.gains(percent, controlLoop.getPeriod());
+        driveGains.set(percent, tuned.kp, tuned.ki);
+        LCD.Write("%: kp ");
+        LCD.Write(tuned.kp);
+        LCD.Write(" ki ");
+        LCD.WriteLine(tuned.ki);
+    }
+    if(blocked) {
+        LCD.WriteLine("Blocked");
+    }
+    if(!GainSchedule::save(driveGains)) {
+        LCD.WriteLine("Gains not saved");
+    }
+}
+
+/** addControlTask
+    Registers a background task with the control loop. A task that doesn't fit would silently never run,
+    so the robot stops with a message instead of driving without it.
+*/
+void addControlTask(ControlLoop::BackgroundTask task, void *data) {
+    if(!controlLoop.addTask(task, data)) {
+        LCD.WriteLine("Too many control tasks");
+#ifdef FEH_SIMULATOR
+        assert(!"Too many control tasks, raise MAX_BACKGROUND_TASKS");
+#endif
+        while(true) {
+            Sleep(100);
+        }
+    }
+}
+
+/** initialize
+    Sets up the control loop and the arm before the start light.
+*/
+void initialize() {
+    controlLoop.setIdleTask(Logger::idle, &logger);
+    addControlTask(SensorBank::update, &sensors);
+    //The pose estimate needs every tick's encoder counts and RPS readings
+    sensors.setBaseChannels(SENSE_ENCODERS | SENSE_RPS);
+    odometry.reset(Location::START_X, Location::START_Y, START_HEADING, POSE_UNKNOWN_VARIANCE);
+    addControlTask(PoseEstimator::update, &odometry);
+    //Ramp the motors before the recorder logs what they were set to
+    addControlTask(DriveMotor::update, &left_motor);
+    addControlTask(DriveMotor::update, &right_motor);
+    addControlTask(FlightRecorder::update, &recorder);
+    MotionWatch::setFailureHandler(FlightRecorder::primitiveFailed, &recorder);
+    addControlTask(ArmController::update, &armController);
+    if(OdometryCalibration::load(calibration)) {
+        calibrated = true;
+        odometry.setConstants(calibration.countsPerInch, calibration.leftCountsPerDegree, calibration.rightCountsPerDegree);
+        LOG_INFO("Calibration loaded");
+    }
+    if(GainSchedule::load(driveGains)) {
+        LOG_INFO("Drive gains loaded");
+    }
+    setServo();
+    armController.hold(100);
+}
+
+/** runRobot
+    Runs the mission on the control loop, or the calibration or gain tuning if a button is held
+    @return Exit status for main
+*/
+template <class Policy>
+int runRobot(LoopPrimitives)
+{
+    initialize();
+    //Holding the middle button at startup runs the calibration instead of the mission
+    if(buttons.MiddlePressed()) {
+        RPS.InitializeTouchMenu();
+        calibrateOdometry();
+        return 0;
+    }
+    //Holding the right button runs the drive gain tuning
+    if(buttons.RightPressed()) {
+        tuneDriveGains();
+        return 0;
+    }
+    waitForStart();
+    if(RPS.X() >= 0) {
+        courseMap.locate(ANCHOR_START, RPS.X(), RPS.Y());
+    }
+    left_motor.resetCounts(TimeNow());
+    right_motor.resetCounts(TimeNow());
+    goGoGo();
+    logger.flushAll();
+    if(!recorder.save()) {
+        LCD.WriteLine("Flight log not saved");
+    }
+    controlLoop.report();
+    LCD.Write("Reads per tick: ");
+    LCD.WriteLine(sensors.getReadsPerCapture());
+    LCD.Write("Dropped logs: ");
+    LCD.WriteLine((int)logger.getDropped());
+    LCD.Write("RPS fixes: ");
+    LCD.WriteLine((int)odometry.getFixes());
+    LCD.Write("Pose +/- in: ");
+    LCD.WriteLine(odometry.getPositionUncertainty());
+    LCD.Write("Motor writes/s: ");
+    LCD.WriteLine(left_motor.getWriteRate(TimeNow()) + right_motor.getWriteRate(TimeNow()));
+    LCD.Write("Writes skipped: ");
+    LCD.WriteLine((int)(left_motor.getSkipped() + right_motor.getSkipped()));
+
+
+
+
+
+
+
+
+    return 0;
+
+}
+
+/** runRobot
+    Runs the original unchained program, which drives the motors itself with none of the control loop
+    @return Exit status for main
+*/
+template <class Policy>
+int runRobot(DirectPrimitives) {
+    DirectDrive<Policy> direct(FEHMotor::Motor3, FEHMotor::Motor2, left_encoder, right_encoder, frontLeftBump,
+                               frontRightBump, left, middle, right, cds1, cds2, arm);
+    return direct.run();
+}
+
+int main(void)
+{
+    return runRobot<Variant>(Variant::Primitives());
+}
@@ -0,0 +1,185 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <FEHUtility.h>
+#include <FEHLCD.h>
+#include "bench.h"
+
+//Default control period in seconds (500 Hz)
+#define CONTROL_PERIOD 0.002
+//Most background tasks that can be registered at once
+#define MAX_BACKGROUND_TASKS 8
+
+/**
+ * This is a class which runs the robot's control tasks at a fixed rate.
+ *
+ * A motion primitive hands run() a task that is called once per tick with the time the tick started,
+ * and returns false once the primitive is finished. Background tasks registered with addTask() are
+ * called at the start of every tick before the primitive, and the idle task is called repeatedly
+ * while the loop waits for the next tick. Ticks that start later than their deadline are recorded
+ * so the gains tuned against CONTROL_PERIOD can be trusted.
+ */
+class ControlLoop
+{
+    public:
+        typedef void (*BackgroundTask)(void *data, double now);
+
+        ControlLoop(double period = CONTROL_PERIOD) {
+            this->period = period;
+            taskCount = 0;
+            idleTask = 0;
+            idleData = 0;
+            resetStats();
+        }
+
+        /** setPeriod
+            Changes the tick period
+            @param period Time between ticks (in seconds)
+        */
+        void setPeriod(double period) {
+            this->period = period;
+        }
+
+        double getPeriod() const {
+            return period;
+        }
+
+        /** addTask
+            Registers a task to be run at the start of every tick
+            @param task Function to call with the tick time
+            @param data Pointer handed back to the task
+            @return false if there is no room for another task
+        */
+        bool addTask(BackgroundTask task, void *data) {
+            if(taskCount >= MAX_BACKGROUND_TASKS) {
+                return false;
+            }
+            tasks[taskCount] = task;
+            taskData[taskCount] = data;
+            taskCount++;
+            return true;
+        }
+
+        /** setIdleTask
+            Sets the task that is run while waiting for the next tick
+            @param task Function to call, or 0 to busy wait
+            @param data Pointer handed back to the task
+        */
+        void setIdleTask(BackgroundTask task, void *data) {
+            idleTask = task;
+            idleData = data;
+        }
+
+        /** run
+            Calls a task once per tick until it returns false
+            @param task Callable taking the tick time (in seconds) and returning whether to keep going
+            @return Time the task ran for (in seconds)
+        */
+        template <class Task>
+        double run(Task task) {
+            double start = TimeNow();
+            double next = start;
+            bool running = true;
+            while(running) {
+                double now = waitUntil(next);
+                recordTick(now - next);
+                if(now - next > period) {
+                    //We missed at least one whole tick, so start counting from now instead of
+                    //running several ticks back to back to catch up
+                    next = now;
+                }
+                runTasks(now);
+                BENCH_TICK(now);
+                running = task(now);
+                next += period;
+            }
+            return TimeNow() - start;
+        }
+
+        /** resetStats
+            Clears the tick, overrun and jitter counters
+        */
+        void resetStats() {
+            ticks = 0;
+            overruns = 0;
+            maxLateness = 0;
+            totalLateness = 0;
+        }
+
+        unsigned long getTicks() const {
+            return ticks;
+        }
+
+        unsigned long getOverruns() const {
+            return overruns;
+        }
+
+        /** getMaxJitter
+            @return Largest amount a tick started after its deadline (in seconds)
+        */
+        double getMaxJitter() const {
+            return maxLateness;
+        }
+
+        /** getMeanJitter
+            @return Average amount a tick started after its deadline (in seconds)
+        */
+        double getMeanJitter() const {
+            return ticks > 0 ? totalLateness / ticks : 0;
+        }
+
+        /** report
+            Writes the tick statistics to the LCD
+        */
+        void report() {
+            LCD.Write("Ticks: ");
+            LCD.WriteLine((int)ticks);
+            LCD.Write("Overruns: ");
+            LCD.WriteLine((int)overruns);
+            LCD.Write("Max jitter ms: ");
+            LCD.WriteLine((float)(maxLateness * 1000));
+        }
+
+    private:
+        double waitUntil(double deadline) {
+            double now = TimeNow();
+            while(now < deadline) {
+                if(idleTask) {
+                    idleTask(idleData, now);
+                }
+                now = TimeNow();
+            }
+            return now;
+        }
+
+        void recordTick(double lateness) {
+            ticks++;
+            totalLateness += lateness;
+            if(lateness > maxLateness) {
+                maxLateness = lateness;
+            }
+            if(lateness > period) {
+                overruns++;
+            }
+        }
+
+        void runTasks(double now) {
+            for(int i = 0; i < taskCount; i++) {
+                tasks[i](taskData[i], now);
+            }
+        }
+
+        double period;
+        BackgroundTask tasks[MAX_BACKGROUND_TASKS];
+        void *taskData[MAX_BACKGROUND_TASKS];
+        int taskCount;
+        BackgroundTask idleTask;
+        void *idleData;
+
+        unsigned long ticks;
+        unsigned long overruns;
+        double maxLateness;
+        double totalLateness;
+};
+
+#endif
@@ -0,0 +1,186 @@
+#ifndef SENSORS_H
+#define SENSORS_H
+
+#include <FEHIO.h>
+#include <FEHRPS.h>
+#include "bench.h"
+
+//Channels a SensorBank can capture, OR them together to select several
+#define SENSE_ENCODERS 1
+#define SENSE_BUMPS 2
+#define SENSE_LINE 4
+#define SENSE_CDS 8
+#define SENSE_RPS 16
+#define SENSE_ALL 31
+
+/**
+ * This is a struct which holds one reading of every sensor on the robot, taken at the start of a control tick.
+ * Bump values are the raw pin values, so they are true while the switch is NOT pressed.
+ */
+struct SensorFrame
+{
+    double time;
+    int leftCounts;
+    int rightCounts;
+    bool leftBump;
+    bool rightBump;
+    float lineLeft;
+    float lineMiddle;
+    float lineRight;
+    float cds1;
+    float cds2;
+    float x;
+    float y;
+    float heading;
+};
+
+/**
+ * This is a class which reads the robot's sensors once per control tick into a SensorFrame.
+ *
+ * Only the selected channels are read, so a primitive that only needs the encoders and bump switches
+ * doesn't pay for the line sensors or RPS. Every hardware read is counted so the traffic per tick can
+ * be checked against the old loops.
+ */
+class SensorBank
+{
+    public:
+        SensorBank(DigitalEncoder &leftEncoder, DigitalEncoder &rightEncoder,
+                   DigitalInputPin &leftBump, DigitalInputPin &rightBump,
+                   AnalogInputPin &lineLeft, AnalogInputPin &lineMiddle, AnalogInputPin &lineRight,
+                   AnalogInputPin &cds1, AnalogInputPin &cds2)
+            : leftEncoder(leftEncoder), rightEncoder(rightEncoder),
+              leftBump(leftBump), rightBump(rightBump),
+              lineLeft(lineLeft), lineMiddle(lineMiddle), lineRight(lineRight),
+              cds1(cds1), cds2(cds2) {
+            channels = SENSE_ALL;
+            baseChannels = 0;
+            reads = 0;
+            captures = 0;
+            current.time = 0;
+            current.leftCounts = current.rightCounts = 0;
+            current.leftBump = current.rightBump = true;
+            current.lineLeft = current.lineMiddle = current.lineRight = 0;
+            current.cds1 = current.cds2 = 0;
+            current.x = current.y = current.heading = -1;
+        }
+
+        /** setChannels
+            Chooses which sensors are read each tick
+            @param channels SENSE_* flags OR'd together
+        */
+        void setChannels(int channels) {
+            this->channels = channels;
+        }
+
+        /** setBaseChannels
+            Chooses sensors that are read every tick whatever the primitive selects, for background tasks
+            that need them
+            @param channels SENSE_* flags OR'd together
+        */
+        void setBaseChannels(int channels) {
+            baseChannels = channels;
+        }
+
+        /** getChannels
+            @return Sensors read each tick, including the base channels
+        */
+        int getChannels() const {
+            return channels | baseChannels;
+        }
+
+        /** capture
+            Reads the selected sensors into the current frame
+            @param time Time the reading was taken (in seconds)
+            @return The new frame
+        */
+        const SensorFrame &capture(double time) {
+            int channels = getChannels();
+            current.time = time;
+            if(channels & SENSE_ENCODERS) {
+                BENCH_SECTION(BENCH_ENCODERS);
+                current.leftCounts = leftEncoder.Counts();
+                current.rightCounts = rightEncoder.Counts();
+                reads += 2;
+            }
+            if(channels & SENSE_BUMPS) {
+                BENCH_SECTION(BENCH_DIGITAL);
+                current.leftBump = leftBump.Value();
+                current.rightBump = rightBump.Value();
+                reads += 2;
+            }
+            if(channels & SENSE_LINE) {
+                BENCH_SECTION(BENCH_ANALOG);
+                current.lineLeft = lineLeft.Value();
+                current.lineMiddle = lineMiddle.Value();
+                current.lineRight = lineRight.Value();
+                reads += 3;
+            }
+            if(channels & SENSE_CDS) {
+                BENCH_SECTION(BENCH_ANALOG);
+                current.cds1 = cds1.Value();
+                current.cds2 = cds2.Value();
+                reads += 2;
+            }
+            if(channels & SENSE_RPS) {
+                BENCH_SECTION(BENCH_RPS);
+                current.x = RPS.X();
+                current.y = RPS.Y();
+                current.heading = RPS.Heading();
+                reads += 3;
+                if(current.x < 0) {
+                    BENCH_COUNT("RPS invalid");
+                }
+            }
+            captures++;
+            return current;
+        }
+
+        /** frame
+            @return The most recent frame
+        */
+        const SensorFrame &frame() const {
+            return current;
+        }
+
+        /** getReads
+            @return Number of hardware reads made so far
+        */
+        unsigned long getReads() const {
+            return reads;
+        }
+
+        /** getReadsPerCapture
+            @return Average number of hardware reads per captured frame
+        */
+        float getReadsPerCapture() const {
+            return captures > 0 ? (float)reads / captures : 0;
+        }
+
+        /** update
+            Control loop task that captures a frame at the start of each tick
+            @param bank The SensorBank to update
+            @param now Time the tick started (in seconds)
+        */
+        static void update(void *bank, double now) {
+            ((SensorBank *)bank)->capture(now);
+        }
+
+    private:
+        DigitalEncoder &leftEncoder;
+        DigitalEncoder &rightEncoder;
+        DigitalInputPin &leftBump;
+        DigitalInputPin &rightBump;
+        AnalogInputPin &lineLeft;
+        AnalogInputPin &lineMiddle;
+        AnalogInputPin &lineRight;
+        AnalogInputPin &cds1;
+        AnalogInputPin &cds2;
+
+        int channels;
+        int baseChannels;
+        SensorFrame current;
+        unsigned long reads;
+        unsigned long captures;
+};
+
+#endif
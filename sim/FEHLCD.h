@@ -0,0 +1,36 @@
+#ifndef FEHLCD_H
+#define FEHLCD_H
+
+/**
+ * Simulated FEHLCD. Text is echoed to standard output with the virtual time when the simulator is set to
+ * echo the LCD, and every call costs about as much virtual time as it does on the Proteus.
+ */
+class FEHLCD
+{
+    public:
+        void Clear();
+        void Write(const char *text);
+        void Write(int value);
+        void Write(float value);
+        void Write(double value);
+        void Write(bool value);
+        void Write(char value);
+        void WriteLine(const char *text);
+        void WriteLine(int value);
+        void WriteLine(float value);
+        void WriteLine(double value);
+        void WriteLine(bool value);
+        void WriteLine(char value);
+        void WriteAt(const char *text, int x, int y);
+        void WriteAt(int value, int x, int y);
+        void WriteAt(float value, int x, int y);
+        void DrawRectangle(int x, int y, int width, int height);
+        void FillRectangle(int x, int y, int width, int height);
+        void SetFontColor(unsigned int color);
+        void SetBackgroundColor(unsigned int color);
+        bool Touch(float *x, float *y);
+};
+
+extern FEHLCD LCD;
+
+#endif
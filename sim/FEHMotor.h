@@ -0,0 +1,24 @@
+#ifndef FEHMOTOR_H
+#define FEHMOTOR_H
+
+/**
+ * Simulated FEHMotor. Ports are wired to the left and right wheels of the simulated drive base.
+ */
+class FEHMotor
+{
+    public:
+        enum FEHMotorPort
+        {
+            Motor0, Motor1, Motor2, Motor3
+        };
+
+        FEHMotor(FEHMotorPort port, float maxVoltage);
+        void SetPercent(float percent);
+        void Stop();
+
+    private:
+        FEHMotorPort port;
+        float maxVoltage;
+};
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef FEHRPS_H
+#define FEHRPS_H
+
+/**
+ * Simulated FEHRPS. Readings are the robot's pose sampled at the RPS update rate, delayed by the RPS
+ * latency and with noise added. Inside a dead zone or during a dropout X, Y and Heading return -1.
+ */
+class FEHRPS
+{
+    public:
+        void InitializeTouchMenu();
+        float X();
+        float Y();
+        float Heading();
+        char CurrentCourse();
+        int RedSwitchDirection();
+        int WhiteSwitchDirection();
+        int BlueSwitchDirection();
+};
+
+extern FEHRPS RPS;
+
+#endif
@@ -0,0 +1,24 @@
+#ifndef FEHSD_H
+#define FEHSD_H
+
+/**
+ * A file open on the simulated SD card.
+ */
+struct FEHFile;
+
+/**
+ * Simulated FEHSD. The SD card is the directory named by SIM_SD, or the working directory.
+ */
+class FEHSD
+{
+    public:
+        FEHFile *FOpen(const char *filename, const char *mode);
+        int FClose(FEHFile *file);
+        int FPrintf(FEHFile *file, const char *format, ...);
+        int FScanf(FEHFile *file, const char *format, ...);
+        int FEof(FEHFile *file);
+};
+
+extern FEHSD SD;
+
+#endif
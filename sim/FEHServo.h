@@ -0,0 +1,26 @@
+#ifndef FEHSERVO_H
+#define FEHSERVO_H
+
+/**
+ * Simulated FEHServo. The arm moves toward the commanded angle at the servo's top speed.
+ */
+class FEHServo
+{
+    public:
+        enum FEHServoPort
+        {
+            Servo0, Servo1, Servo2, Servo3, Servo4, Servo5, Servo6, Servo7
+        };
+
+        FEHServo(FEHServoPort port);
+        void SetMin(int min);
+        void SetMax(int max);
+        void SetDegree(float degree);
+        void Calibrate();
+        void Off();
+
+    private:
+        FEHServoPort port;
+};
+
+#endif
@@ -0,0 +1,27 @@
+#ifndef FEHUTILITY_H
+#define FEHUTILITY_H
+
+/**
+ * Simulated FEHUtility. Time is the simulator's virtual clock, so sleeping and busy waiting cost no real time.
+ */
+
+//Lets robot code check things on the host that it can only report on the robot
+#define FEH_SIMULATOR
+
+/** TimeNow
+    @return Seconds since the program started
+*/
+double TimeNow();
+
+/** Sleep
+    Waits for a number of milliseconds
+*/
+void Sleep(int msec);
+
+/** Sleep
+    Waits for a number of seconds
+*/
+void Sleep(float sec);
+void Sleep(double sec);
+
+#endif
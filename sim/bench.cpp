@@ -0,0 +1,538 @@
+/**
+ * Course time benchmark. Runs the mission, or one phase of it, many times on the simulator with
+ * different random seeds and writes how long each phase and primitive took as JSON.
+ *
+ * The robot program is compiled into this file with BENCHMARK defined so its BENCH_PHASE() and
+ * BENCH_PRIMITIVE() markers record timing. Build it once per robot (see variant.h) to compare them:
+ *
+ *     g++ -std=c++14 -O2 -Isim sim/bench.cpp sim/simulator.cpp sim/feh.cpp sim/course.cpp -o robot_bench
+ *     g++ ... -DROBOT_VARIANT=UnchainedRobot -o unchained_bench
+ *
+ * Each run is a forked child process, so the robot program's globals start fresh every time.
+ */
+#define BENCHMARK
+#define main robot_main
+#ifdef ROBOT_SOURCE
+#include ROBOT_SOURCE
+#else
+#include "../robot.cpp"
+#endif
+#undef main
+
+#include "../geometry.h"
+#include "simulator.h"
+#include "parallel.h"
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <type_traits>
+
+//Spells out the variant the robot program was built as (see variant.h)
+#define VARIANT_NAME(variant) #variant
+#define VARIANT_STRING(variant) VARIANT_NAME(variant)
+
+enum BenchStatus
+{
+    BENCH_COMPLETED,
+    BENCH_TIMED_OUT,
+    BENCH_CRASHED
+};
+
+static const char *STATUS_NAMES[] = {"completed", "timed_out", "crashed"};
+
+/**
+ * This is a struct which holds where the robot should be when a phase starts on the simulated course.
+ */
+struct BenchPhase
+{
+    const char *name;
+    void (*run)();
+    float x, y, heading;
+};
+
+/** rpsCorrection
+    Bench-only phase that drives the robot onto y coordinates in front of and then behind it with
+    check_y_minus, to time how fast the RPS position correction converges
+*/
+static void rpsCorrection() {
+    BENCH_PHASE();
+    check_y_minus(17);
+    check_y_minus(19);
+}
+
+//Headings the settle time phases turn to one after another: large and small turns both ways
+static const float SETTLE_HEADINGS[] = {180, 45, 60, 300, 270, 268};
+static const int SETTLE_HEADING_COUNT = sizeof(SETTLE_HEADINGS) / sizeof(SETTLE_HEADINGS[0]);
+
+/** legacyFaceDegree
+    Bench-only copy of faceDegree from before the PD heading controller: nudges the robot a tenth of a
+    degree at a time towards the RPS heading with a 50 ms wait after each nudge, until RPS puts it within
+    0.8 degrees or 5 seconds have passed
+*/
+static void legacyFaceDegree(float degree) {
+    BENCH_PRIMITIVE();
+    float error = angleDifference(degree, RPS.Heading());
+    double started = TimeNow();
+    while(fabs(error) > 0.8 && TimeNow() - started < 5) {
+        if(RPS.Heading() >= 0) {
+            error = angleDifference(degree, RPS.Heading());
+            if(error < 0) {
+                turn_right(15, 0.1);
+            }
+            else {
+                turn_left(15, 0.1);
+            }
+            Sleep(50);
+        }
+    }
+}
+
+/** settleHeading
+    Bench-only phase that turns to each of SETTLE_HEADINGS with the PD heading controller, to time how
+    long it takes to settle on a heading
+*/
+static void settleHeading() {
+    BENCH_PHASE();
+    for(int i = 0; i < SETTLE_HEADING_COUNT; i++) {
+        faceDegree(SETTLE_HEADINGS[i]);
+    }
+}
+
+/** settleHeadingLegacy
+    Bench-only phase that turns to the same headings as settleHeading with the old faceDegree
+*/
+static void settleHeadingLegacy() {
+    BENCH_PHASE();
+    for(int i = 0; i < SETTLE_HEADING_COUNT; i++) {
+        legacyFaceDegree(SETTLE_HEADINGS[i]);
+    }
+}
+
+static const BenchPhase PHASES[] = {
+    {"startToSupplies", startToSupplies, Location::START_X, Location::START_Y, 45},
+    {"suppliesToTop", suppliesToTop, 29.3, 14.3, 270},
+    {"doButtons", doButtons, 26.3, 48.5, 180},
+    {"dropOff", dropOff, 26.25, 57.5, 90},
+    {"completeSwitches", completeSwitches, Location::MID_SWITCH_X, 50, 270},
+    {"goHome", goHome, Location::MID_SWITCH_X, 43, 270},
+    {"rpsCorrection", rpsCorrection, 29.3, 20, 270},
+    {"settleHeading", settleHeading, 29.3, 20, 90},
+    {"settleHeadingLegacy", settleHeadingLegacy, 29.3, 20, 90}
+};
+static const int PHASE_COUNT = sizeof(PHASES) / sizeof(PHASES[0]);
+//Time the robot sits at the start of a phase before it runs (in seconds)
+static const float PHASE_SETTLE_TIME = 0.25;
+
+/**
+ * This is a struct which a child process sends back to the runner after one run. It is plain data so it
+ * can go through a pipe as is.
+ */
+struct BenchRun
+{
+    unsigned int seed;
+    int status;
+    double courseTime;
+    double hostTime;
+    int entryCount;
+    struct
+    {
+        char name[32];
+        bool phase;
+        int calls;
+        double total;
+        double longest;
+        unsigned long iterations;
+        unsigned long periods;
+        double periodTotal;
+        double shortestPeriod;
+        double longestPeriod;
+        unsigned long histogram[BENCH_HISTOGRAM_BUCKETS];
+    } entries[BENCH_MAX_ENTRIES];
+    BenchSectionTime sections[BENCH_SECTIONS];
+    int counterCount;
+    struct
+    {
+        char name[32];
+        unsigned long count;
+    } counters[BENCH_MAX_COUNTERS];
+};
+
+static const char *SECTION_NAMES[BENCH_SECTIONS] = {"encoders", "digital", "analog", "rps", "lcd", "recorder"};
+
+struct BenchOptions
+{
+    int runs;
+    unsigned int seed;
+    float noise;
+    float timeLimit;
+    const char *phase;
+    const char *output;
+    bool verbose;
+};
+
+static double hostSeconds() {
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static const BenchPhase *findPhase(const char *name) {
+    for(int i = 0; i < PHASE_COUNT; i++) {
+        if(strcmp(PHASES[i].name, name) == 0) {
+            return &PHASES[i];
+        }
+    }
+    return 0;
+}
+
+/** runOnce
+    Runs the mission or one phase on a fresh simulator, in the calling process
+*/
+static void runOnce(const BenchOptions &options, unsigned int seed, BenchRun *run) {
+    SimConfig config = defaultConfig();
+    config.seed = seed;
+    config.echoLcd = options.verbose;
+    config.timeLimit = options.timeLimit;
+    config.analogNoise *= options.noise;
+    config.wheelSlip *= options.noise;
+    config.rpsNoise *= options.noise;
+    config.rpsHeadingNoise *= options.noise;
+    config.rpsDropoutRate *= options.noise;
+    config.startPoseError *= options.noise;
+    const BenchPhase *phase = findPhase(options.phase);
+    if(phase) {
+        //No setup menu, the robot starts where the phase does
+        config.touchCount = 0;
+        config.startX = phase->x;
+        config.startY = phase->y;
+        config.startHeading = phase->heading;
+    }
+    simulator().reset(config);
+
+    double start = hostSeconds();
+    run->seed = seed;
+    run->status = BENCH_COMPLETED;
+    try {
+        if(phase) {
+            initialize();
+            //The setup menu gives RPS time to find the robot before a run, so do the same here
+            Sleep(PHASE_SETTLE_TIME);
+            phase->run();
+        }
+        else {
+            robot_main();
+        }
+    }
+    catch(const SimulationEnded &ended) {
+        run->status = BENCH_TIMED_OUT;
+    }
+    run->hostTime = hostSeconds() - start;
+
+    run->courseTime = 0;
+    run->entryCount = bench.getCount();
+    for(int i = 0; i < run->entryCount; i++) {
+        const BenchEntry &entry = bench.getEntry(i);
+        strncpy(run->entries[i].name, entry.name, sizeof(run->entries[i].name) - 1);
+        run->entries[i].name[sizeof(run->entries[i].name) - 1] = 0;
+        run->entries[i].phase = entry.phase;
+        run->entries[i].calls = entry.calls;
+        run->entries[i].total = entry.total;
+        run->entries[i].longest = entry.longest;
+        run->entries[i].iterations = entry.iterations;
+        run->entries[i].periods = entry.periods;
+        run->entries[i].periodTotal = entry.periodTotal;
+        run->entries[i].shortestPeriod = entry.shortestPeriod;
+        run->entries[i].longestPeriod = entry.longestPeriod;
+        for(int b = 0; b < BENCH_HISTOGRAM_BUCKETS; b++) {
+            run->entries[i].histogram[b] = entry.histogram[b];
+        }
+        //Phases don't overlap, so together they are the course time
+        if(entry.phase) {
+            run->courseTime += entry.total;
+        }
+    }
+    for(int i = 0; i < BENCH_SECTIONS; i++) {
+        run->sections[i] = bench.getSection((BenchSection)i);
+    }
+    run->counterCount = bench.getCounterCount();
+    for(int i = 0; i < run->counterCount; i++) {
+        strncpy(run->counters[i].name, bench.getCounter(i).name, sizeof(run->counters[i].name) - 1);
+        run->counters[i].name[sizeof(run->counters[i].name) - 1] = 0;
+        run->counters[i].count = bench.getCounter(i).count;
+    }
+}
+
+/** runInChild
+    Runs once in a forked process so every run starts with the robot program's globals reset
+*/
+static void runInChild(const BenchOptions &options, unsigned int seed, BenchRun *run) {
+    memset(run, 0, sizeof(*run));
+    run->seed = seed;
+    run->status = BENCH_CRASHED;
+    runForked([&](BenchRun *result) {
+        runOnce(options, seed, result);
+    }, run);
+}
+
+/** percentile
+    @param values Values to take the percentile of, sorted in place
+    @param fraction Percentile as a fraction (0.5 for the median)
+    @return The nearest-rank percentile, 0 if there are no values
+*/
+static double percentile(std::vector<double> &values, double fraction) {
+    if(values.empty()) {
+        return 0;
+    }
+    std::sort(values.begin(), values.end());
+    size_t rank = (size_t)(fraction * values.size() + 0.999999);
+    if(rank < 1) {
+        rank = 1;
+    }
+    return values[rank - 1];
+}
+
+static double mean(const std::vector<double> &values) {
+    double sum = 0;
+    for(size_t i = 0; i < values.size(); i++) {
+        sum += values[i];
+    }
+    return values.empty() ? 0 : sum / values.size();
+}
+
+/**
+ * This is a struct which collects one phase or primitive's timing across all runs.
+ */
+struct BenchSummary
+{
+    bool phase;
+    std::vector<double> totals;
+    std::vector<double> calls;
+    double longest;
+    unsigned long periods;
+    double periodTotal;
+    double shortestPeriod;
+    double longestPeriod;
+    unsigned long histogram[BENCH_HISTOGRAM_BUCKETS];
+};
+
+static void writeStats(FILE *out, std::vector<double> values) {
+    fprintf(out, "\"mean\": %.4f, \"p50\": %.4f, \"p95\": %.4f", mean(values), percentile(values, 0.5),
+            percentile(values, 0.95));
+}
+
+static void writeReport(FILE *out, const BenchOptions &options, const std::vector<BenchRun> &runs) {
+    std::map<std::string, BenchSummary> summaries;
+    std::vector<std::string> order;
+    std::vector<double> courseTimes;
+    std::vector<double> hostTimes;
+    int statusCounts[3] = {0, 0, 0};
+    for(size_t r = 0; r < runs.size(); r++) {
+        const BenchRun &run = runs[r];
+        statusCounts[run.status]++;
+        hostTimes.push_back(run.hostTime);
+        if(run.status == BENCH_COMPLETED) {
+            courseTimes.push_back(run.courseTime);
+        }
+        for(int i = 0; i < run.entryCount; i++) {
+            std::string name = run.entries[i].name;
+            if(!summaries.count(name)) {
+                order.push_back(name);
+                BenchSummary &added = summaries[name];
+                added.longest = 0;
+                added.periods = 0;
+                added.periodTotal = 0;
+                added.shortestPeriod = 0;
+                added.longestPeriod = 0;
+                for(int b = 0; b < BENCH_HISTOGRAM_BUCKETS; b++) {
+                    added.histogram[b] = 0;
+                }
+            }
+            BenchSummary &summary = summaries[name];
+            summary.phase = run.entries[i].phase;
+            summary.totals.push_back(run.entries[i].total);
+            summary.calls.push_back(run.entries[i].calls);
+            summary.longest = std::max(summary.longest, run.entries[i].longest);
+            summary.periods += run.entries[i].periods;
+            summary.periodTotal += run.entries[i].periodTotal;
+            if(run.entries[i].periods > 0 && (summary.shortestPeriod == 0
+                                              || run.entries[i].shortestPeriod < summary.shortestPeriod)) {
+                summary.shortestPeriod = run.entries[i].shortestPeriod;
+            }
+            summary.longestPeriod = std::max(summary.longestPeriod, run.entries[i].longestPeriod);
+            for(int b = 0; b < BENCH_HISTOGRAM_BUCKETS; b++) {
+                summary.histogram[b] += run.entries[i].histogram[b];
+            }
+        }
+    }
+
+    fprintf(out, "{\n");
+    fprintf(out, "  \"program\": \"%s\",\n",
+#ifdef ROBOT_SOURCE
+            ROBOT_SOURCE
+#else
+            "../robot.cpp"
+#endif
+           );
+    fprintf(out, "  \"variant\": \"%s\",\n", VARIANT_STRING(ROBOT_VARIANT));
+    fprintf(out, "  \"phase\": \"%s\", \"runs\": %d, \"seed\": %u, \"noise\": %.3f, \"time_limit\": %.1f,\n",
+            options.phase, options.runs, options.seed, options.noise, options.timeLimit);
+    fprintf(out, "  \"completed\": %d, \"timed_out\": %d, \"crashed\": %d,\n", statusCounts[BENCH_COMPLETED],
+            statusCounts[BENCH_TIMED_OUT], statusCounts[BENCH_CRASHED]);
+    fprintf(out, "  \"course_seconds\": {");
+    writeStats(out, courseTimes);
+    fprintf(out, "},\n  \"host_seconds\": {");
+    writeStats(out, hostTimes);
+    fprintf(out, "},\n");
+    for(int phases = 1; phases >= 0; phases--) {
+        fprintf(out, "  \"%s\": {", phases ? "phases" : "primitives");
+        bool first = true;
+        for(size_t i = 0; i < order.size(); i++) {
+            BenchSummary &summary = summaries[order[i]];
+            if(summary.phase != (phases == 1)) {
+                continue;
+            }
+            fprintf(out, "%s\n    \"%s\": {\"runs\": %d, \"calls_per_run\": %.2f, \"longest_call\": %.4f, ",
+                    first ? "" : ",", order[i].c_str(), (int)summary.totals.size(), mean(summary.calls),
+                    summary.longest);
+            writeStats(out, summary.totals);
+            if(summary.periods > 0) {
+                fprintf(out, ", \"loop_hz\": %.1f, \"period_min_ms\": %.3f, \"period_max_ms\": %.3f, "
+                        "\"period_histogram\": [", summary.periods / summary.periodTotal,
+                        summary.shortestPeriod * 1000, summary.longestPeriod * 1000);
+                for(int b = 0; b < BENCH_HISTOGRAM_BUCKETS; b++) {
+                    fprintf(out, "%s%lu", b == 0 ? "" : ", ", summary.histogram[b]);
+                }
+                fprintf(out, "]");
+            }
+            fprintf(out, "}");
+            first = false;
+        }
+        fprintf(out, "\n  },\n");
+    }
+    //Hardware call time and counters, averaged per run
+    fprintf(out, "  \"histogram_ms\": [");
+    double limit = BENCH_HISTOGRAM_BASE;
+    for(int b = 0; b < BENCH_HISTOGRAM_BUCKETS - 1; b++) {
+        fprintf(out, "%s%.3f", b == 0 ? "" : ", ", limit * 1000);
+        limit *= 2;
+    }
+    fprintf(out, "],\n  \"sections\": {");
+    for(int i = 0; i < BENCH_SECTIONS; i++) {
+        double calls = 0;
+        double seconds = 0;
+        for(size_t r = 0; r < runs.size(); r++) {
+            calls += runs[r].sections[i].calls;
+            seconds += runs[r].sections[i].total;
+        }
+        fprintf(out, "%s\n    \"%s\": {\"calls_per_run\": %.1f, \"seconds_per_run\": %.4f}", i == 0 ? "" : ",",
+                SECTION_NAMES[i], calls / runs.size(), seconds / runs.size());
+    }
+    fprintf(out, "\n  },\n  \"counters\": {");
+    std::map<std::string, double> counters;
+    for(size_t r = 0; r < runs.size(); r++) {
+        for(int i = 0; i < runs[r].counterCount; i++) {
+            counters[runs[r].counters[i].name] += runs[r].counters[i].count;
+        }
+    }
+    for(std::map<std::string, double>::iterator it = counters.begin(); it != counters.end(); ++it) {
+        fprintf(out, "%s\"%s\": %.2f", it == counters.begin() ? "" : ", ", it->first.c_str(),
+                it->second / runs.size());
+    }
+    fprintf(out, "},\n");
+    fprintf(out, "  \"per_run\": [");
+    for(size_t r = 0; r < runs.size(); r++) {
+        const BenchRun &run = runs[r];
+        fprintf(out, "%s\n    {\"seed\": %u, \"status\": \"%s\", \"course_seconds\": %.4f, \"host_seconds\": %.4f, "
+                "\"phases\": {", r == 0 ? "" : ",", run.seed, STATUS_NAMES[run.status], run.courseTime,
+                run.hostTime);
+        bool first = true;
+        for(int i = 0; i < run.entryCount; i++) {
+            if(run.entries[i].phase) {
+                fprintf(out, "%s\"%s\": %.4f", first ? "" : ", ", run.entries[i].name, run.entries[i].total);
+                first = false;
+            }
+        }
+        fprintf(out, "}}");
+    }
+    fprintf(out, "\n  ]\n}\n");
+}
+
+static void usage() {
+    fprintf(stderr, "usage: bench [--runs N] [--seed S] [--noise SCALE] [--time-limit SECONDS] [--phase NAME]\n"
+            "             [--out FILE] [--verbose]\n");
+    fprintf(stderr, "phases: all");
+    for(int i = 0; i < PHASE_COUNT; i++) {
+        fprintf(stderr, " %s", PHASES[i].name);
+    }
+    fprintf(stderr, "\n");
+    exit(2);
+}
+
+int main(int argc, char **argv) {
+    BenchOptions options;
+    options.runs = 20;
+    options.seed = 1;
+    options.noise = 1;
+    options.timeLimit = 300;
+    options.phase = "all";
+    options.output = 0;
+    options.verbose = false;
+    for(int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if(strcmp(argv[i], "--runs") == 0 && hasValue) {
+            options.runs = atoi(argv[++i]);
+        }
+        else if(strcmp(argv[i], "--seed") == 0 && hasValue) {
+            options.seed = strtoul(argv[++i], 0, 10);
+        }
+        else if(strcmp(argv[i], "--noise") == 0 && hasValue) {
+            options.noise = atof(argv[++i]);
+        }
+        else if(strcmp(argv[i], "--time-limit") == 0 && hasValue) {
+            options.timeLimit = atof(argv[++i]);
+        }
+        else if(strcmp(argv[i], "--phase") == 0 && hasValue) {
+            options.phase = argv[++i];
+        }
+        else if(strcmp(argv[i], "--out") == 0 && hasValue) {
+            options.output = argv[++i];
+        }
+        else if(strcmp(argv[i], "--verbose") == 0) {
+            options.verbose = true;
+        }
+        else {
+            usage();
+        }
+    }
+    if(strcmp(options.phase, "all") != 0 && !findPhase(options.phase)) {
+        usage();
+    }
+    //The phases are the competition mission's, on the control loop, which the unchained program never sets up
+    if(strcmp(options.phase, "all") != 0 && std::is_same<Variant::Primitives, DirectPrimitives>::value) {
+        fprintf(stderr, "bench: the unchained robot only runs the whole mission\n");
+        exit(2);
+    }
+
+    std::vector<BenchRun> runs(options.runs);
+    for(int r = 0; r < options.runs; r++) {
+        runInChild(options, options.seed + r, &runs[r]);
+        fprintf(stderr, "run %d/%d seed %u: %s, %.2f s\n", r + 1, options.runs, runs[r].seed,
+                STATUS_NAMES[runs[r].status], runs[r].courseTime);
+    }
+
+    FILE *out = options.output ? fopen(options.output, "w") : stdout;
+    if(!out) {
+        perror(options.output);
+        return 1;
+    }
+    writeReport(out, options, runs);
+    if(out != stdout) {
+        fclose(out);
+    }
+    return 0;
+}
@@ -0,0 +1,132 @@
+/**
+ * Calibration fit tests. Checks RatioFit's slope and residual against samples worked out by hand, that
+ * OdometryCalibration fits each constant from its own moves and turns down fits too far from the constants
+ * it is given, and that saved constants load back.
+ *
+ *     g++ -std=c++14 -O2 -Isim sim/calibrationtest.cpp sim/feh.cpp sim/simulator.cpp sim/course.cpp -o calibrationtest
+ *     ./calibrationtest
+ */
+#include "../calibration.h"
+#include "check.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <unistd.h>
+
+static const OdometryConstants DEFAULTS = {33.74, 1.955, 1.88};
+
+static void testEmpty() {
+    RatioFit fit;
+    CHECK(fit.getCount() == 0);
+    CHECK(fit.slope() == 0);
+    CHECK(fit.residual() == 0);
+    //Samples at zero say nothing about the slope
+    fit.add(0, 0);
+    CHECK(fit.getCount() == 1);
+    CHECK(fit.slope() == 0);
+    CHECK(fit.residual() == 0);
+}
+
+static void testExact() {
+    RatioFit fit;
+    fit.add(12, 405);
+    fit.add(12, 405);
+    fit.add(6, 202.5);
+    CHECK_NEAR(fit.slope(), 33.75, 1e-4);
+    CHECK_NEAR(fit.residual(), 0, 1e-2);
+    fit.clear();
+    CHECK(fit.getCount() == 0);
+    CHECK(fit.slope() == 0);
+}
+
+static void testResidual() {
+    //Slope sum(xy) / sum(xx) = 76 / 40, and the sample at the origin adds nothing but a count
+    RatioFit fit;
+    fit.add(2, 5);
+    fit.add(6, 11);
+    fit.add(0, 0);
+    CHECK_NEAR(fit.slope(), (2 * 5 + 6 * 11) / 40.0, 1e-6);
+    double slope = fit.slope();
+    double squares = (5 - 2 * slope) * (5 - 2 * slope) + (11 - 6 * slope) * (11 - 6 * slope);
+    CHECK_NEAR(fit.residual(), sqrt(squares / 3), 1e-4);
+    //Negative distances are fitted through the origin the same way
+    RatioFit mirrored;
+    mirrored.add(-2, -5);
+    mirrored.add(-6, -11);
+    mirrored.add(0, 0);
+    CHECK_NEAR(mirrored.slope(), fit.slope(), 1e-6);
+    CHECK_NEAR(mirrored.residual(), fit.residual(), 1e-4);
+}
+
+static void testCalibration() {
+    OdometryCalibration calibration;
+    //Backwards drives count as forwards, and left and right turns are fitted apart
+    calibration.addStraight(12, 408);
+    calibration.addStraight(-12, 408);
+    calibration.addTurn(90, 177);
+    calibration.addTurn(-90, 180);
+    calibration.addTurn(-45, 90);
+    CHECK(calibration.getStraight().getCount() == 2);
+    CHECK(calibration.getLeft().getCount() == 1);
+    CHECK(calibration.getRight().getCount() == 2);
+    OdometryConstants constants = DEFAULTS;
+    CHECK(calibration.fit(constants));
+    CHECK_NEAR(constants.countsPerInch, 34, 1e-4);
+    CHECK_NEAR(constants.leftCountsPerDegree, 177 / 90.0, 1e-4);
+    CHECK_NEAR(constants.rightCountsPerDegree, 2, 1e-4);
+
+    //A constant with no samples is left alone
+    OdometryCalibration straightOnly;
+    straightOnly.addStraight(10, 340);
+    constants = DEFAULTS;
+    CHECK(straightOnly.fit(constants));
+    CHECK_NEAR(constants.countsPerInch, 34, 1e-4);
+    CHECK(constants.leftCountsPerDegree == DEFAULTS.leftCountsPerDegree);
+    CHECK(constants.rightCountsPerDegree == DEFAULTS.rightCountsPerDegree);
+
+    //More than CALIBRATION_MAX_CHANGE off is rejected, and only that constant is kept
+    OdometryCalibration bad;
+    bad.addStraight(12, 12 * DEFAULTS.countsPerInch * (1 + CALIBRATION_MAX_CHANGE + 0.05));
+    bad.addTurn(90, 180);
+    constants = DEFAULTS;
+    CHECK(!bad.fit(constants));
+    CHECK(constants.countsPerInch == DEFAULTS.countsPerInch);
+    CHECK_NEAR(constants.leftCountsPerDegree, 2, 1e-4);
+}
+
+static void testSaveLoad() {
+    char directory[] = "/tmp/calibrationtestXXXXXX";
+    if(!CHECK(mkdtemp(directory) != 0)) {
+        return;
+    }
+    setenv("SIM_SD", directory, 1);
+    OdometryConstants loaded = DEFAULTS;
+    CHECK(!OdometryCalibration::load(loaded));
+
+    OdometryConstants saved = {34.01, 1.973, 1.972};
+    CHECK(OdometryCalibration::save(saved));
+    CHECK(OdometryCalibration::load(loaded));
+    CHECK_NEAR(loaded.countsPerInch, saved.countsPerInch, 1e-4);
+    CHECK_NEAR(loaded.leftCountsPerDegree, saved.leftCountsPerDegree, 1e-4);
+    CHECK_NEAR(loaded.rightCountsPerDegree, saved.rightCountsPerDegree, 1e-4);
+
+    //A file too far from the defaults is ignored
+    OdometryConstants wild = {DEFAULTS.countsPerInch * 2, 1.955, 1.88};
+    CHECK(OdometryCalibration::save(wild));
+    loaded = DEFAULTS;
+    CHECK(!OdometryCalibration::load(loaded));
+    CHECK(loaded.countsPerInch == DEFAULTS.countsPerInch);
+
+    std::string file = std::string(directory) + "/" + CALIBRATION_FILE;
+    unlink(file.c_str());
+    rmdir(directory);
+}
+
+int main() {
+    testEmpty();
+    testExact();
+    testResidual();
+    testCalibration();
+    testSaveLoad();
+    return checkSummary("calibrationtest");
+}
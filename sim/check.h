@@ -0,0 +1,91 @@
+#ifndef CHECK_H
+#define CHECK_H
+
+#include "parallel.h"
+#include <math.h>
+#include <stdio.h>
+
+/*
+ * Checks for the host tests in sim/. Each test is its own program: it runs its cases, prints every check
+ * that fails with where it is, and returns checkSummary() from main, which is nonzero if anything failed.
+ */
+
+/**
+ * This is a struct which counts the checks a test has made.
+ */
+struct CheckCounts
+{
+    int checks;
+    int failures;
+};
+
+inline CheckCounts &checkCounts() {
+    static CheckCounts counts = {0, 0};
+    return counts;
+}
+
+/** checkThat
+    Counts one check and prints it if it failed
+    @return The condition, so a test can skip what depends on it
+*/
+inline bool checkThat(bool condition, const char *text, const char *file, int line) {
+    checkCounts().checks++;
+    if(!condition) {
+        checkCounts().failures++;
+        fprintf(stderr, "%s:%d: check failed: %s\n", file, line, text);
+    }
+    return condition;
+}
+
+/** checkNear
+    Counts one check that two numbers are within a tolerance, printing both if they aren't
+*/
+inline bool checkNear(double actual, double expected, double tolerance, const char *text, const char *file, int line) {
+    bool near = fabs(actual - expected) <= tolerance;
+    checkThat(near, text, file, line);
+    if(!near) {
+        fprintf(stderr, "    got %g, expected %g +/- %g\n", actual, expected, tolerance);
+    }
+    return near;
+}
+
+#define CHECK(condition) checkThat((condition), #condition, __FILE__, __LINE__)
+#define CHECK_NEAR(actual, expected, tolerance) \
+    checkNear((actual), (expected), (tolerance), #actual " near " #expected, __FILE__, __LINE__)
+
+/** checkForked
+    Runs a test case in a forked child, for tests that run the robot program, whose globals can only be set
+    up once per process. The child's checks are added to this process's, and a child that crashes counts
+    as a failed check.
+    @param name Name of the case, printed if it crashes
+    @param test Function that runs the case's checks
+*/
+template <class Function>
+void checkForked(const char *name, Function test) {
+    //The child starts with this process's counts, so only what it added comes back
+    CheckCounts before = checkCounts();
+    CheckCounts after;
+    bool finished = runForked([&](CheckCounts *result) {
+        test();
+        *result = checkCounts();
+    }, &after);
+    if(!checkThat(finished, name, __FILE__, __LINE__)) {
+        fprintf(stderr, "    %s crashed\n", name);
+        return;
+    }
+    checkCounts().checks += after.checks - before.checks;
+    checkCounts().failures += after.failures - before.failures;
+}
+
+/** checkSummary
+    Prints how many checks passed
+    @param name Name of the test
+    @return Exit status for main, 0 if every check passed
+*/
+inline int checkSummary(const char *name) {
+    const CheckCounts &counts = checkCounts();
+    printf("%s: %d checks, %d failed\n", name, counts.checks, counts.failures);
+    return counts.failures == 0 ? 0 : 1;
+}
+
+#endif
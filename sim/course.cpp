@@ -0,0 +1,108 @@
+#include "simulator.h"
+#include "../coursemap.h"
+
+//Optosensor readings over the course
+#define LOWER_FLOOR_READING 1.2
+#define UPPER_FLOOR_READING 3.6
+#define BLACK_LINE_READING 3.4
+#define YELLOW_LINE_READING 1.6
+#define LINE_WIDTH 0.75
+
+static void addWall(SimCourse &course, float x1, float y1, float x2, float y2) {
+    SimWall wall = {x1, y1, x2, y2};
+    course.walls[course.wallCount++] = wall;
+}
+
+static void addLine(SimCourse &course, float x1, float y1, float x2, float y2, float reading) {
+    SimLine line = {x1, y1, x2, y2, LINE_WIDTH, reading};
+    course.lines[course.lineCount++] = line;
+}
+
+SimConfig defaultConfig() {
+    SimConfig config = SimConfig();
+    config.seed = 1;
+
+    //Wired like robot.cpp
+    config.wiring.pins[FEHIO::P0_0] = SIM_LEFT_ENCODER;
+    config.wiring.pins[FEHIO::P0_1] = SIM_RIGHT_ENCODER;
+    config.wiring.pins[FEHIO::P1_2] = SIM_LINE_RIGHT;
+    config.wiring.pins[FEHIO::P1_4] = SIM_LINE_MIDDLE;
+    config.wiring.pins[FEHIO::P1_6] = SIM_LINE_LEFT;
+    config.wiring.pins[FEHIO::P2_0] = SIM_FRONT_LEFT_BUMP;
+    config.wiring.pins[FEHIO::P2_1] = SIM_FRONT_RIGHT_BUMP;
+    config.wiring.pins[FEHIO::P3_0] = SIM_FUEL_CDS;
+    config.wiring.pins[FEHIO::P3_1] = SIM_START_CDS;
+    config.wiring.motors[FEHMotor::Motor2] = SIM_RIGHT_WHEEL;
+    config.wiring.motors[FEHMotor::Motor3] = SIM_LEFT_WHEEL;
+    config.wiring.servos[FEHServo::Servo0] = SIM_ARM;
+
+    SimCourse &course = config.course;
+    //Walls and lines come from the robot's course map
+    for(int i = 0; i < COURSE_WALL_COUNT; i++) {
+        const MapSegment &wall = COURSE_WALLS[i];
+        addWall(course, wall.x1, wall.y1, wall.x2, wall.y2);
+    }
+    for(int i = 0; i < COURSE_LINE_COUNT; i++) {
+        const MapSegment &line = COURSE_LINES[i].segment;
+        addLine(course, line.x1, line.y1, line.x2, line.y2,
+                COURSE_LINES[i].color == YELLOW_LINE ? YELLOW_LINE_READING : BLACK_LINE_READING);
+    }
+
+    course.upperLevelY = Location::TOP_MAIN_RAMP_Y;
+    course.lowerFloorReading = LOWER_FLOOR_READING;
+    course.upperFloorReading = UPPER_FLOOR_READING;
+    course.fuelLightX = FUEL_LINE_X;
+    course.fuelLightY = Location::FUEL_LIGHT_Y;
+    course.startLightX = Location::START_X;
+    course.startLightY = Location::START_Y;
+    //The start area in the lower left corner, which the robot drives back into at the end
+    SimZone home = {0, 0, 14, 18};
+    course.home = home;
+
+    config.startX = Location::START_X;
+    config.startY = Location::START_Y;
+    config.startHeading = 45;
+    config.startDelay = 1;
+    //The operator touches the screen at the supplies and then at the drop off
+    SimTouch supplies = {Location::SUPPLIES_X, Location::SUPPLIES_Y, 270, 160, 120};
+    SimTouch dropOff = {Location::DROP_OFF_X, Location::DROP_OFF_Y, 90, 160, 120};
+    config.touches[0] = supplies;
+    config.touches[1] = dropOff;
+    config.touchCount = 2;
+
+    config.fuelLightColor = -1;
+    config.switchDirections[0] = -1;
+    config.switchDirections[1] = -1;
+    config.switchDirections[2] = -1;
+    config.courseLetter = 'A';
+
+    config.trackWidth = 6.64;
+    config.maxWheelSpeed = 36;
+    config.motorDeadband = 5;
+    config.motorTimeConstant = 0.08;
+    config.leftMotorGain = 1;
+    config.rightMotorGain = 0.97;
+    config.countsPerInch = 33.74;
+    config.servoSpeed = 300;
+
+    config.analogNoise = 0.02;
+    config.wheelSlip = 0.01;
+    config.rpsNoise = 0.05;
+    config.rpsHeadingNoise = 0.3;
+    config.rpsRate = 15;
+    config.rpsLatency = 0.1;
+    config.rpsDropoutRate = 0.01;
+    config.startPoseError = 0.1;
+
+    config.timeNowCost = 1e-6;
+    config.digitalReadCost = 2e-6;
+    config.analogReadCost = 15e-6;
+    config.rpsReadCost = 1e-6;
+    config.motorWriteCost = 5e-6;
+    config.lcdWriteCost = 1.5e-3;
+
+    config.echoLcd = true;
+    config.tracePeriod = 0;
+    config.timeLimit = 300;
+    return config;
+}
@@ -0,0 +1,304 @@
+#include <FEHLCD.h>
+#include <FEHIO.h>
+#include <FEHUtility.h>
+#include <FEHMotor.h>
+#include <FEHRPS.h>
+#include <FEHServo.h>
+#include <FEHSD.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include "simulator.h"
+
+FEHLCD LCD;
+FEHRPS RPS;
+FEHSD SD;
+
+double TimeNow() {
+    simulator().advance(simulator().getConfig().timeNowCost);
+    return simulator().now();
+}
+
+void Sleep(int msec) {
+    simulator().advance(msec / 1000.0);
+}
+
+void Sleep(float sec) {
+    simulator().advance(sec);
+}
+
+void Sleep(double sec) {
+    simulator().advance(sec);
+}
+
+void FEHLCD::Clear() {
+    simulator().lcdClear();
+}
+
+void FEHLCD::Write(const char *text) {
+    simulator().lcdWrite(text, false);
+}
+
+void FEHLCD::Write(int value) {
+    char text[16];
+    snprintf(text, sizeof(text), "%d", value);
+    simulator().lcdWrite(text, false);
+}
+
+void FEHLCD::Write(float value) {
+    char text[32];
+    snprintf(text, sizeof(text), "%.3f", value);
+    simulator().lcdWrite(text, false);
+}
+
+void FEHLCD::Write(double value) {
+    Write((float)value);
+}
+
+void FEHLCD::Write(bool value) {
+    Write((int)value);
+}
+
+void FEHLCD::Write(char value) {
+    char text[2] = {value, 0};
+    simulator().lcdWrite(text, false);
+}
+
+void FEHLCD::WriteLine(const char *text) {
+    simulator().lcdWrite(text, true);
+}
+
+void FEHLCD::WriteLine(int value) {
+    Write(value);
+    simulator().lcdWrite("", true);
+}
+
+void FEHLCD::WriteLine(float value) {
+    Write(value);
+    simulator().lcdWrite("", true);
+}
+
+void FEHLCD::WriteLine(double value) {
+    Write(value);
+    simulator().lcdWrite("", true);
+}
+
+void FEHLCD::WriteLine(bool value) {
+    Write(value);
+    simulator().lcdWrite("", true);
+}
+
+void FEHLCD::WriteLine(char value) {
+    Write(value);
+    simulator().lcdWrite("", true);
+}
+
+void FEHLCD::WriteAt(const char *text, int, int) {
+    WriteLine(text);
+}
+
+void FEHLCD::WriteAt(int value, int, int) {
+    WriteLine(value);
+}
+
+void FEHLCD::WriteAt(float value, int, int) {
+    WriteLine(value);
+}
+
+void FEHLCD::DrawRectangle(int, int, int, int) {
+    simulator().advance(simulator().getConfig().lcdWriteCost);
+}
+
+void FEHLCD::FillRectangle(int, int, int, int) {
+    simulator().advance(simulator().getConfig().lcdWriteCost);
+}
+
+void FEHLCD::SetFontColor(unsigned int) {
+}
+
+void FEHLCD::SetBackgroundColor(unsigned int) {
+}
+
+bool FEHLCD::Touch(float *x, float *y) {
+    return simulator().touch(x, y);
+}
+
+AnalogInputPin::AnalogInputPin(FEHIO::FEHIOPin pin) {
+    this->pin = pin;
+}
+
+float AnalogInputPin::Value() {
+    simulator().countRead(SIM_READ_ANALOG);
+    return simulator().analogValue(pin);
+}
+
+DigitalInputPin::DigitalInputPin(FEHIO::FEHIOPin pin) {
+    this->pin = pin;
+}
+
+bool DigitalInputPin::Value() {
+    simulator().countRead(SIM_READ_DIGITAL);
+    return simulator().digitalValue(pin);
+}
+
+DigitalEncoder::DigitalEncoder(FEHIO::FEHIOPin pin, FEHIO::FEHIOInterruptTrigger) {
+    this->pin = pin;
+}
+
+int DigitalEncoder::Counts() {
+    simulator().countRead(SIM_READ_ENCODER);
+    return simulator().encoderCounts(pin);
+}
+
+void DigitalEncoder::ResetCounts() {
+    simulator().resetEncoder(pin);
+}
+
+//The buttons named in SIM_BUTTONS (any of L, M and R) are held down for the whole run, the rest are never pressed
+static bool buttonHeld(char button) {
+    const char *held = getenv("SIM_BUTTONS");
+    return held && strchr(held, button);
+}
+
+ButtonBoard::ButtonBoard(FEHIO::FEHIOPort) {
+}
+
+bool ButtonBoard::LeftPressed() {
+    return buttonHeld('L');
+}
+
+bool ButtonBoard::LeftReleased() {
+    return !buttonHeld('L');
+}
+
+bool ButtonBoard::MiddlePressed() {
+    return buttonHeld('M');
+}
+
+bool ButtonBoard::MiddleReleased() {
+    return !buttonHeld('M');
+}
+
+bool ButtonBoard::RightPressed() {
+    return buttonHeld('R');
+}
+
+bool ButtonBoard::RightReleased() {
+    return !buttonHeld('R');
+}
+
+FEHMotor::FEHMotor(FEHMotorPort port, float maxVoltage) {
+    this->port = port;
+    this->maxVoltage = maxVoltage;
+}
+
+void FEHMotor::SetPercent(float percent) {
+    simulator().setMotor(port, percent);
+}
+
+void FEHMotor::Stop() {
+    simulator().setMotor(port, 0);
+}
+
+FEHServo::FEHServo(FEHServoPort port) {
+    this->port = port;
+}
+
+void FEHServo::SetMin(int) {
+}
+
+void FEHServo::SetMax(int) {
+}
+
+void FEHServo::SetDegree(float degree) {
+    simulator().setServo(port, degree);
+}
+
+void FEHServo::Calibrate() {
+}
+
+void FEHServo::Off() {
+}
+
+//The region is set by the simulator's course, so there is no menu to go through
+void FEHRPS::InitializeTouchMenu() {
+    simulator().advance(simulator().getConfig().lcdWriteCost);
+}
+
+float FEHRPS::X() {
+    simulator().countRead(SIM_READ_RPS);
+    return simulator().rpsX();
+}
+
+float FEHRPS::Y() {
+    simulator().countRead(SIM_READ_RPS);
+    return simulator().rpsY();
+}
+
+float FEHRPS::Heading() {
+    simulator().countRead(SIM_READ_RPS);
+    return simulator().rpsHeading();
+}
+
+char FEHRPS::CurrentCourse() {
+    return simulator().rpsCourse();
+}
+
+int FEHRPS::RedSwitchDirection() {
+    return simulator().switchDirection(0);
+}
+
+int FEHRPS::WhiteSwitchDirection() {
+    return simulator().switchDirection(1);
+}
+
+int FEHRPS::BlueSwitchDirection() {
+    return simulator().switchDirection(2);
+}
+
+struct FEHFile
+{
+    FILE *file;
+};
+
+FEHFile *FEHSD::FOpen(const char *filename, const char *mode) {
+    std::string path = filename;
+    if(getenv("SIM_SD")) {
+        path = std::string(getenv("SIM_SD")) + "/" + filename;
+    }
+    FILE *file = fopen(path.c_str(), mode);
+    if(!file) {
+        return 0;
+    }
+    FEHFile *handle = new FEHFile;
+    handle->file = file;
+    return handle;
+}
+
+int FEHSD::FClose(FEHFile *file) {
+    int result = fclose(file->file);
+    delete file;
+    return result;
+}
+
+int FEHSD::FPrintf(FEHFile *file, const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    int result = vfprintf(file->file, format, args);
+    va_end(args);
+    return result;
+}
+
+int FEHSD::FScanf(FEHFile *file, const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    int result = vfscanf(file->file, format, args);
+    va_end(args);
+    return result;
+}
+
+int FEHSD::FEof(FEHFile *file) {
+    return feof(file->file);
+}
@@ -0,0 +1,277 @@
+/**
+ * Flight recorder decoder. Reads the FLIGHT.TXT written by FlightRecorder::save() and prints the records
+ * as CSV, or as a timeline with one line per phase or primitive the robot ran.
+ *
+ *     g++ -std=c++14 -O2 -Isim sim/flightdecode.cpp sim/simulator.cpp sim/feh.cpp sim/course.cpp -o flightdecode
+ *     ./flightdecode FLIGHT.TXT > flight.csv
+ *     ./flightdecode --timeline FLIGHT.TXT
+ *     ./flightdecode --bench 1000000
+ *
+ * --bench times FlightRecorder::record() on this computer, so the cost per tick can be checked without
+ * a robot. On the robot a -DBENCHMARK build reports it as the Recorder line.
+ */
+#include "../recorder.h"
+#include "../scheduler.h"
+#include <chrono>
+#include <map>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+Bench bench;
+
+/**
+ * This is a struct which holds everything read back from a flight log.
+ */
+struct FlightLog
+{
+    unsigned long total;
+    int frozen;
+    std::map<int, std::string> names;
+    std::vector<FlightRecord> records;
+};
+
+static int hexDigit(char c) {
+    if(c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if(c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    return -1;
+}
+
+static bool readLog(const char *filename, FlightLog &log) {
+    FILE *file = fopen(filename, "r");
+    if(!file) {
+        fprintf(stderr, "Can't open %s\n", filename);
+        return false;
+    }
+    char line[256];
+    int version = 0;
+    int size = 0;
+    if(!fgets(line, sizeof(line), file) ||
+       sscanf(line, "FLIGHT %d %d", &version, &size) != 2) {
+        fprintf(stderr, "%s is not a flight log\n", filename);
+        fclose(file);
+        return false;
+    }
+    if(version != FLIGHT_RECORD_VERSION || size != (int)sizeof(FlightRecord)) {
+        fprintf(stderr, "%s is version %d with %d byte records, this decoder reads version %d with %d\n",
+                filename, version, size, FLIGHT_RECORD_VERSION, (int)sizeof(FlightRecord));
+        fclose(file);
+        return false;
+    }
+    if(sscanf(line, "FLIGHT %*d %*d %lu %d", &log.total, &log.frozen) != 2) {
+        fprintf(stderr, "%s is not a flight log\n", filename);
+        fclose(file);
+        return false;
+    }
+    bool ended = false;
+    while(fgets(line, sizeof(line), file)) {
+        line[strcspn(line, "\r\n")] = 0;
+        if(line[0] == 'P') {
+            int id;
+            char name[128];
+            if(sscanf(line, "P %d %127s", &id, name) == 2) {
+                log.names[id] = name;
+            }
+        } else if(line[0] == 'R') {
+            const char *hex = line + 2;
+            if(strlen(hex) != 2 * sizeof(FlightRecord)) {
+                fprintf(stderr, "Skipping short record %zu\n", log.records.size());
+                continue;
+            }
+            FlightRecord record;
+            unsigned char *bytes = (unsigned char *)&record;
+            bool valid = true;
+            for(unsigned int b = 0; b < sizeof(FlightRecord); b++) {
+                int high = hexDigit(hex[2 * b]);
+                int low = hexDigit(hex[2 * b + 1]);
+                valid = valid && high >= 0 && low >= 0;
+                bytes[b] = (unsigned char)(high * 16 + low);
+            }
+            if(valid) {
+                log.records.push_back(record);
+            }
+        } else if(strcmp(line, "END") == 0) {
+            ended = true;
+        }
+    }
+    fclose(file);
+    if(!ended) {
+        fprintf(stderr, "%s was cut off, decoding the %zu records that were written\n", filename,
+                log.records.size());
+    }
+    return true;
+}
+
+static std::string primitiveName(const FlightLog &log, int id) {
+    if(id == FLIGHT_NO_PRIMITIVE) {
+        return "-";
+    }
+    std::map<int, std::string>::const_iterator name = log.names.find(id);
+    return name == log.names.end() ? "primitive" + std::to_string(id) : name->second;
+}
+
+static double seconds(const FlightRecord &record) {
+    return (double)record.time / FLIGHT_TIME_SCALE;
+}
+
+static double volts(uint8_t value) {
+    return (double)value / FLIGHT_VOLTS_SCALE;
+}
+
+static void writeCsv(const FlightLog &log, FILE *out) {
+    fprintf(out, "time,primitive,left_counts,right_counts,left_percent,right_percent,left_bump,right_bump,"
+                 "line_left,line_middle,line_right,cds1,cds2,x,y,heading,channels\n");
+    for(size_t i = 0; i < log.records.size(); i++) {
+        const FlightRecord &r = log.records[i];
+        fprintf(out, "%.4f,%s,%d,%d,%d,%d,%d,%d,%.2f,%.2f,%.2f,%.2f,%.2f,",
+                seconds(r), primitiveName(log, r.primitive).c_str(), r.leftCounts, r.rightCounts,
+                r.leftPercent, r.rightPercent, (r.flags & FLIGHT_LEFT_BUMP) ? 1 : 0,
+                (r.flags & FLIGHT_RIGHT_BUMP) ? 1 : 0, volts(r.lineLeft), volts(r.lineMiddle),
+                volts(r.lineRight), volts(r.cds1), volts(r.cds2));
+        if(r.flags & FLIGHT_RPS_VALID) {
+            fprintf(out, "%.2f,%.2f,%.2f,", (double)r.x / FLIGHT_POSITION_SCALE,
+                    (double)r.y / FLIGHT_POSITION_SCALE, (double)r.heading / FLIGHT_HEADING_SCALE);
+        } else {
+            fprintf(out, ",,,");
+        }
+        fprintf(out, "%d\n", r.channels);
+    }
+}
+
+/** writeTimeline
+    Prints one line for each stretch of records taken while the same phase or primitive was innermost,
+    with its duration, how far the encoders counted and the first and last RPS pose it read
+*/
+static void writeTimeline(const FlightLog &log, FILE *out) {
+    if(log.records.size() < log.total) {
+        fprintf(out, "%lu records made, the first %lu were overwritten\n", log.total,
+                (unsigned long)(log.total - log.records.size()));
+    }
+    if(log.frozen && !log.records.empty()) {
+        const FlightRecord &last = log.records.back();
+        fprintf(out, "Recording stopped when %s failed at %.3f s\n", primitiveName(log, last.primitive).c_str(),
+                seconds(last));
+    }
+    fprintf(out, "%9s %9s %8s %7s  %-24s %6s %6s %5s  %-21s %-21s\n", "start", "end", "seconds", "records",
+            "primitive", "left", "right", "bumps", "rps start", "rps end");
+    size_t first = 0;
+    while(first < log.records.size()) {
+        size_t last = first;
+        int bumps = 0;
+        while(last + 1 < log.records.size() && log.records[last + 1].primitive == log.records[first].primitive) {
+            last++;
+        }
+        int lastFlags = 0;
+        const FlightRecord *rpsStart = 0;
+        const FlightRecord *rpsEnd = 0;
+        for(size_t i = first; i <= last; i++) {
+            const FlightRecord &r = log.records[i];
+            int pressed = r.flags & (FLIGHT_LEFT_BUMP | FLIGHT_RIGHT_BUMP);
+            if(pressed & ~lastFlags) {
+                bumps++;
+            }
+            lastFlags = pressed;
+            if((r.flags & FLIGHT_RPS_VALID) && (r.channels & SENSE_RPS)) {
+                if(!rpsStart) {
+                    rpsStart = &r;
+                }
+                rpsEnd = &r;
+            }
+        }
+        const FlightRecord &start = log.records[first];
+        const FlightRecord &end = log.records[last];
+        char poses[2][32] = {"-", "-"};
+        const FlightRecord *ends[2] = {rpsStart, rpsEnd};
+        for(int p = 0; p < 2; p++) {
+            if(ends[p]) {
+                snprintf(poses[p], sizeof(poses[p]), "%.1f,%.1f@%.0f", (double)ends[p]->x / FLIGHT_POSITION_SCALE,
+                         (double)ends[p]->y / FLIGHT_POSITION_SCALE, (double)ends[p]->heading / FLIGHT_HEADING_SCALE);
+            }
+        }
+        fprintf(out, "%9.3f %9.3f %8.3f %7zu  %-24s %6d %6d %5d  %-21s %-21s\n", seconds(start), seconds(end),
+                seconds(end) - seconds(start), last - first + 1, primitiveName(log, start.primitive).c_str(),
+                end.leftCounts, end.rightCounts, bumps, poses[0], poses[1]);
+        first = last + 1;
+    }
+}
+
+/** benchRecord
+    Times FlightRecorder::record() against a frame that changes every tick
+*/
+static void benchRecord(long ticks) {
+    DigitalEncoder leftEncoder(FEHIO::P0_0), rightEncoder(FEHIO::P0_1);
+    DigitalInputPin leftBump(FEHIO::P2_0), rightBump(FEHIO::P2_1);
+    AnalogInputPin lineLeft(FEHIO::P1_6), lineMiddle(FEHIO::P1_4), lineRight(FEHIO::P1_2);
+    AnalogInputPin cds1(FEHIO::P3_0), cds2(FEHIO::P3_1);
+    SensorBank sensors(leftEncoder, rightEncoder, leftBump, rightBump, lineLeft, lineMiddle, lineRight,
+                       cds1, cds2);
+    DriveMotor leftMotor(FEHMotor::Motor3, 12.0), rightMotor(FEHMotor::Motor2, 12.0);
+    static FlightRecorder recorder(sensors, leftMotor, rightMotor);
+    SensorFrame &frame = const_cast<SensorFrame &>(sensors.frame());
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for(long i = 0; i < ticks; i++) {
+        frame.leftCounts = (int)(i & 1023);
+        frame.lineMiddle = (float)(i & 255) / 64;
+        frame.x = (float)(i & 4095) / 128;
+        recorder.record(i * CONTROL_PERIOD);
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("%ld records in %.3f ms, %.1f ns per record, %lu bytes held\n", ticks, elapsed * 1000,
+           elapsed * 1e9 / ticks, (unsigned long)sizeof(FlightRecorder));
+}
+
+static void usage() {
+    fprintf(stderr, "Usage: flightdecode [--timeline] [--out FILE] FLIGHT.TXT\n"
+                    "       flightdecode --bench TICKS\n");
+}
+
+int main(int argc, char **argv) {
+    bool timeline = false;
+    const char *input = 0;
+    const char *output = 0;
+    for(int i = 1; i < argc; i++) {
+        if(strcmp(argv[i], "--timeline") == 0) {
+            timeline = true;
+        } else if(strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            output = argv[++i];
+        } else if(strcmp(argv[i], "--bench") == 0 && i + 1 < argc) {
+            benchRecord(atol(argv[++i]));
+            return 0;
+        } else if(argv[i][0] != '-' && !input) {
+            input = argv[i];
+        } else {
+            usage();
+            return 2;
+        }
+    }
+    if(!input) {
+        usage();
+        return 2;
+    }
+
+    FlightLog log;
+    if(!readLog(input, log)) {
+        return 1;
+    }
+    FILE *out = output ? fopen(output, "w") : stdout;
+    if(!out) {
+        fprintf(stderr, "Can't write %s\n", output);
+        return 1;
+    }
+    if(timeline) {
+        writeTimeline(log, out);
+    } else {
+        writeCsv(log, out);
+    }
+    if(out != stdout) {
+        fclose(out);
+    }
+    return 0;
+}
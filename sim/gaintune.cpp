@@ -0,0 +1,256 @@
+/**
+ * Drive-straight gain tuner. Drives the simulator's drive base straight at each speed band in gains.h
+ * with the same PI on the wheel difference the move primitives use, searches for the gains that keep the
+ * robot's heading from drifting and the wheels together soonest, and prints the schedule in the form of
+ * gains.h's table.
+ *
+ *     g++ -std=c++14 -O2 -Isim sim/gaintune.cpp sim/simulator.cpp sim/feh.cpp sim/course.cpp -o gaintune
+ *     ./gaintune
+ *     ./gaintune --relay
+ *     ./gaintune --seeds 5 --time 3 --save
+ *
+ * --relay runs the relay test the robot does with tuneDriveGains() instead, to compare what it finds with
+ * the searched gains. --save writes the schedule to GAINS.TXT for the robot to load, like the robot's own
+ * tuning run does. That is how a simulated schedule gets tried on the robot; gains.h keeps the hand-tuned
+ * gains until one has been.
+ */
+#include "../gains.h"
+#include "../scheduler.h"
+#include "simulator.h"
+#include <FEHIO.h>
+#include <FEHMotor.h>
+#include <FEHUtility.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+Bench bench;
+
+//The wheels count as together once the difference stays within this many counts
+#define TUNE_SETTLE_COUNTS 3
+//Degrees of heading drift worth one second of settling
+#define TUNE_SETTLE_WEIGHT 10
+//Coarse search range and step, then a finer search around the best with steps this many times smaller
+#define TUNE_KP_MAX 0.6
+#define TUNE_KP_STEP 0.02
+#define TUNE_KI_MAX 0.03
+#define TUNE_KI_STEP 0.001
+#define TUNE_REFINE 5
+
+FEHMotor leftMotor(FEHMotor::Motor3, 12.0);
+FEHMotor rightMotor(FEHMotor::Motor2, 12.0);
+DigitalEncoder leftEncoder(FEHIO::P0_0);
+DigitalEncoder rightEncoder(FEHIO::P0_1);
+
+struct TuneOptions
+{
+    int seeds;
+    float time;
+    bool relay;
+    bool save;
+};
+
+/**
+ * This is a struct which holds how one straight drive went.
+ */
+struct DriveScore
+{
+    //Heading the robot ended up off from where it started (in degrees)
+    float drift;
+    //Time until the wheel difference stayed within TUNE_SETTLE_COUNTS (in seconds)
+    float settle;
+};
+
+static void startRun(unsigned int seed) {
+    SimConfig config = defaultConfig();
+    config.seed = seed;
+    //An empty floor, so nothing stops the robot however far it goes
+    config.course.wallCount = 0;
+    config.touchCount = 0;
+    config.startX = 0;
+    config.startY = 0;
+    config.startHeading = 90;
+    config.startPoseError = 0;
+    config.echoLcd = false;
+    config.tracePeriod = 0;
+    simulator().reset(config);
+    leftEncoder.ResetCounts();
+    rightEncoder.ResetCounts();
+}
+
+static float headingDrift() {
+    float drift = simulator().getState().heading - 90;
+    while(drift > 180) {
+        drift -= 360;
+    }
+    while(drift < -180) {
+        drift += 360;
+    }
+    return fabs(drift);
+}
+
+/** driveStraight
+    Drives straight from a standstill with the move primitives' PI for a while
+    @return How far the heading drifted and how long the wheels took to come together
+*/
+static DriveScore driveStraight(float percent, float kp, float ki, float time, unsigned int seed) {
+    startRun(seed);
+    double start = TimeNow();
+    double next = start;
+    double accum = 0;
+    double lastOff = 0;
+    leftMotor.SetPercent(percent);
+    rightMotor.SetPercent(percent);
+    while(next - start < time) {
+        double error = leftEncoder.Counts() - rightEncoder.Counts();
+        accum += error;
+        rightMotor.SetPercent(percent + kp * error + ki * accum);
+        if(fabs(error) > TUNE_SETTLE_COUNTS) {
+            lastOff = next - start;
+        }
+        next += CONTROL_PERIOD;
+        double now = TimeNow();
+        if(next > now) {
+            Sleep(next - now);
+        }
+    }
+    leftMotor.Stop();
+    rightMotor.Stop();
+    DriveScore score = {headingDrift(), (float)lastOff};
+    return score;
+}
+
+static float cost(float percent, float kp, float ki, const TuneOptions &options, DriveScore *mean = 0) {
+    DriveScore total = {0, 0};
+    for(int s = 0; s < options.seeds; s++) {
+        DriveScore score = driveStraight(percent, kp, ki, options.time, s + 1);
+        total.drift += score.drift;
+        total.settle += score.settle;
+    }
+    total.drift /= options.seeds;
+    total.settle /= options.seeds;
+    if(mean) {
+        *mean = total;
+    }
+    return total.drift + TUNE_SETTLE_WEIGHT * total.settle;
+}
+
+/** search
+    Tries every kp and ki on a grid and keeps the cheapest
+*/
+static void search(float percent, float kpLow, float kpHigh, float kpStep, float kiLow, float kiHigh, float kiStep,
+                   const TuneOptions &options, DriveGains &best, float &bestCost) {
+    for(float kp = kpLow; kp <= kpHigh + kpStep / 2; kp += kpStep) {
+        for(float ki = kiLow; ki <= kiHigh + kiStep / 2; ki += kiStep) {
+            if(kp < 0 || ki < 0) {
+                continue;
+            }
+            float c = cost(percent, kp, ki, options);
+            if(c < bestCost) {
+                bestCost = c;
+                best.kp = kp;
+                best.ki = ki;
+            }
+        }
+    }
+}
+
+static DriveGains optimize(float percent, const TuneOptions &options) {
+    DriveGains best = {percent, 0, 0};
+    float bestCost = cost(percent, 0, 0, options);
+    search(percent, 0, TUNE_KP_MAX, TUNE_KP_STEP, 0, TUNE_KI_MAX, TUNE_KI_STEP, options, best, bestCost);
+    float kpStep = TUNE_KP_STEP / TUNE_REFINE;
+    float kiStep = TUNE_KI_STEP / TUNE_REFINE;
+    search(percent, best.kp - TUNE_KP_STEP, best.kp + TUNE_KP_STEP, kpStep,
+           best.ki - TUNE_KI_STEP, best.ki + TUNE_KI_STEP, kiStep, options, best, bestCost);
+    return best;
+}
+
+/** relayTest
+    Runs the robot's relay test on the simulated drive base, in legs of RELAY_DISTANCE like tuneDriveGains()
+*/
+static DriveGains relayTest(float percent, RelayTuner &tuner) {
+    float counts = RELAY_DISTANCE * simulator().getConfig().countsPerInch;
+    for(int leg = 0; leg < RELAY_LEGS && !tuner.done(); leg++) {
+        startRun(leg + 1);
+        tuner.resume();
+        double next = TimeNow();
+        leftMotor.SetPercent(percent);
+        rightMotor.SetPercent(percent);
+        while(!tuner.done() && (leftEncoder.Counts() + rightEncoder.Counts()) / 2. < counts) {
+            double now = TimeNow();
+            rightMotor.SetPercent(percent + tuner.output(leftEncoder.Counts() - rightEncoder.Counts(), now));
+            next += CONTROL_PERIOD;
+            now = TimeNow();
+            if(next > now) {
+                Sleep(next - now);
+            }
+        }
+        leftMotor.Stop();
+        rightMotor.Stop();
+    }
+    return tuner.gains(percent, CONTROL_PERIOD);
+}
+
+static bool parseOptions(int argc, char **argv, TuneOptions &options) {
+    options.seeds = 3;
+    options.time = 2;
+    options.relay = false;
+    options.save = false;
+    for(int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if(!strcmp(arg, "--seeds") && hasValue) {
+            options.seeds = atoi(argv[++i]);
+        }
+        else if(!strcmp(arg, "--time") && hasValue) {
+            options.time = atof(argv[++i]);
+        }
+        else if(!strcmp(arg, "--relay")) {
+            options.relay = true;
+        }
+        else if(!strcmp(arg, "--save")) {
+            options.save = true;
+        }
+        else {
+            fprintf(stderr, "usage: %s [--seeds N] [--time SECONDS] [--relay] [--save]\n", argv[0]);
+            return false;
+        }
+    }
+    return options.seeds > 0 && options.time > 0;
+}
+
+int main(int argc, char **argv) {
+    TuneOptions options;
+    if(!parseOptions(argc, argv, options)) {
+        return 1;
+    }
+    GainSchedule schedule;
+    printf("static const DriveGains DEFAULT_DRIVE_GAINS[] = {\n");
+    for(int i = 0; i < DEFAULT_DRIVE_GAIN_COUNT; i++) {
+        float percent = DEFAULT_DRIVE_GAINS[i].percent;
+        DriveGains gains;
+        DriveScore score;
+        if(options.relay) {
+            RelayTuner tuner;
+            gains = relayTest(percent, tuner);
+            fprintf(stderr, "%3.0f%%: Ku %.3f Tu %.3f s\n", percent, tuner.ultimateGain(), tuner.ultimatePeriod());
+        }
+        else {
+            gains = optimize(percent, options);
+        }
+        cost(percent, gains.kp, gains.ki, options, &score);
+        DriveScore untuned;
+        cost(percent, DEFAULT_DRIVE_GAINS[i].kp, DEFAULT_DRIVE_GAINS[i].ki, options, &untuned);
+        fprintf(stderr, "%3.0f%%: drift %.2f deg, settle %.3f s (current gains %.2f deg, %.3f s)\n",
+                percent, score.drift, score.settle, untuned.drift, untuned.settle);
+        printf("    {%g, %.3f, %.4f}%s\n", percent, gains.kp, gains.ki, i + 1 < DEFAULT_DRIVE_GAIN_COUNT ? "," : "");
+        schedule.set(percent, gains.kp, gains.ki);
+    }
+    printf("};\n");
+    if(options.save && !GainSchedule::save(schedule)) {
+        fprintf(stderr, "Can't write %s\n", GAINS_FILE);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,138 @@
+/**
+ * Geometry microbenchmark. Times the heading and trig helpers in geometry.h on this computer next to the
+ * libm functions they replace, and sweeps each one over its whole input range for its largest error
+ * against libm. The timings are only a comparison, the robot's processor is far slower, but the errors
+ * are the same anywhere.
+ *
+ *     g++ -std=c++14 -O2 sim/geometrybench.cpp -o geometrybench
+ *     ./geometrybench
+ *     ./geometrybench --calls 10000000
+ */
+#include "../geometry.h"
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const double DEGREES = 180 / 3.14159265358979323846;
+static const double RADIANS = 1 / DEGREES;
+//Inputs the error sweeps try across each function's range
+#define SWEEP_STEPS 1000000
+//Different inputs the timing loops go round, so the tables and branches aren't always hit the same way
+#define INPUT_COUNT 4096
+
+constexpr SineTable<32> smallTable;
+constexpr SineTable<128> largeTable;
+
+static float inputs[INPUT_COUNT];
+static float otherInputs[INPUT_COUNT];
+//Results are added up into this so the compiler can't leave out the calls being timed
+static volatile float sink;
+
+/** timeCalls
+    Calls a function of one or two floats over the inputs
+    @return Time per call (in nanoseconds)
+*/
+template <typename Function>
+static double timeCalls(long calls, Function function) {
+    float sum = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for(long i = 0; i < calls; i++) {
+        int n = (int)(i & (INPUT_COUNT - 1));
+        sum += function(inputs[n], otherInputs[n]);
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    sink = sum;
+    return elapsed * 1e9 / calls;
+}
+
+/** headingError
+    @return Largest difference between fastAtan2 and atan2 all the way round a circle (in degrees)
+*/
+static double headingError() {
+    double worst = 0;
+    for(int i = 0; i < SWEEP_STEPS; i++) {
+        double angle = i * 360.0 / SWEEP_STEPS;
+        float x = (float)cos(angle * RADIANS);
+        float y = (float)sin(angle * RADIANS);
+        double exact = atan2((double)y, (double)x) * DEGREES;
+        if(exact < 0) {
+            exact += 360;
+        }
+        double error = fabs(wrapDegrees((float)(fastAtan2(y, x) - exact)));
+        worst = error > worst ? error : worst;
+    }
+    return worst;
+}
+
+/** sineError
+    @return Largest difference between a table's sine or cosine and libm's from -720 to 720 degrees
+*/
+template <int N>
+static double sineError(const SineTable<N> &table) {
+    double worst = 0;
+    for(int i = 0; i < SWEEP_STEPS; i++) {
+        float degrees = -720 + i * 1440.0f / SWEEP_STEPS;
+        double sineError = fabs(table.sine(degrees) - sin(degrees * RADIANS));
+        double cosineError = fabs(table.cosine(degrees) - cos(degrees * RADIANS));
+        worst = sineError > worst ? sineError : worst;
+        worst = cosineError > worst ? cosineError : worst;
+    }
+    return worst;
+}
+
+/** differenceError
+    @return Largest difference between angleDifference and the same angle worked out with fmod (in degrees)
+*/
+static double differenceError() {
+    double worst = 0;
+    for(int i = 0; i < SWEEP_STEPS; i++) {
+        float target = i * 360.0f / SWEEP_STEPS;
+        float current = fmodf(target * 7.31f, 360);
+        double exact = fmod((double)target - current + 540, 360) - 180;
+        double error = fabs(wrapDegrees((float)(angleDifference(target, current) - exact)));
+        worst = error > worst ? error : worst;
+    }
+    return worst;
+}
+
+int main(int argc, char **argv) {
+    long calls = 20000000;
+    for(int i = 1; i < argc; i++) {
+        if(strcmp(argv[i], "--calls") == 0 && i + 1 < argc) {
+            calls = atol(argv[++i]);
+        }
+        else {
+            fprintf(stderr, "Usage: geometrybench [--calls N]\n");
+            return 2;
+        }
+    }
+    srand(1);
+    for(int i = 0; i < INPUT_COUNT; i++) {
+        inputs[i] = rand() * 720.0f / RAND_MAX - 360;
+        otherInputs[i] = rand() * 720.0f / RAND_MAX - 360;
+    }
+
+    printf("function              ns/call  max error\n");
+    printf("%-20s  %7.2f  %9.6f deg\n", "fastAtan2",
+           timeCalls(calls, [](float y, float x) { return fastAtan2(y, x); }), headingError());
+    printf("%-20s  %7.2f\n", "atan2f",
+           timeCalls(calls, [](float y, float x) { return atan2f(y, x) * (float)DEGREES; }));
+    printf("%-20s  %7.2f  %9.6f deg\n", "angleDifference",
+           timeCalls(calls, [](float a, float b) { return angleDifference(normalizeDegrees(a), normalizeDegrees(b)); }),
+           differenceError());
+    printf("%-20s  %7.2f  %9.6f\n", "sinDegrees",
+           timeCalls(calls, [](float a, float) { return sinDegrees(a); }), sineError(trigTable));
+    printf("%-20s  %7.2f  %9.6f\n", "cosDegrees",
+           timeCalls(calls, [](float a, float) { return cosDegrees(a); }), sineError(trigTable));
+    printf("%-20s  %7.2f\n", "sinf",
+           timeCalls(calls, [](float a, float) { return sinf(a * (float)RADIANS); }));
+    printf("%-20s  %7.2f  %9.6f\n", "SineTable<32>",
+           timeCalls(calls, [](float a, float) { return smallTable.sine(a); }), sineError(smallTable));
+    printf("%-20s  %7.2f  %9.6f\n", "SineTable<128>",
+           timeCalls(calls, [](float a, float) { return largeTable.sine(a); }), sineError(largeTable));
+    printf("%-20s  %7.2f\n", "distanceBetween",
+           timeCalls(calls, [](float a, float b) { return distanceBetween(0, 0, a, b); }));
+    return 0;
+}
@@ -0,0 +1,125 @@
+/**
+ * Line follower tests. Feeds LineFollower every combination of readings below, at and above ON_LINE on
+ * the three optosensors, for both line colors, and checks it steers the way the if-else chains in the
+ * original followLine() and followLineYellow() did for the same readings.
+ *
+ *     g++ -std=c++14 -O2 sim/linefollowertest.cpp -o linefollowertest
+ *     ./linefollowertest
+ */
+#include "../linefollower.h"
+#include "check.h"
+#include <string.h>
+
+//Readings that truncate to below, exactly and above ON_LINE, and the ends of the sensor range
+static const float READINGS[] = {0.2, ON_LINE - 0.5, ON_LINE + 0.5, ON_LINE + 1.5, 4.9};
+static const int READING_COUNT = sizeof(READINGS) / sizeof(READINGS[0]);
+
+enum OldState
+{
+    CENTER,
+    LEFT,
+    FAR_LEFT,
+    RIGHT,
+    FAR_RIGHT,
+    OFF_LINE
+};
+
+static const char *STATE_NAMES[] = {"CENTER", "LEFT", "FAR LEFT", "RIGHT", "FAR RIGHT", "OFFLINE"};
+//Wheel speeds the old followers set in each state, as fractions of the follow speed
+static const float BLACK_SPEEDS[][2] = {{1, 1}, {1, .75}, {1, .5}, {.75, 1}, {.5, 1}, {1, 1}};
+static const float YELLOW_SPEEDS[][2] = {{1, 1}, {1, .5}, {1, .25}, {.5, 1}, {.25, 1}, {1, 1}};
+
+/** oldBlackState
+    The state followLine() picked, copied from it
+*/
+static OldState oldBlackState(int leftValue, int midValue, int rightValue) {
+    if(midValue >= ON_LINE && rightValue <= ON_LINE && leftValue <= ON_LINE) {
+        return CENTER;
+    }
+    else if(midValue >= ON_LINE && rightValue >= ON_LINE && leftValue <= ON_LINE) {
+        return LEFT;
+    }
+    else if(midValue <= ON_LINE && rightValue >= ON_LINE && leftValue <= ON_LINE) {
+        return FAR_LEFT;
+    }
+    else if(midValue >= ON_LINE && rightValue <= ON_LINE && leftValue >= ON_LINE) {
+        return RIGHT;
+    }
+    else if(midValue <= ON_LINE && rightValue <= ON_LINE && leftValue >= ON_LINE) {
+        return FAR_RIGHT;
+    }
+    return OFF_LINE;
+}
+
+/** oldYellowState
+    The state followLineYellow() and followLineYellowSquare() picked, copied from them
+*/
+static OldState oldYellowState(int leftValue, int midValue, int rightValue) {
+    if(midValue <= ON_LINE && rightValue >= ON_LINE && leftValue >= ON_LINE) {
+        return CENTER;
+    }
+    else if(midValue <= ON_LINE && rightValue <= ON_LINE && leftValue >= ON_LINE) {
+        return LEFT;
+    }
+    else if(midValue >= ON_LINE && rightValue <= ON_LINE && leftValue >= ON_LINE) {
+        return FAR_LEFT;
+    }
+    else if(midValue <= ON_LINE && rightValue >= ON_LINE && leftValue <= ON_LINE) {
+        return RIGHT;
+    }
+    else if(midValue >= ON_LINE && rightValue >= ON_LINE && leftValue <= ON_LINE) {
+        return FAR_RIGHT;
+    }
+    return OFF_LINE;
+}
+
+static void testColor(LineColor color) {
+    LineFollower follower(color);
+    const float (*speeds)[2] = color == YELLOW_LINE ? YELLOW_SPEEDS : BLACK_SPEEDS;
+    int mismatches = 0;
+    for(int l = 0; l < READING_COUNT; l++) {
+        for(int m = 0; m < READING_COUNT; m++) {
+            for(int r = 0; r < READING_COUNT; r++) {
+                float left = READINGS[l], middle = READINGS[m], right = READINGS[r];
+                //The old followers stored the readings in ints
+                OldState state = color == YELLOW_LINE ? oldYellowState((int)left, (int)middle, (int)right)
+                                                      : oldBlackState((int)left, (int)middle, (int)right);
+                const LineSteering &steering = follower.steer(left, middle, right);
+                bool same = strcmp(steering.name, STATE_NAMES[state]) == 0 && steering.left == speeds[state][0] &&
+                            steering.right == speeds[state][1];
+                if(!CHECK(same)) {
+                    fprintf(stderr, "    %s line, readings %.1f %.1f %.1f: got %s, expected %s\n",
+                            color == YELLOW_LINE ? "yellow" : "black", left, middle, right, steering.name,
+                            STATE_NAMES[state]);
+                    mismatches++;
+                }
+            }
+        }
+    }
+    CHECK(mismatches == 0);
+}
+
+static void testAmbiguous() {
+    LineFollower black(BLACK_LINE);
+    //A middle and right reading of exactly ON_LINE fit the center pattern first
+    CHECK(strcmp(black.steer(ON_LINE - 1, ON_LINE, ON_LINE).name, "CENTER") == 0);
+    CHECK(black.pattern(ON_LINE - 1, ON_LINE, ON_LINE) == 2);
+    CHECK(black.pattern(ON_LINE - 1, ON_LINE + 1, ON_LINE + 1) == 3);
+    //Every sensor at ON_LINE fits center too
+    CHECK(black.pattern(ON_LINE, ON_LINE, ON_LINE) == 2);
+    //Nothing on the line, or the line under both sides, fits no position
+    CHECK(black.pattern(0, 0, 0) == 0);
+    CHECK(black.pattern(ON_LINE + 1, ON_LINE - 1, ON_LINE + 1) == 0);
+
+    LineFollower yellow(YELLOW_LINE);
+    CHECK(strcmp(yellow.steer(ON_LINE + 1, ON_LINE, ON_LINE).name, "CENTER") == 0);
+    CHECK(yellow.pattern(ON_LINE + 1, ON_LINE - 1, ON_LINE - 1) == 3);
+    CHECK(yellow.pattern(4.9, 4.9, 4.9) == 0);
+}
+
+int main() {
+    testColor(BLACK_LINE);
+    testColor(YELLOW_LINE);
+    testAmbiguous();
+    return checkSummary("linefollowertest");
+}
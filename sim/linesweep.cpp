@@ -0,0 +1,164 @@
+/**
+ * Line follower speed sweep. Follows a long straight black line on an otherwise empty simulated floor at
+ * a range of speeds, with both the steering table (followLine) and the proportional tracker
+ * (followLineTracking), starting a little off the line and turned away from it, and prints how far the
+ * robot strayed from the line at each speed.
+ *
+ * The robot program is compiled in the same way as the benchmark's, and every follow is a forked child
+ * so the robot program's globals start fresh each time:
+ *
+ *     g++ -std=c++14 -O2 -Isim sim/linesweep.cpp sim/simulator.cpp sim/feh.cpp sim/course.cpp -o linesweep
+ *     ./linesweep
+ *     ./linesweep --seeds 10 --speeds 20:90:5 --noise 2
+ *
+ * The cross-track error is the distance of the middle of the axle from the line, once the robot has gone
+ * LINE_SETTLE_DISTANCE along it so the start offset has been taken out. The output of the default run is
+ * kept in sim/linesweep.txt.
+ */
+#define BENCHMARK
+#define main robot_main
+#include "../robot.cpp"
+#undef main
+
+#include "simulator.h"
+#include "parallel.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//The line runs along x = LINE_X from y = LINE_START_Y to LINE_END_Y (in inches)
+#define LINE_X 12
+#define LINE_START_Y 4
+#define LINE_END_Y 96
+//Where the robot starts, off to the side of the line and turned away from it
+#define START_OFFSET 0.4
+#define START_TURN 5
+//How far the robot follows the line, and how far it goes before the error counts (in inches)
+#define FOLLOW_DISTANCE 60
+#define LINE_SETTLE_DISTANCE 12
+//Longest a follow may take (in seconds)
+#define FOLLOW_TIMEOUT 30
+
+/**
+ * This is a struct which a child sends back after one follow.
+ */
+struct LineRun
+{
+    bool completed;
+    double time;
+    double squaredError;
+    double maxError;
+    long samples;
+};
+
+/**
+ * This is a struct which holds what the tracking task needs between ticks.
+ */
+struct Tracking
+{
+    float startY;
+    LineRun *run;
+};
+
+/** trackError
+    Control loop task that adds up the robot's distance from the line once it has settled
+*/
+static void trackError(void *data, double) {
+    Tracking *tracking = (Tracking *)data;
+    const SimState &state = simulator().getState();
+    if(state.y - tracking->startY < LINE_SETTLE_DISTANCE) {
+        return;
+    }
+    double error = fabs(state.x - LINE_X);
+    tracking->run->squaredError += error * error;
+    tracking->run->maxError = error > tracking->run->maxError ? error : tracking->run->maxError;
+    tracking->run->samples++;
+}
+
+static void follow(bool proportional, float speed, unsigned int seed, float noise, LineRun *run) {
+    SimConfig config = defaultConfig();
+    config.seed = seed;
+    config.echoLcd = false;
+    config.tracePeriod = 0;
+    config.touchCount = 0;
+    config.analogNoise *= noise;
+    config.wheelSlip *= noise;
+    SimCourse &course = config.course;
+    course.wallCount = 0;
+    course.deadZoneCount = 0;
+    //Painted like the course's black lines, which defaultConfig() adds in course map order
+    SimLine line = course.lines[0];
+    for(int i = 0; i < COURSE_LINE_COUNT; i++) {
+        if(COURSE_LINES[i].color == BLACK_LINE) {
+            line = course.lines[i];
+            break;
+        }
+    }
+    line.x1 = line.x2 = LINE_X;
+    line.y1 = LINE_START_Y;
+    line.y2 = LINE_END_Y;
+    course.lineCount = 1;
+    course.lines[0] = line;
+    //All lower floor
+    course.upperLevelY = LINE_END_Y * 2;
+    config.startX = LINE_X + START_OFFSET;
+    config.startY = LINE_START_Y + 2;
+    config.startHeading = 90 + START_TURN;
+    simulator().reset(config);
+
+    Tracking tracking = {config.startY, run};
+    initialize();
+    controlLoop.addTask(trackError, &tracking);
+    double start = TimeNow();
+    LineFollowOptions options = {BLACK_LINE, FOLLOW_TIMEOUT, false, false, 0, 0, true, proportional};
+    run->completed = followLineWith(speed, FOLLOW_DISTANCE, options).completed;
+    run->time = TimeNow() - start;
+}
+
+int main(int argc, char **argv) {
+    int seeds = 5;
+    float lowSpeed = 20, highSpeed = 90, speedStep = 10;
+    float noise = 1;
+    for(int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if(strcmp(argv[i], "--seeds") == 0 && hasValue) {
+            seeds = atoi(argv[++i]);
+        }
+        else if(strcmp(argv[i], "--speeds") == 0 && hasValue) {
+            if(sscanf(argv[++i], "%f:%f:%f", &lowSpeed, &highSpeed, &speedStep) != 3 || speedStep <= 0) {
+                fprintf(stderr, "--speeds wants LOW:HIGH:STEP\n");
+                return 2;
+            }
+        }
+        else if(strcmp(argv[i], "--noise") == 0 && hasValue) {
+            noise = atof(argv[++i]);
+        }
+        else {
+            fprintf(stderr, "Usage: linesweep [--seeds N] [--speeds LOW:HIGH:STEP] [--noise SCALE]\n");
+            return 2;
+        }
+    }
+
+    printf("steering      speed  completed  time s  rms error in  max error in\n");
+    for(int proportional = 0; proportional <= 1; proportional++) {
+        for(float speed = lowSpeed; speed <= highSpeed + 1e-3; speed += speedStep) {
+            LineRun total = {false, 0, 0, 0, 0};
+            int completed = 0;
+            for(int seed = 1; seed <= seeds; seed++) {
+                LineRun run;
+                if(!runForked([&](LineRun *result) { follow(proportional, speed, seed, noise, result); }, &run)) {
+                    continue;
+                }
+                completed += run.completed;
+                total.time += run.time;
+                total.squaredError += run.squaredError;
+                total.samples += run.samples;
+                total.maxError = run.maxError > total.maxError ? run.maxError : total.maxError;
+            }
+            printf("%-12s  %5.0f  %6d/%-2d  %6.2f  %12.3f  %12.3f\n", proportional ? "proportional" : "table", speed,
+                   completed, seeds, total.time / seeds,
+                   total.samples > 0 ? sqrt(total.squaredError / total.samples) : 0, total.maxError);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,120 @@
+/**
+ * Logging benchmark. Runs a control loop on the simulator that reads the sensors every tick like a drive
+ * primitive does, once without logging and then with each way the robot code can log from inside the
+ * loop, and prints how many ticks ran, how many overran and how late they were, and how many messages
+ * were dropped. The simulator charges LCD writes their time on the robot, so this shows what logging
+ * costs the loop without a robot.
+ *
+ *     g++ -std=c++14 -O2 -Isim sim/logbench.cpp sim/simulator.cpp sim/feh.cpp sim/course.cpp -o logbench
+ *     ./logbench
+ *     ./logbench --seconds 30
+ */
+//Compile the debug messages in, so they can be measured
+#define LOG_LEVEL LOG_LEVEL_DEBUG
+#include "../logger.h"
+#include "../scheduler.h"
+#include "../sensors.h"
+#include "simulator.h"
+#include <FEHIO.h>
+#include <FEHLCD.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+Bench bench;
+
+//Shortest time between two rate limited messages (in seconds), the same as robot.cpp's LOOP_LOG_INTERVAL
+#define BENCH_LOG_INTERVAL 0.5
+
+enum LogMode
+{
+    LOG_NONE,
+    LOG_EVERY_TICK,
+    LOG_RATE_LIMITED,
+    LOG_TO_LCD
+};
+
+static const char *MODE_NAMES[] = {"none", "queued every tick", "queued, rate limited", "LCD every tick"};
+static const int MODE_COUNT = sizeof(MODE_NAMES) / sizeof(MODE_NAMES[0]);
+
+DigitalEncoder leftEncoder(FEHIO::P0_0), rightEncoder(FEHIO::P0_1);
+DigitalInputPin leftBump(FEHIO::P2_0), rightBump(FEHIO::P2_1);
+AnalogInputPin lineLeft(FEHIO::P1_6), lineMiddle(FEHIO::P1_4), lineRight(FEHIO::P1_2);
+AnalogInputPin cds1(FEHIO::P3_0), cds2(FEHIO::P3_1);
+SensorBank sensors(leftEncoder, rightEncoder, leftBump, rightBump, lineLeft, lineMiddle, lineRight, cds1, cds2);
+
+/**
+ * This is a struct which holds what one run of the loop did.
+ */
+struct LogResult
+{
+    unsigned long ticks;
+    unsigned long overruns;
+    double maxJitter;
+    double meanJitter;
+    unsigned long dropped;
+};
+
+/** runLoop
+    Runs the loop for a while, logging the bump switches the way the mode says
+*/
+static LogResult runLoop(LogMode mode, double seconds) {
+    SimConfig config = defaultConfig();
+    config.echoLcd = false;
+    config.tracePeriod = 0;
+    simulator().reset(config);
+
+    Logger logger;
+    ControlLoop loop;
+    loop.setIdleTask(Logger::idle, &logger);
+    loop.addTask(SensorBank::update, &sensors);
+    sensors.setChannels(SENSE_ENCODERS | SENSE_BUMPS | SENSE_LINE);
+    const SensorFrame &frame = sensors.frame();
+
+    double start = TimeNow();
+    loop.run([&](double now) {
+        if(mode == LOG_EVERY_TICK) {
+            LOG_DEBUG("Left bump: ", (int)frame.leftBump);
+            LOG_DEBUG("Right bump: ", (int)frame.rightBump);
+        }
+        else if(mode == LOG_RATE_LIMITED) {
+            LOG_DEBUG_EVERY(BENCH_LOG_INTERVAL, "Left bump: ", (int)frame.leftBump);
+            LOG_DEBUG_EVERY(BENCH_LOG_INTERVAL, "Right bump: ", (int)frame.rightBump);
+        }
+        else if(mode == LOG_TO_LCD) {
+            LCD.WriteLine((int)frame.leftBump);
+            LCD.WriteLine((int)frame.rightBump);
+        }
+        return now - start < seconds;
+    });
+    logger.flushAll();
+
+    LogResult result;
+    result.ticks = loop.getTicks();
+    result.overruns = loop.getOverruns();
+    result.maxJitter = loop.getMaxJitter();
+    result.meanJitter = loop.getMeanJitter();
+    result.dropped = logger.getDropped();
+    return result;
+}
+
+int main(int argc, char **argv) {
+    double seconds = 10;
+    for(int i = 1; i < argc; i++) {
+        if(strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+            seconds = atof(argv[++i]);
+        }
+        else {
+            fprintf(stderr, "Usage: logbench [--seconds S]\n");
+            return 2;
+        }
+    }
+
+    printf("logging                 ticks/s  overruns  mean jitter ms  max jitter ms  dropped\n");
+    for(int m = 0; m < MODE_COUNT; m++) {
+        LogResult result = runLoop((LogMode)m, seconds);
+        printf("%-22s  %7.1f  %8lu  %14.3f  %13.3f  %7lu\n", MODE_NAMES[m], result.ticks / seconds,
+               result.overruns, result.meanJitter * 1000, result.maxJitter * 1000, result.dropped);
+    }
+    return 0;
+}
@@ -0,0 +1,497 @@
+/**
+ * Monte Carlo robustness runner. Runs the whole mission on the simulator for many seeds, each with its
+ * own randomly drawn amount of wheel slip, analog noise, RPS noise, latency and dropouts, start pose
+ * error and motor mismatch, spread over all the host's cores. Writes the chance the mission succeeds, the
+ * course time distribution and, for every seed that failed, the phase it went wrong in as JSON.
+ *
+ *     g++ -std=c++14 -O2 -pthread -Isim sim/montecarlo.cpp sim/simulator.cpp sim/feh.cpp sim/course.cpp -o montecarlo
+ *     ./montecarlo --runs 2000 --out robustness.json
+ *     ./montecarlo --replay 1234 --trace 0.5
+ *
+ * A run succeeds if the program ended within the time limit with the robot in the course's home area.
+ * Everything random about a run, the noise sizes included, comes from its seed, so --replay runs a
+ * failed seed again exactly, with the LCD output and the phase checkpoints printed.
+ *
+ * A phase has failed if it returns with the robot outside the area it should have got it to, or the time
+ * limit ran out during it. The first phase that failed is reported.
+ */
+#define BENCHMARK
+#define main robot_main
+#ifdef ROBOT_SOURCE
+#include ROBOT_SOURCE
+#else
+#include "../robot.cpp"
+#endif
+#undef main
+
+#include "simulator.h"
+#include "parallel.h"
+#include <algorithm>
+#include <exception>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+//Most phases recorded for one run
+#define MC_MAX_PHASES 8
+#define MC_NAME_LENGTH 32
+//Width of the course time histogram's bins (in seconds)
+#define MC_HISTOGRAM_WIDTH 1
+
+enum McStatus
+{
+    MC_COMPLETED,
+    MC_TIMED_OUT,
+    MC_CRASHED
+};
+
+static const char *STATUS_NAMES[] = {"completed", "timed_out", "crashed"};
+
+/**
+ * This is a struct which holds one noise source and the range its size is drawn from each run, as
+ * multiples of the course's default.
+ */
+struct McNoiseSource
+{
+    const char *name;
+    float SimConfig::*field;
+    float low, high;
+    //false if --noise doesn't scale it, for things that aren't noise
+    bool scaled;
+};
+
+static const McNoiseSource NOISE_SOURCES[] = {
+    {"wheel_slip", &SimConfig::wheelSlip, 0, 3, true},
+    {"analog_noise", &SimConfig::analogNoise, 0, 3, true},
+    {"rps_noise", &SimConfig::rpsNoise, 0, 3, true},
+    {"rps_heading_noise", &SimConfig::rpsHeadingNoise, 0, 3, true},
+    {"rps_latency", &SimConfig::rpsLatency, 0.5, 3, true},
+    {"rps_dropout_rate", &SimConfig::rpsDropoutRate, 0, 10, true},
+    {"start_pose_error", &SimConfig::startPoseError, 0, 10, true},
+    {"left_motor_gain", &SimConfig::leftMotorGain, 0.97, 1.03, false},
+    {"right_motor_gain", &SimConfig::rightMotorGain, 0.97, 1.03, false}
+};
+static const int NOISE_SOURCE_COUNT = sizeof(NOISE_SOURCES) / sizeof(NOISE_SOURCES[0]);
+
+/**
+ * This is a struct which holds the area of the course the robot should be in when a phase returns. The
+ * last phase has to end in the course's home area instead.
+ */
+struct McCheckpoint
+{
+    const char *phase;
+    SimZone zone;
+    bool home;
+};
+
+static const McCheckpoint CHECKPOINTS[] = {
+    //At the supplies
+    {"startToSupplies", {26, 10, 33, 17}, false},
+    //On the upper level by the alcove wall
+    {"suppliesToTop", {23, 45, 31, 53}, false},
+    //Anywhere in the lane to the fuel buttons, since where depends on the button
+    {"doButtons", {22, 44, 34, 62}, false},
+    //Back down the yellow line below the drop off, at the switches
+    {"dropOff", {2, 39, 11, 47}, false},
+    {"completeSwitches", {2, 39, 11, 47}, false},
+    {"goHome", {0, 0, 0, 0}, true}
+};
+static const int CHECKPOINT_COUNT = sizeof(CHECKPOINTS) / sizeof(CHECKPOINTS[0]);
+
+/**
+ * This is a struct which a child process sends back after one run. It is plain data so it can go through
+ * a pipe as is.
+ */
+struct McRun
+{
+    unsigned int seed;
+    int status;
+    bool success;
+    double courseTime;
+    double hostTime;
+    float endX, endY;
+    char failedPhase[MC_NAME_LENGTH];
+    float noise[NOISE_SOURCE_COUNT];
+    int phaseCount;
+    struct
+    {
+        char name[MC_NAME_LENGTH];
+        double time;
+        float endX, endY;
+        bool finished;
+        bool reached;
+    } phases[MC_MAX_PHASES];
+};
+
+struct McOptions
+{
+    int runs;
+    unsigned int seed;
+    float noise;
+    float timeLimit;
+    int threads;
+    const char *output;
+    bool replay;
+    float trace;
+};
+
+//The run a child is filling in, for the phase hook
+static McRun *activeRun = 0;
+
+static double hostSeconds() {
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static const McCheckpoint *findCheckpoint(const char *phase) {
+    for(int i = 0; i < CHECKPOINT_COUNT; i++) {
+        if(strcmp(CHECKPOINTS[i].phase, phase) == 0) {
+            return &CHECKPOINTS[i];
+        }
+    }
+    return 0;
+}
+
+static void failPhase(const char *name) {
+    if(activeRun->failedPhase[0] == 0) {
+        strncpy(activeRun->failedPhase, name, MC_NAME_LENGTH - 1);
+    }
+}
+
+/** phaseHook
+    Records each phase as it starts and checks where it left the robot when it returns
+*/
+static void phaseHook(int id, bool starting) {
+    const BenchEntry &entry = bench.getEntry(id);
+    if(starting) {
+        if(activeRun->phaseCount < MC_MAX_PHASES) {
+            strncpy(activeRun->phases[activeRun->phaseCount].name, entry.name, MC_NAME_LENGTH - 1);
+            activeRun->phases[activeRun->phaseCount].time = simulator().now();
+            activeRun->phaseCount++;
+        }
+        return;
+    }
+    //Returning because the time limit was thrown through it, which runOnce() reports
+    if(std::uncaught_exception() || activeRun->phaseCount == 0) {
+        return;
+    }
+    const SimState &state = simulator().getState();
+    auto &phase = activeRun->phases[activeRun->phaseCount - 1];
+    phase.time = simulator().now() - phase.time;
+    phase.endX = state.x;
+    phase.endY = state.y;
+    phase.finished = true;
+    const McCheckpoint *checkpoint = findCheckpoint(entry.name);
+    phase.reached = !checkpoint || simulator().inZone(checkpoint->home ? simulator().getConfig().course.home
+                                                      : checkpoint->zone);
+    if(!phase.reached) {
+        failPhase(entry.name);
+    }
+}
+
+/** drawConfig
+    Sets up the simulator for a run, drawing the size of each noise source from the seed
+*/
+static SimConfig drawConfig(const McOptions &options, unsigned int seed, McRun *run) {
+    SimConfig config = defaultConfig();
+    config.seed = seed;
+    config.echoLcd = options.replay;
+    config.tracePeriod = options.trace;
+    config.timeLimit = options.timeLimit;
+    //Not the simulator's generator, so the sizes don't follow the noise drawn with them
+    std::mt19937 random(seed);
+    for(int i = 0; i < NOISE_SOURCE_COUNT; i++) {
+        const McNoiseSource &source = NOISE_SOURCES[i];
+        float scale = std::uniform_real_distribution<float>(source.low, source.high)(random);
+        if(source.scaled) {
+            scale *= options.noise;
+        }
+        config.*source.field *= scale;
+        run->noise[i] = config.*source.field;
+    }
+    return config;
+}
+
+/** runOnce
+    Runs the mission for one seed on a fresh simulator, in the calling process
+*/
+static void runOnce(const McOptions &options, unsigned int seed, McRun *run) {
+    activeRun = run;
+    run->seed = seed;
+    SimConfig config = drawConfig(options, seed, run);
+    simulator().reset(config);
+    bench.setPhaseHook(phaseHook);
+
+    double start = hostSeconds();
+    run->status = MC_COMPLETED;
+    try {
+        robot_main();
+    }
+    catch(const SimulationEnded &ended) {
+        run->status = MC_TIMED_OUT;
+        //The phase that was running when time ran out never finished
+        for(int i = 0; i < run->phaseCount; i++) {
+            if(!run->phases[i].finished) {
+                run->phases[i].time = simulator().now() - run->phases[i].time;
+                failPhase(run->phases[i].name);
+            }
+        }
+    }
+    run->hostTime = hostSeconds() - start;
+    run->endX = simulator().getState().x;
+    run->endY = simulator().getState().y;
+    run->success = run->status == MC_COMPLETED && simulator().inZone(config.course.home);
+    if(!run->success) {
+        failPhase(run->phaseCount > 0 ? run->phases[run->phaseCount - 1].name : "none");
+    }
+    run->courseTime = 0;
+    for(int i = 0; i < bench.getCount(); i++) {
+        //Phases don't overlap, so together they are the course time
+        if(bench.getEntry(i).phase) {
+            run->courseTime += bench.getEntry(i).total;
+        }
+    }
+}
+
+static double percentile(std::vector<double> values, double fraction) {
+    if(values.empty()) {
+        return 0;
+    }
+    std::sort(values.begin(), values.end());
+    size_t rank = (size_t)(fraction * values.size() + 0.999999);
+    return values[(rank < 1 ? 1 : rank) - 1];
+}
+
+/** wilson
+    95% Wilson score interval of a success probability, which stays inside 0 to 1 even with few failures
+*/
+static void wilson(int successes, int runs, double &low, double &high) {
+    const double z = 1.96;
+    double p = (double)successes / runs;
+    double centre = (p + z * z / (2 * runs)) / (1 + z * z / runs);
+    double spread = z * sqrt(p * (1 - p) / runs + z * z / (4. * runs * runs)) / (1 + z * z / runs);
+    low = std::max(0., centre - spread);
+    high = std::min(1., centre + spread);
+}
+
+static void writeRun(FILE *out, const McRun &run) {
+    fprintf(out, "{\"seed\": %u, \"status\": \"%s\", \"success\": %s, \"course_seconds\": %.4f, \"end\": [%.2f, %.2f]",
+            run.seed, STATUS_NAMES[run.status], run.success ? "true" : "false", run.courseTime, run.endX, run.endY);
+    if(!run.success) {
+        fprintf(out, ", \"failed_phase\": \"%s\"", run.failedPhase);
+    }
+    fprintf(out, ", \"noise\": {");
+    for(int i = 0; i < NOISE_SOURCE_COUNT; i++) {
+        fprintf(out, "%s\"%s\": %.4g", i == 0 ? "" : ", ", NOISE_SOURCES[i].name, run.noise[i]);
+    }
+    fprintf(out, "}, \"phases\": {");
+    for(int i = 0; i < run.phaseCount; i++) {
+        fprintf(out, "%s\"%s\": {\"seconds\": %.3f, \"end\": [%.2f, %.2f], \"reached\": %s}", i == 0 ? "" : ", ",
+                run.phases[i].name, run.phases[i].time, run.phases[i].endX, run.phases[i].endY,
+                run.phases[i].reached ? "true" : "false");
+    }
+    fprintf(out, "}}");
+}
+
+static void writeReport(FILE *out, const McOptions &options, const std::vector<McRun> &runs, int steals,
+                        double hostTime) {
+    int successes = 0;
+    int statusCounts[3] = {0, 0, 0};
+    std::vector<double> times;
+    std::map<std::string, int> failures;
+    for(size_t r = 0; r < runs.size(); r++) {
+        statusCounts[runs[r].status]++;
+        if(runs[r].success) {
+            successes++;
+            times.push_back(runs[r].courseTime);
+        }
+        else {
+            failures[runs[r].failedPhase]++;
+        }
+    }
+    double low, high;
+    wilson(successes, runs.size(), low, high);
+    double mean = 0;
+    double squares = 0;
+    for(size_t i = 0; i < times.size(); i++) {
+        mean += times[i];
+    }
+    mean = times.empty() ? 0 : mean / times.size();
+    for(size_t i = 0; i < times.size(); i++) {
+        squares += (times[i] - mean) * (times[i] - mean);
+    }
+
+    fprintf(out, "{\n");
+    fprintf(out, "  \"program\": \"%s\",\n",
+#ifdef ROBOT_SOURCE
+            ROBOT_SOURCE
+#else
+            "../robot.cpp"
+#endif
+           );
+    fprintf(out, "  \"runs\": %d, \"seed\": %u, \"noise\": %.3f, \"time_limit\": %.1f, \"threads\": %d, "
+            "\"steals\": %d, \"host_seconds\": %.2f,\n", options.runs, options.seed, options.noise,
+            options.timeLimit, options.threads, steals, hostTime);
+    fprintf(out, "  \"noise_ranges\": {");
+    for(int i = 0; i < NOISE_SOURCE_COUNT; i++) {
+        fprintf(out, "%s\"%s\": [%g, %g]", i == 0 ? "" : ", ", NOISE_SOURCES[i].name, NOISE_SOURCES[i].low,
+                NOISE_SOURCES[i].high);
+    }
+    fprintf(out, "},\n");
+    fprintf(out, "  \"successes\": %d, \"success_probability\": %.4f, \"success_ci95\": [%.4f, %.4f],\n",
+            successes, (double)successes / runs.size(), low, high);
+    fprintf(out, "  \"completed\": %d, \"timed_out\": %d, \"crashed\": %d,\n", statusCounts[MC_COMPLETED],
+            statusCounts[MC_TIMED_OUT], statusCounts[MC_CRASHED]);
+    fprintf(out, "  \"course_seconds\": {\"mean\": %.4f, \"stddev\": %.4f, \"min\": %.4f, \"p5\": %.4f, \"p50\": %.4f, "
+            "\"p95\": %.4f, \"max\": %.4f},\n", mean, times.size() > 1 ? sqrt(squares / (times.size() - 1)) : 0,
+            percentile(times, 0), percentile(times, 0.05), percentile(times, 0.5), percentile(times, 0.95),
+            percentile(times, 1));
+    //Successful runs' course times in bins of MC_HISTOGRAM_WIDTH seconds from "start"
+    double first = floor(percentile(times, 0) / MC_HISTOGRAM_WIDTH) * MC_HISTOGRAM_WIDTH;
+    std::vector<int> bins;
+    for(size_t i = 0; i < times.size(); i++) {
+        size_t bin = (size_t)((times[i] - first) / MC_HISTOGRAM_WIDTH);
+        if(bin >= bins.size()) {
+            bins.resize(bin + 1, 0);
+        }
+        bins[bin]++;
+    }
+    fprintf(out, "  \"time_histogram\": {\"start\": %g, \"width\": %g, \"counts\": [", first, (double)MC_HISTOGRAM_WIDTH);
+    for(size_t i = 0; i < bins.size(); i++) {
+        fprintf(out, "%s%d", i == 0 ? "" : ", ", bins[i]);
+    }
+    fprintf(out, "]},\n  \"failures_by_phase\": {");
+    for(std::map<std::string, int>::iterator it = failures.begin(); it != failures.end(); ++it) {
+        fprintf(out, "%s\"%s\": %d", it == failures.begin() ? "" : ", ", it->first.c_str(), it->second);
+    }
+    fprintf(out, "},\n  \"failed_seeds\": [");
+    bool firstFailure = true;
+    for(size_t r = 0; r < runs.size(); r++) {
+        if(!runs[r].success) {
+            fprintf(out, "%s%u", firstFailure ? "" : ", ", runs[r].seed);
+            firstFailure = false;
+        }
+    }
+    fprintf(out, "],\n  \"per_run\": [");
+    for(size_t r = 0; r < runs.size(); r++) {
+        fprintf(out, "%s\n    ", r == 0 ? "" : ",");
+        writeRun(out, runs[r]);
+    }
+    fprintf(out, "\n  ]\n}\n");
+}
+
+static void usage() {
+    fprintf(stderr, "usage: montecarlo [--runs N] [--seed S] [--noise SCALE] [--time-limit SECONDS] [--threads N]\n"
+            "                  [--out FILE] [--replay SEED [--trace SECONDS]]\n");
+    exit(2);
+}
+
+int main(int argc, char **argv) {
+    McOptions options;
+    options.runs = 1000;
+    options.seed = 1;
+    options.noise = 1;
+    options.timeLimit = 120;
+    options.threads = 0;
+    options.output = 0;
+    options.replay = false;
+    options.trace = 0;
+    for(int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if(strcmp(argv[i], "--runs") == 0 && hasValue) {
+            options.runs = atoi(argv[++i]);
+        }
+        else if(strcmp(argv[i], "--seed") == 0 && hasValue) {
+            options.seed = strtoul(argv[++i], 0, 10);
+        }
+        else if(strcmp(argv[i], "--noise") == 0 && hasValue) {
+            options.noise = atof(argv[++i]);
+        }
+        else if(strcmp(argv[i], "--time-limit") == 0 && hasValue) {
+            options.timeLimit = atof(argv[++i]);
+        }
+        else if(strcmp(argv[i], "--threads") == 0 && hasValue) {
+            options.threads = atoi(argv[++i]);
+        }
+        else if(strcmp(argv[i], "--out") == 0 && hasValue) {
+            options.output = argv[++i];
+        }
+        else if(strcmp(argv[i], "--replay") == 0 && hasValue) {
+            options.replay = true;
+            options.seed = strtoul(argv[++i], 0, 10);
+        }
+        else if(strcmp(argv[i], "--trace") == 0 && hasValue) {
+            options.trace = atof(argv[++i]);
+        }
+        else {
+            usage();
+        }
+    }
+    if(options.runs < 1) {
+        usage();
+    }
+
+    if(options.replay) {
+        McRun run;
+        memset(&run, 0, sizeof(run));
+        runOnce(options, options.seed, &run);
+        fflush(stdout);
+        for(int i = 0; i < run.phaseCount; i++) {
+            fprintf(stderr, "%-18s %6.2f s  ended at (%.2f, %.2f)%s\n", run.phases[i].name, run.phases[i].time,
+                    run.phases[i].endX, run.phases[i].endY, run.phases[i].reached ? "" : "  MISSED CHECKPOINT");
+        }
+        fprintf(stderr, "seed %u: %s, %s", run.seed, STATUS_NAMES[run.status], run.success ? "succeeded" : "failed");
+        if(!run.success) {
+            fprintf(stderr, " in %s", run.failedPhase);
+        }
+        fprintf(stderr, ", %.2f s\n", run.courseTime);
+        return run.success ? 0 : 1;
+    }
+
+    WorkStealingPool pool(options.threads);
+    options.threads = pool.getThreadCount();
+    fprintf(stderr, "%d runs on %d threads\n", options.runs, options.threads);
+    std::vector<McRun> runs(options.runs);
+    int finished = 0;
+    int failed = 0;
+    double start = hostSeconds();
+    pool.run(options.runs, [&](int job) {
+        McRun &run = runs[job];
+        memset(&run, 0, sizeof(run));
+        run.seed = options.seed + job;
+        run.status = MC_CRASHED;
+        strcpy(run.failedPhase, "unknown");
+        runForked([&](McRun *result) {
+            runOnce(options, options.seed + job, result);
+        }, &run);
+        std::lock_guard<std::mutex> hold(forkLock());
+        finished++;
+        if(!run.success) {
+            failed++;
+            fprintf(stderr, "seed %u failed in %s (%s), replay with --replay %u\n", run.seed, run.failedPhase,
+                    STATUS_NAMES[run.status], run.seed);
+        }
+        if(finished % std::max(1, options.runs / 20) == 0 || finished == options.runs) {
+            fprintf(stderr, "%d/%d runs, %d failed, %.1f s\n", finished, options.runs, failed, hostSeconds() - start);
+        }
+    });
+    double hostTime = hostSeconds() - start;
+
+    FILE *out = options.output ? fopen(options.output, "w") : stdout;
+    if(!out) {
+        perror(options.output);
+        return 1;
+    }
+    writeReport(out, options, runs, pool.getSteals(), hostTime);
+    if(out != stdout) {
+        fclose(out);
+    }
+    return 0;
+}
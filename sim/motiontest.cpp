@@ -0,0 +1,213 @@
+/**
+ * Motion primitive tests. Runs primitives from the robot program on the simulator into each way a move
+ * can end early, a deadline, wheels that won't turn, a wall and RPS going away, and checks the flags of
+ * the MotionResult they return and that the flight recorder stops at the first failure.
+ *
+ * The robot program is compiled in like the benchmark's, and each case runs in a forked child so it
+ * starts with fresh globals:
+ *
+ *     g++ -std=c++14 -O2 -Isim sim/motiontest.cpp sim/simulator.cpp sim/feh.cpp sim/course.cpp -o motiontest
+ *     ./motiontest
+ */
+#define BENCHMARK
+#define main robot_main
+#include "../robot.cpp"
+#undef main
+
+#include "simulator.h"
+#include "check.h"
+#include <stdlib.h>
+#include <string.h>
+
+//Where the robot is set down, in the middle of an empty floor
+#define OPEN_X 36
+#define OPEN_Y 36
+//A wall this far in front of the robot for the bump case (in inches)
+#define WALL_AHEAD 8
+//Slack on how long a primitive ran past the time it should have stopped at (in seconds)
+#define STOP_SLACK 0.1
+
+/** openFloor
+    @return A configuration with no walls, lines or setup menu and the robot facing +y
+*/
+static SimConfig openFloor() {
+    SimConfig config = defaultConfig();
+    config.echoLcd = false;
+    config.tracePeriod = 0;
+    config.touchCount = 0;
+    config.course.wallCount = 0;
+    config.course.lineCount = 0;
+    config.course.deadZoneCount = 0;
+    config.startX = OPEN_X;
+    config.startY = OPEN_Y;
+    config.startHeading = 90;
+    config.startPoseError = 0;
+    return config;
+}
+
+/** startRun
+    Resets the simulator and runs initialize()
+*/
+static void startRun(const SimConfig &config) {
+    simulator().reset(config);
+    initialize();
+}
+
+/** waitForFix
+    Runs the control loop until the pose estimate has had an RPS reading, as initialize() puts the robot
+    at the course start
+*/
+static void waitForFix() {
+    controlLoop.run([](double now) { return odometry.getTimeSinceFix(now) < 0; });
+}
+
+static bool motorsStopped() {
+    return simulator().getState().leftPercent == 0 && simulator().getState().rightPercent == 0;
+}
+
+static void testCompleted() {
+    startRun(openFloor());
+    MotionResult result = turn_left(30, 90);
+    CHECK(result.completed);
+    CHECK(!result.timedOut && !result.stalled && !result.bumped && !result.rpsLost);
+    CHECK(!result.failed);
+    CHECK(result.elapsed > 0);
+    CHECK(motorsStopped());
+    CHECK(!recorder.isFrozen());
+}
+
+static void testTimeout() {
+    startRun(openFloor());
+    MotionResult result = turn_left(30, 3600, 0.5);
+    CHECK(!result.completed);
+    CHECK(result.timedOut);
+    CHECK(!result.stalled && !result.bumped && !result.rpsLost);
+    CHECK(result.failed);
+    CHECK_NEAR(result.elapsed, 0.5, STOP_SLACK);
+    //What was left of the turn
+    CHECK(result.error > 0);
+    CHECK(motorsStopped());
+}
+
+static void testStall() {
+    //The wheels never turn, whatever the motors are set to
+    SimConfig config = openFloor();
+    config.motorDeadband = 100;
+    startRun(config);
+    MotionResult result = turn_right(30, 90);
+    CHECK(!result.completed);
+    CHECK(result.stalled);
+    CHECK(!result.timedOut && !result.bumped && !result.rpsLost);
+    CHECK(result.failed);
+    CHECK_NEAR(result.elapsed, MOTION_STALL_TIME, STOP_SLACK);
+    CHECK(motorsStopped());
+}
+
+static void testRecorderFrozen() {
+    //The recorder keeps every tick up to the stall and nothing after it
+    SimConfig config = openFloor();
+    config.motorDeadband = 100;
+    startRun(config);
+    controlLoop.run([](double now) { return now < 1; });
+    unsigned long before = recorder.getTotal();
+    CHECK(!recorder.isFrozen());
+    MotionResult result = turn_left(30, 90);
+    CHECK(result.stalled);
+    CHECK(recorder.isFrozen());
+    unsigned long total = recorder.getTotal();
+    CHECK_NEAR(total - before, result.elapsed / CONTROL_PERIOD, 3);
+    const FlightRecord &last = recorder.getRecord(recorder.getCount() - 1);
+    CHECK(strcmp(bench.getEntry(last.primitive).name, "turn_left") == 0);
+    CHECK_NEAR((double)last.time / FLIGHT_TIME_SCALE, TimeNow(), 2 * CONTROL_PERIOD);
+    controlLoop.run([](double now) { return now < 3; });
+    CHECK(recorder.getTotal() == total);
+}
+
+static void testWallTimeout() {
+    //driveToWall gives up on a wall it can't find in time without it counting as a failure
+    startRun(openFloor());
+    MotionResult result = driveToWall(30, 0.5);
+    CHECK(result.timedOut);
+    CHECK(!result.failed);
+    CHECK(!recorder.isFrozen());
+}
+
+static void testFaceLocationStall() {
+    //faceLocation hands back its first turn's stall instead of trying the heading correction as well
+    SimConfig config = openFloor();
+    config.motorDeadband = 100;
+    startRun(config);
+    waitForFix();
+    MotionResult result = faceLocation(OPEN_X + 10, OPEN_Y);
+    CHECK(!result.completed);
+    CHECK(result.stalled);
+    CHECK_NEAR(result.elapsed, MOTION_STALL_TIME, STOP_SLACK);
+}
+
+static void testFaceLocation() {
+    startRun(openFloor());
+    waitForFix();
+    MotionResult result = faceLocation(OPEN_X + 10, OPEN_Y);
+    CHECK(result.completed);
+    CHECK(!result.timedOut && !result.stalled);
+    //The wheels coast on for a couple of degrees after faceDegree stops them
+    CHECK(fabs(angleDifference(0, simulator().getState().heading)) < 3);
+}
+
+static void testBump() {
+    SimConfig config = openFloor();
+    SimWall wall = {0, OPEN_Y + WALL_AHEAD, 72, OPEN_Y + WALL_AHEAD};
+    config.course.walls[0] = wall;
+    config.course.wallCount = 1;
+    startRun(config);
+    MotionResult result = move_forward(30, 3 * WALL_AHEAD);
+    CHECK(!result.completed);
+    CHECK(result.bumped);
+    CHECK(!result.timedOut && !result.rpsLost);
+    //It stopped short of the distance asked for
+    CHECK(result.error > WALL_AHEAD);
+    CHECK(!result.failed);
+    CHECK(motorsStopped());
+}
+
+static void testRpsLost() {
+    SimConfig config = openFloor();
+    config.rpsOutageStart = 0;
+    config.rpsOutageEnd = 1000;
+    startRun(config);
+    MotionResult result = check_y_plus(OPEN_Y + 3);
+    CHECK(!result.completed);
+    CHECK(result.rpsLost);
+    CHECK(!result.timedOut && !result.stalled && !result.bumped);
+    CHECK(result.failed);
+    CHECK_NEAR(result.elapsed, MOTION_RPS_LOST_TIME, STOP_SLACK);
+    CHECK(motorsStopped());
+}
+
+static void testRpsTimeout() {
+    //RPS keeps coming back just before it counts as lost, so the correction runs into its deadline instead
+    SimConfig config = openFloor();
+    config.rpsDropoutRate = 1;
+    startRun(config);
+    MotionResult result = check_y_plus(OPEN_Y + 3, 0.5);
+    CHECK(!result.completed);
+    CHECK(result.timedOut);
+    CHECK(!result.rpsLost);
+    CHECK_NEAR(result.elapsed, 0.5, STOP_SLACK);
+}
+
+int main() {
+    //No calibration or gains on the SD card, so every case uses the built in constants
+    setenv("SIM_SD", "/nonexistent", 1);
+    checkForked("completed", testCompleted);
+    checkForked("timeout", testTimeout);
+    checkForked("stall", testStall);
+    checkForked("recorder frozen", testRecorderFrozen);
+    checkForked("wall timeout", testWallTimeout);
+    checkForked("faceLocation stall", testFaceLocationStall);
+    checkForked("faceLocation", testFaceLocation);
+    checkForked("bump", testBump);
+    checkForked("RPS lost", testRpsLost);
+    checkForked("RPS timeout", testRpsTimeout);
+    return checkSummary("motiontest");
+}
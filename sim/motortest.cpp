@@ -0,0 +1,164 @@
+/**
+ * Motor command tests. Drives a DriveMotor wired to the simulator's left wheel and checks what reaches the
+ * stub FEHMotor: a reversal ramps through zero at no more than the slew rate, a write of the whole percent
+ * the motor already has is skipped, and Stop() goes out at once whatever the slew rate.
+ *
+ *     g++ -std=c++14 -O2 -Isim sim/motortest.cpp sim/simulator.cpp sim/feh.cpp sim/course.cpp -o motortest
+ *     ./motortest
+ */
+#include "../motor.h"
+#include "simulator.h"
+#include "check.h"
+
+Bench bench;
+
+//Most a slew limited motor may change in one control tick (in percent)
+static const float TICK_STEP = MOTOR_SLEW_RATE * CONTROL_PERIOD;
+
+/** wheelPercent
+    @return Percent the stub FEHMotor last sent the left wheel
+*/
+static float wheelPercent() {
+    return simulator().getState().leftPercent;
+}
+
+/** tick
+    Moves virtual time on a control period and runs the motor's background task, like the control loop
+*/
+static void tick(DriveMotor &motor) {
+    simulator().advance(CONTROL_PERIOD);
+    DriveMotor::update(&motor, TimeNow());
+}
+
+/** motorConfig
+    @return A configuration for a fresh motor on the left wheel
+*/
+static SimConfig motorConfig() {
+    SimConfig config = defaultConfig();
+    config.echoLcd = false;
+    config.tracePeriod = 0;
+    return config;
+}
+
+static void startMotor() {
+    simulator().reset(motorConfig());
+}
+
+static void testFirstWrite() {
+    startMotor();
+    DriveMotor motor(FEHMotor::Motor3, 12.0);
+    //The first command goes out even though the motor is taken to be at zero already
+    motor.SetPercent(0);
+    CHECK(motor.getWrites() == 1);
+    CHECK(motor.getSkipped() == 0);
+    CHECK(wheelPercent() == 0);
+}
+
+static void testRampThroughZero() {
+    startMotor();
+    DriveMotor motor(FEHMotor::Motor3, 12.0);
+    motor.SetPercent(50);
+    //A motor that sat still gets one tick's worth of change at first
+    CHECK(wheelPercent() <= TICK_STEP + 1e-3);
+    int ticks = 0;
+    while(wheelPercent() != 50 && ticks < 1000) {
+        tick(motor);
+        ticks++;
+    }
+    CHECK(wheelPercent() == 50);
+    CHECK(motor.getDirection() == 1);
+
+    motor.SetPercent(-50);
+    float last = wheelPercent();
+    bool sawZero = false;
+    bool steady = true;
+    ticks = 0;
+    while(wheelPercent() != -50 && ticks < 1000) {
+        tick(motor);
+        float change = last - wheelPercent();
+        steady = steady && change >= 0 && change <= TICK_STEP + 1e-3;
+        sawZero = sawZero || fabs(wheelPercent()) < TICK_STEP;
+        last = wheelPercent();
+        ticks++;
+    }
+    CHECK(steady);
+    CHECK(sawZero);
+    CHECK(wheelPercent() == -50);
+    CHECK(motor.getDirection() == -1);
+    //Full forward to full reverse at the slew rate, give or take the first step from SetPercent()
+    CHECK_NEAR(ticks * CONTROL_PERIOD, 100.0 / MOTOR_SLEW_RATE, 2 * CONTROL_PERIOD);
+}
+
+static void testSkippedWrites() {
+    //Writes slow enough to show up in the virtual time
+    SimConfig config = motorConfig();
+    config.motorWriteCost = 0.001;
+    simulator().reset(config);
+    DriveMotor motor(FEHMotor::Motor3, 12.0, 0);
+    motor.SetPercent(30);
+    CHECK(wheelPercent() == 30);
+    unsigned long writes = motor.getWrites();
+    double before = TimeNow();
+    for(int i = 0; i < 10; i++) {
+        motor.SetPercent(30);
+        tick(motor);
+    }
+    CHECK(motor.getWrites() == writes);
+    CHECK(motor.getSkipped() == 10);
+    //A skipped write costs the robot no time on the motor bus
+    CHECK(TimeNow() - before < 10 * CONTROL_PERIOD + config.motorWriteCost);
+    motor.SetPercent(31);
+    CHECK(motor.getWrites() == writes + 1);
+    CHECK(wheelPercent() == 31);
+}
+
+static void testFractionalWrites() {
+    startMotor();
+    DriveMotor motor(FEHMotor::Motor3, 12.0, 0);
+    //Steering adds fractions of a percent that don't change the whole percent the motor is sent
+    motor.SetPercent(30.2);
+    motor.SetPercent(30.4);
+    CHECK(motor.getWrites() == 1);
+    CHECK(motor.getSkipped() == 1);
+    CHECK(wheelPercent() == 30);
+    CHECK(motor.getCommand() == 30);
+    CHECK_NEAR(motor.getPercent(), 30.4, 1e-4);
+    //Once the fractions add up to the next whole percent it goes out
+    motor.SetPercent(30.6);
+    CHECK(motor.getWrites() == 2);
+    CHECK(wheelPercent() == 31);
+    motor.SetPercent(-0.4);
+    CHECK(wheelPercent() == 0);
+    motor.Stop();
+    CHECK(motor.getWrites() == 3);
+    CHECK(motor.getSkipped() == 2);
+}
+
+static void testStopUnlimited() {
+    startMotor();
+    DriveMotor motor(FEHMotor::Motor3, 12.0);
+    motor.SetPercent(80);
+    while(wheelPercent() != 80) {
+        tick(motor);
+    }
+    motor.Stop();
+    CHECK(wheelPercent() == 0);
+    CHECK(motor.getPercent() == 0);
+    CHECK(motor.getTarget() == 0);
+    //Nothing left to ramp, and the wheel is still taken to be coasting forward
+    tick(motor);
+    CHECK(wheelPercent() == 0);
+    CHECK(motor.getDirection() == 1);
+    unsigned long skipped = motor.getSkipped();
+    motor.Stop();
+    CHECK(motor.getSkipped() == skipped + 1);
+}
+
+int main() {
+    testFirstWrite();
+    testRampThroughZero();
+    testSkippedWrites();
+    testFractionalWrites();
+    testStopUnlimited();
+    return checkSummary("motortest");
+}
@@ -0,0 +1,180 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+/** forkLock
+    Held around fork() and around anything the host tools print while workers are running, so a child
+    is never forked while another thread holds a stdio lock it would then wait on forever
+*/
+inline std::mutex &forkLock() {
+    static std::mutex lock;
+    return lock;
+}
+
+/** runForked
+    Runs a function in a forked child process, so every run starts with the robot program's globals
+    reset, and copies back the plain-data result the child fills in. Safe to call from several threads.
+    @param run Function taking a Result * to fill in
+    @param result Set to what the child filled in, left alone if the child crashed
+    @return false if the child crashed before sending its result
+*/
+template <class Result, class Function>
+bool runForked(Function run, Result *result) {
+    int fds[2];
+    pid_t pid;
+    {
+        //No other child may inherit this pipe's write end, or a crash wouldn't show up as end of file
+        std::lock_guard<std::mutex> hold(forkLock());
+        if(pipe(fds) != 0) {
+            perror("pipe");
+            exit(1);
+        }
+        fflush(stdout);
+        pid = fork();
+        if(pid != 0) {
+            close(fds[1]);
+        }
+    }
+    if(pid == 0) {
+        close(fds[0]);
+        Result sent;
+        memset(&sent, 0, sizeof(sent));
+        run(&sent);
+        fflush(stdout);
+        ssize_t written = write(fds[1], &sent, sizeof(sent));
+        _exit(written == sizeof(sent) ? 0 : 1);
+    }
+    Result received;
+    size_t got = 0;
+    while(got < sizeof(received)) {
+        ssize_t n = read(fds[0], (char *)&received + got, sizeof(received) - got);
+        if(n <= 0) {
+            break;
+        }
+        got += n;
+    }
+    close(fds[0]);
+    waitpid(pid, 0, 0);
+    if(got != sizeof(received)) {
+        return false;
+    }
+    *result = received;
+    return true;
+}
+
+/**
+ * This is a class which runs a fixed set of jobs, numbered 0 to count - 1, on a pool of threads.
+ *
+ * Each thread starts with its own deque of jobs, dealt out in runs of neighbouring numbers, and takes
+ * them from the back. A thread that runs out steals from the front of another thread's deque, so threads
+ * that drew slow jobs don't hold up the rest. No jobs are added once the pool starts, so a thread that
+ * finds every deque empty is done.
+ */
+class WorkStealingPool
+{
+    public:
+        /** WorkStealingPool
+            @param threads Number of threads, 0 for one per host core
+        */
+        WorkStealingPool(int threads = 0) {
+            if(threads <= 0) {
+                threads = std::thread::hardware_concurrency();
+            }
+            workers = std::vector<Worker>(threads > 0 ? threads : 1);
+        }
+
+        int getThreadCount() const {
+            return (int)workers.size();
+        }
+
+        /** run
+            Runs every job and returns once they have all finished
+            @param count Number of jobs
+            @param job Function taking the job's number, called from the pool's threads
+        */
+        template <class Job>
+        void run(int count, Job job) {
+            int threads = getThreadCount();
+            for(int t = 0; t < threads; t++) {
+                //Job t * count / threads up to the next thread's first job
+                for(int j = (long)t * count / threads; j < (long)(t + 1) * count / threads; j++) {
+                    workers[t].jobs.push_back(j);
+                }
+            }
+            std::vector<std::thread> running;
+            for(int t = 0; t < threads; t++) {
+                running.push_back(std::thread([this, t, &job]() {
+                    int next;
+                    while(take(t, next)) {
+                        job(next);
+                    }
+                }));
+            }
+            for(size_t t = 0; t < running.size(); t++) {
+                running[t].join();
+            }
+        }
+
+        /** getSteals
+            @return Jobs run by a thread other than the one they were dealt to
+        */
+        int getSteals() const {
+            int steals = 0;
+            for(size_t t = 0; t < workers.size(); t++) {
+                steals += workers[t].steals;
+            }
+            return steals;
+        }
+
+    private:
+        struct Worker
+        {
+            Worker() {
+                steals = 0;
+            }
+
+            Worker(const Worker &) {
+                steals = 0;
+            }
+
+            std::mutex lock;
+            std::deque<int> jobs;
+            int steals;
+        };
+
+        bool take(int thread, int &job) {
+            Worker &own = workers[thread];
+            {
+                std::lock_guard<std::mutex> hold(own.lock);
+                if(!own.jobs.empty()) {
+                    job = own.jobs.back();
+                    own.jobs.pop_back();
+                    return true;
+                }
+            }
+            for(int i = 1; i < getThreadCount(); i++) {
+                Worker &victim = workers[(thread + i) % getThreadCount()];
+                std::lock_guard<std::mutex> hold(victim.lock);
+                if(!victim.jobs.empty()) {
+                    job = victim.jobs.front();
+                    victim.jobs.pop_front();
+                    own.steals++;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        std::vector<Worker> workers;
+};
+
+#endif
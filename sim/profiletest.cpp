@@ -0,0 +1,175 @@
+/**
+ * Profiled move tests. Checks TrapezoidProfile's plan on its own, then drives move_profiled over several
+ * distances and speeds on an empty simulated floor, so PROFILE_KV, PROFILE_KA, PROFILE_KP and PROFILE_KI are
+ * checked against a robot: each move has to finish within PROFILE_TOLERANCE, not overshoot by more than
+ * that, and take no longer than move_forward over the same distance at the same cruising speed plus the
+ * time the profile spends speeding up. followPath is driven around a corner the same way.
+ *
+ * The robot program is compiled in like the benchmark's, and each case runs in a forked child so it
+ * starts with fresh globals:
+ *
+ *     g++ -std=c++14 -O2 -Isim sim/profiletest.cpp sim/simulator.cpp sim/feh.cpp sim/course.cpp -o profiletest
+ *     ./profiletest
+ */
+#define BENCHMARK
+#define main robot_main
+#include "../robot.cpp"
+#undef main
+
+#include "simulator.h"
+#include "check.h"
+#include <stdlib.h>
+
+//Where the robot is set down, facing +y with the whole floor ahead of it
+#define OPEN_X 36
+#define OPEN_Y 12
+//Fraction of a move the wheels may slip, on top of the tolerance, before the robot's true position is off
+#define SLIP_ALLOWANCE 0.03
+
+/**
+ * This is a struct which holds one move_profiled case.
+ */
+struct ProfileCase
+{
+    float inches;
+    float maxVelocity;
+};
+
+static const ProfileCase PROFILE_CASES[] = {
+    {3, PROFILE_MAX_VELOCITY},
+    {12, PROFILE_MAX_VELOCITY},
+    {24, PROFILE_MAX_VELOCITY},
+    {12, 10},
+    {24, 24},
+    {-12, PROFILE_MAX_VELOCITY},
+};
+
+static SimConfig openFloor() {
+    SimConfig config = defaultConfig();
+    config.echoLcd = false;
+    config.tracePeriod = 0;
+    config.touchCount = 0;
+    config.course.wallCount = 0;
+    config.course.lineCount = 0;
+    config.course.deadZoneCount = 0;
+    config.startX = OPEN_X;
+    config.startY = OPEN_Y;
+    config.startHeading = 90;
+    config.startPoseError = 0;
+    return config;
+}
+
+static void startRun() {
+    simulator().reset(openFloor());
+    initialize();
+    controlLoop.run([](double now) { return odometry.getTimeSinceFix(now) < 0; });
+}
+
+/** farthestSince
+    Looks through the flight recorder's records for the farthest the encoders counted
+    @param total Records the recorder had made when the move started
+    @return Inches
+*/
+static float farthestSince(unsigned long total) {
+    int count = (int)(recorder.getTotal() - total);
+    float farthest = 0;
+    for(int i = recorder.getCount() - count; i < recorder.getCount(); i++) {
+        const FlightRecord &record = recorder.getRecord(i);
+        float traveled = (record.leftCounts + record.rightCounts) / 2.f / calibration.countsPerInch;
+        if(traveled > farthest) {
+            farthest = traveled;
+        }
+    }
+    return farthest;
+}
+
+/** plainElapsed
+    @return Time move_forward takes over a case's distance at the percent that cruises at its top speed
+*/
+static float plainElapsed(const ProfileCase &move) {
+    float elapsed = -1;
+    runForked([&](float *result) {
+        startRun();
+        *result = move_forward((int)lroundf(PROFILE_KV * move.maxVelocity), fabs(move.inches)).elapsed;
+    }, &elapsed);
+    return elapsed;
+}
+
+static void testProfilePlan() {
+    //Long enough to cruise
+    TrapezoidProfile trapezoid(24, 18, 30);
+    CHECK_NEAR(trapezoid.getPeakVelocity(), 18, 1e-4);
+    CHECK_NEAR(trapezoid.getDuration(), 24. / 18 + 18. / 30, 1e-4);
+    CHECK_NEAR(trapezoid.position(0), 0, 1e-6);
+    CHECK_NEAR(trapezoid.position(trapezoid.getDuration()), 24, 1e-4);
+    CHECK_NEAR(trapezoid.position(trapezoid.getDuration() / 2), 12, 1e-3);
+    CHECK_NEAR(trapezoid.velocity(trapezoid.getDuration() / 2), 18, 1e-4);
+    CHECK_NEAR(trapezoid.accelerationAt(0.1), 30, 1e-6);
+    CHECK_NEAR(trapezoid.accelerationAt(trapezoid.getDuration() - 0.1), -30, 1e-6);
+    //Too short to reach the top speed, so it peaks halfway
+    TrapezoidProfile triangle(3, 18, 30);
+    CHECK_NEAR(triangle.getPeakVelocity(), sqrt(3. * 30), 1e-4);
+    CHECK_NEAR(triangle.getDuration(), 2 * sqrt(3. / 30), 1e-4);
+    CHECK_NEAR(triangle.position(triangle.getDuration() / 2), 1.5, 1e-4);
+    //Position never runs backwards or past the end, and velocity never past the top speed
+    float last = 0;
+    bool monotonic = true;
+    bool bounded = true;
+    for(float t = 0; t <= trapezoid.getDuration() + 0.1; t += 0.01) {
+        float position = trapezoid.position(t);
+        monotonic = monotonic && position >= last;
+        bounded = bounded && position <= 24 + 1e-4 && trapezoid.velocity(t) <= 18 + 1e-4;
+        last = position;
+    }
+    CHECK(monotonic);
+    CHECK(bounded);
+}
+
+static void testProfiledMove(const ProfileCase &move, float plain) {
+    startRun();
+    unsigned long total = recorder.getTotal();
+    float startY = simulator().getState().y;
+    MotionResult result = move_profiled(move.inches, move.maxVelocity);
+    float distance = fabs(move.inches);
+    CHECK(result.completed);
+    CHECK(!result.failed && !result.bumped);
+    //The encoders agree with the plan, and the robot really went that far give or take the wheels slipping
+    CHECK(fabs(result.error) <= PROFILE_TOLERANCE);
+    float moved = (simulator().getState().y - startY) * (move.inches < 0 ? -1 : 1);
+    CHECK_NEAR(moved, distance, PROFILE_TOLERANCE + SLIP_ALLOWANCE * distance);
+    CHECK(farthestSince(total) - distance <= PROFILE_TOLERANCE);
+    TrapezoidProfile profile(distance, move.maxVelocity, PROFILE_ACCELERATION);
+    CHECK(result.elapsed <= profile.getDuration() + PROFILE_SETTLE_TIME);
+    //move_forward starts at its cruising percent straight away, so the profile may only lose the ramp up
+    CHECK(plain > 0);
+    CHECK(result.elapsed <= plain + profile.getPeakVelocity() / PROFILE_ACCELERATION);
+}
+
+static void testFollowPath() {
+    //Around a corner, without stopping to turn
+    startRun();
+    Waypoint path[] = {{OPEN_X, OPEN_Y + 18}, {OPEN_X + 18, OPEN_Y + 18}};
+    MotionResult result = followPath(path, 2);
+    CHECK(result.completed);
+    CHECK(!result.failed && !result.bumped);
+    CHECK(result.error <= PURSUIT_TOLERANCE);
+    //The pose estimate stops within the tolerance, so the robot is within that and what RPS is off by
+    const SimState &state = simulator().getState();
+    CHECK_NEAR(state.x, OPEN_X + 18, PURSUIT_TOLERANCE + 1);
+    CHECK_NEAR(state.y, OPEN_Y + 18, PURSUIT_TOLERANCE + 1);
+    //Slower than the top speed only over the last few inches
+    float speed = PURSUIT_SPEED / PROFILE_KV;
+    CHECK(result.elapsed <= 36 / speed + PURSUIT_SLOW_DISTANCE * PROFILE_KV / PURSUIT_MIN_PERCENT + 1);
+}
+
+int main() {
+    //No calibration or gains on the SD card, so every case uses the built in constants
+    setenv("SIM_SD", "/nonexistent", 1);
+    checkForked("profile plan", testProfilePlan);
+    for(unsigned int i = 0; i < sizeof(PROFILE_CASES) / sizeof(PROFILE_CASES[0]); i++) {
+        float plain = plainElapsed(PROFILE_CASES[i]);
+        checkForked("move_profiled", [i, plain]() { testProfiledMove(PROFILE_CASES[i], plain); });
+    }
+    checkForked("followPath", testFollowPath);
+    return checkSummary("profiletest");
+}
@@ -0,0 +1,197 @@
+/**
+ * Sensor read benchmark. Runs the mission on the simulator and counts every encoder Counts(), input pin
+ * Value() and RPS X(), Y() and Heading() call the robot program makes (the simulator's FEH objects count
+ * them themselves), then shares them out among the control loop's ticks. A background task marks the start
+ * of every tick, and the reads up to the next tick of the same run() belong to that tick. Reads before the
+ * first tick, between one primitive's loop and the next, and on the last tick of each loop are counted as
+ * outside the loop instead.
+ *
+ *     g++ -std=c++14 -O2 -Isim sim/readbench.cpp sim/simulator.cpp sim/feh.cpp sim/course.cpp -o readbench
+ *     ./readbench --runs 10
+ *
+ * It only needs the program's controlLoop, so it can be built against robot.cpp from before the sensors
+ * were read once per tick (that version's locations.h needs -fpermissive) to compare the two:
+ *
+ *     mkdir /tmp/before
+ *     for f in robot.cpp scheduler.h locations.h; do git show e7f7204:$f > /tmp/before/$f; done
+ *     g++ -std=c++14 -O2 -fpermissive -w -Isim -DROBOT_SOURCE='"/tmp/before/robot.cpp"' sim/readbench.cpp \
+ *         sim/simulator.cpp sim/feh.cpp sim/course.cpp -o readbench_before
+ */
+#define main robot_main
+#ifdef ROBOT_SOURCE
+#include ROBOT_SOURCE
+#else
+#include "../robot.cpp"
+#endif
+#undef main
+
+#include "simulator.h"
+#include "parallel.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//Ticks of the same run() start one period apart, or a little more after an overrun. A run()'s first tick
+//starts straight away, so a shorter gap, or one longer than this many periods, means another run() started.
+#define SAME_RUN_PERIODS 4
+//Reads in one tick the histogram counts separately, busier ticks go in the last bucket
+#define READ_HISTOGRAM_BUCKETS 16
+
+static const char *READ_NAMES[SIM_READ_KINDS] = {"encoders", "digital", "analog", "rps"};
+
+/**
+ * This is a struct which holds one run's reads. It is plain data so it can come back from a forked child.
+ */
+struct ReadRun
+{
+    bool ended;
+    double courseTime;
+    unsigned long ticks;
+    unsigned long loopReads[SIM_READ_KINDS];
+    unsigned long otherReads[SIM_READ_KINDS];
+    unsigned long busiest[SIM_READ_KINDS];
+    unsigned long busiestTotal;
+    unsigned long histogram[READ_HISTOGRAM_BUCKETS];
+};
+
+static ReadRun *current;
+static double lastTick;
+static unsigned long lastReads[SIM_READ_KINDS];
+
+/** markTick
+    Background task run at the start of every tick. Adds the reads since the last mark to that tick if it
+    was in the same run(), or to the reads outside the loop if not.
+*/
+void markTick(void *, double now) {
+    double gap = now - lastTick;
+    double period = controlLoop.getPeriod();
+    bool sameRun = lastTick >= 0 && gap >= period / 2 && gap <= SAME_RUN_PERIODS * period;
+    unsigned long total = 0;
+    for(int i = 0; i < SIM_READ_KINDS; i++) {
+        unsigned long reads = simulator().getReads((SimRead)i);
+        unsigned long added = reads - lastReads[i];
+        lastReads[i] = reads;
+        if(sameRun) {
+            current->loopReads[i] += added;
+            if(added > current->busiest[i]) {
+                current->busiest[i] = added;
+            }
+            total += added;
+        }
+        else {
+            current->otherReads[i] += added;
+        }
+    }
+    if(sameRun) {
+        current->ticks++;
+        current->histogram[total < READ_HISTOGRAM_BUCKETS ? total : READ_HISTOGRAM_BUCKETS - 1]++;
+        if(total > current->busiestTotal) {
+            current->busiestTotal = total;
+        }
+    }
+    lastTick = now;
+}
+
+//Background tasks didn't get the tick time before the control loop's tasks were given it
+void markTick(void *data) {
+    markTick(data, simulator().now());
+}
+
+/** readRun
+    Runs the mission once, counting the reads each tick makes
+    @param seed Simulator seed
+    @param run Filled in with the run's reads
+*/
+static void readRun(unsigned int seed, ReadRun *run) {
+    SimConfig config = defaultConfig();
+    config.seed = seed;
+    config.echoLcd = false;
+    config.tracePeriod = 0;
+    simulator().reset(config);
+    current = run;
+    lastTick = -1;
+    controlLoop.addTask(markTick, 0);
+    run->ended = true;
+    try {
+        robot_main();
+    }
+    catch(const SimulationEnded &) {
+        run->ended = false;
+    }
+    //Whatever the last loop's final tick read, and everything after it
+    for(int i = 0; i < SIM_READ_KINDS; i++) {
+        run->otherReads[i] += simulator().getReads((SimRead)i) - lastReads[i];
+    }
+    run->courseTime = simulator().now();
+}
+
+int main(int argc, char **argv) {
+    int runs = 10;
+    unsigned int seed = 1;
+    for(int i = 1; i < argc; i++) {
+        if(strcmp(argv[i], "--runs") == 0 && i + 1 < argc) {
+            runs = atoi(argv[++i]);
+        }
+        else if(strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = (unsigned int)atoi(argv[++i]);
+        }
+        else {
+            fprintf(stderr, "Usage: readbench [--runs N] [--seed S]\n");
+            return 2;
+        }
+    }
+
+    ReadRun sum;
+    memset(&sum, 0, sizeof(sum));
+    int ended = 0;
+    int crashed = 0;
+    for(int r = 0; r < runs; r++) {
+        ReadRun run;
+        memset(&run, 0, sizeof(run));
+        if(!runForked([&](ReadRun *result) { readRun(seed + r, result); }, &run)) {
+            crashed++;
+            continue;
+        }
+        ended += run.ended;
+        sum.courseTime += run.courseTime;
+        sum.ticks += run.ticks;
+        for(int i = 0; i < SIM_READ_KINDS; i++) {
+            sum.loopReads[i] += run.loopReads[i];
+            sum.otherReads[i] += run.otherReads[i];
+            if(run.busiest[i] > sum.busiest[i]) {
+                sum.busiest[i] = run.busiest[i];
+            }
+        }
+        if(run.busiestTotal > sum.busiestTotal) {
+            sum.busiestTotal = run.busiestTotal;
+        }
+        for(int b = 0; b < READ_HISTOGRAM_BUCKETS; b++) {
+            sum.histogram[b] += run.histogram[b];
+        }
+    }
+    int counted = runs - crashed;
+    if(counted == 0 || sum.ticks == 0) {
+        fprintf(stderr, "readbench: no run reached the control loop\n");
+        return 1;
+    }
+
+    printf("%d runs from seed %u: %d ended, %d hit the time limit, %d crashed, %.2f s and %.0f ticks per run\n",
+           runs, seed, ended, counted - ended, crashed, sum.courseTime / counted, (double)sum.ticks / counted);
+    printf("reads       per tick  busiest tick  outside loop per run\n");
+    unsigned long loopTotal = 0;
+    unsigned long otherTotal = 0;
+    for(int i = 0; i < SIM_READ_KINDS; i++) {
+        printf("%-10s  %8.2f  %12lu  %20.0f\n", READ_NAMES[i], (double)sum.loopReads[i] / sum.ticks, sum.busiest[i],
+               (double)sum.otherReads[i] / counted);
+        loopTotal += sum.loopReads[i];
+        otherTotal += sum.otherReads[i];
+    }
+    printf("%-10s  %8.2f  %12lu  %20.0f\n", "total", (double)loopTotal / sum.ticks, sum.busiestTotal,
+           (double)otherTotal / counted);
+    printf("ticks by reads:");
+    for(int b = 0; b < READ_HISTOGRAM_BUCKETS; b++) {
+        printf(" %s%d:%.1f%%", b == READ_HISTOGRAM_BUCKETS - 1 ? ">=" : "", b, 100. * sum.histogram[b] / sum.ticks);
+    }
+    printf("\n");
+    return 0;
+}
@@ -0,0 +1,163 @@
+/**
+ * RPS dropout tests. Runs correctPosition() and goToLight() from the robot program on the simulator with
+ * RPS cut off for a while, for good, and at random, and checks that they wait for it to come back, give
+ * up when it doesn't, and carry on without it where they don't need it.
+ *
+ * The robot program is compiled in like the benchmark's, and each case runs in a forked child so it
+ * starts with fresh globals:
+ *
+ *     g++ -std=c++14 -O2 -Isim sim/rpstest.cpp sim/simulator.cpp sim/feh.cpp sim/course.cpp -o rpstest
+ *     ./rpstest
+ */
+#define BENCHMARK
+#define main robot_main
+#include "../robot.cpp"
+#undef main
+
+#include "simulator.h"
+#include "check.h"
+#include <stdlib.h>
+
+//Where the correction cases start: the benchmark's rpsCorrection spot, facing -y with room ahead
+#define CORRECTION_X 29.3
+#define CORRECTION_Y 20
+#define CORRECTION_TARGET 17
+//Where goToLight starts: on the fuel light's yellow line, facing the light
+#define LIGHT_START_Y 48.5
+//How far the true position may be from the target once RPS says it is within tolerance (in inches)
+#define POSITION_SLACK 0.75
+
+/** runConfig
+    @return A configuration with the robot set down at a pose and no setup menu, for the case to change
+            the RPS settings of before startRun()
+*/
+static SimConfig runConfig(unsigned int seed, float x, float y, float heading) {
+    SimConfig config = defaultConfig();
+    config.seed = seed;
+    config.echoLcd = false;
+    config.tracePeriod = 0;
+    config.touchCount = 0;
+    config.startX = x;
+    config.startY = y;
+    config.startHeading = heading;
+    return config;
+}
+
+/** startRun
+    Resets the simulator and runs initialize()
+*/
+static void startRun(const SimConfig &config) {
+    simulator().reset(config);
+    initialize();
+}
+
+static void testShortOutage() {
+    //RPS is out for less than MOTION_RPS_LOST_TIME from the start: the correction waits and then finishes
+    SimConfig config = runConfig(1, CORRECTION_X, CORRECTION_Y, 270);
+    config.rpsOutageStart = 0;
+    config.rpsOutageEnd = 0.6 * MOTION_RPS_LOST_TIME;
+    startRun(config);
+    MotionResult result = check_y_minus(CORRECTION_TARGET);
+    CHECK(result.completed);
+    CHECK(!result.rpsLost);
+    CHECK(!result.timedOut);
+    //It can't have finished before RPS came back
+    CHECK(TimeNow() >= config.rpsOutageEnd);
+    CHECK_NEAR(simulator().getState().y, CORRECTION_TARGET, POSITION_SLACK);
+}
+
+static void testOutageBetweenMoves() {
+    //RPS drops out just after the first move starts, while the correction waits for it to catch up
+    SimConfig config = runConfig(2, CORRECTION_X, CORRECTION_Y, 270);
+    config.rpsOutageStart = 0.3;
+    config.rpsOutageEnd = 0.3 + 0.6 * MOTION_RPS_LOST_TIME;
+    startRun(config);
+    MotionResult result = check_y_minus(CORRECTION_TARGET);
+    CHECK(result.completed);
+    CHECK(!result.rpsLost);
+    CHECK_NEAR(simulator().getState().y, CORRECTION_TARGET, POSITION_SLACK);
+}
+
+static void testLongOutage() {
+    //RPS never comes back: the correction gives up after MOTION_RPS_LOST_TIME without moving blind
+    SimConfig config = runConfig(3, CORRECTION_X, CORRECTION_Y, 270);
+    config.rpsOutageStart = 0;
+    config.rpsOutageEnd = 1000;
+    startRun(config);
+    MotionResult result = check_y_minus(CORRECTION_TARGET);
+    CHECK(!result.completed);
+    CHECK(result.rpsLost);
+    CHECK(!result.timedOut);
+    CHECK(result.elapsed >= MOTION_RPS_LOST_TIME);
+    CHECK(result.elapsed < MOTION_RPS_LOST_TIME + 0.25);
+    CHECK_NEAR(simulator().getState().y, CORRECTION_Y, 0.1);
+    CHECK(simulator().getState().leftPercent == 0 && simulator().getState().rightPercent == 0);
+}
+
+static void testRandomDropout() {
+    //Most readings missing, but never for long: every seed still gets there
+    for(unsigned int seed = 1; seed <= 5; seed++) {
+        checkForked("random dropout", [&]() {
+            SimConfig config = runConfig(seed, CORRECTION_X, CORRECTION_Y, 270);
+            config.rpsDropoutRate = 0.6;
+            startRun(config);
+            MotionResult result = check_y_minus(CORRECTION_TARGET);
+            CHECK(result.completed);
+            CHECK(!result.rpsLost);
+            CHECK_NEAR(simulator().getState().y, CORRECTION_TARGET, POSITION_SLACK);
+        });
+    }
+}
+
+/**
+ * This is a struct which a goToLight() child sends back.
+ */
+struct LightRun
+{
+    int lightColor;
+    float x, y;
+    double time;
+};
+
+static void runLight(unsigned int seed, bool rps, LightRun *run) {
+    SimConfig config = runConfig(seed, FUEL_LINE_X, LIGHT_START_Y, 90);
+    if(!rps) {
+        config.rpsOutageStart = 0;
+        config.rpsOutageEnd = 1000;
+    }
+    startRun(config);
+    double start = TimeNow();
+    goToLight();
+    run->lightColor = lightColor;
+    run->x = simulator().getState().x;
+    run->y = simulator().getState().y;
+    run->time = TimeNow() - start;
+}
+
+static void testLightWithoutRps() {
+    //goToLight only needs the line and the CdS cell, so with no RPS at all it reads the same color, ends up
+    //in the same place and takes as long as with it
+    for(unsigned int seed = 1; seed <= 4; seed++) {
+        LightRun with, without;
+        bool ran = runForked([&](LightRun *run) { runLight(seed, true, run); }, &with) &&
+                   runForked([&](LightRun *run) { runLight(seed, false, run); }, &without);
+        if(!CHECK(ran)) {
+            continue;
+        }
+        CHECK(without.lightColor == with.lightColor);
+        CHECK_NEAR(without.x, with.x, POSITION_SLACK);
+        CHECK_NEAR(without.y, with.y, POSITION_SLACK);
+        CHECK_NEAR(without.time, with.time, 0.25);
+    }
+}
+
+int main() {
+    //No calibration or gains on the SD card, so every case uses the built in constants
+    setenv("SIM_SD", "/nonexistent", 1);
+    checkForked("short outage", testShortOutage);
+    checkForked("outage between moves", testOutageBetweenMoves);
+    checkForked("long outage", testLongOutage);
+    testRandomDropout();
+    testLightWithoutRps();
+    return checkSummary("rpstest");
+}
@@ -0,0 +1,176 @@
+/**
+ * Control loop tests. Runs ControlLoop against the simulator's TimeNow() and Sleep(), which only move a
+ * virtual clock, and checks the tick rate, the spacing and jitter of ticks, overrun counting, the order
+ * background tasks run in and the task limit.
+ *
+ *     g++ -std=c++14 -O2 -Isim sim/schedulertest.cpp sim/simulator.cpp sim/feh.cpp sim/course.cpp -o schedulertest
+ *     ./schedulertest
+ */
+#include "../scheduler.h"
+#include "simulator.h"
+#include "check.h"
+#include <vector>
+
+Bench bench;
+
+//Slack for the virtual time TimeNow() itself costs (in seconds)
+#define TICK_SLACK 1e-5
+
+static void startRun() {
+    SimConfig config = defaultConfig();
+    config.echoLcd = false;
+    config.tracePeriod = 0;
+    simulator().reset(config);
+}
+
+/**
+ * This is a struct which notes what the background and idle tasks saw.
+ */
+struct TaskLog
+{
+    std::vector<double> times;
+    std::vector<int> order;
+    unsigned long idleCalls;
+};
+
+static TaskLog taskLog;
+
+static void firstTask(void *, double now) {
+    taskLog.times.push_back(now);
+    taskLog.order.push_back(1);
+}
+
+static void secondTask(void *, double) {
+    taskLog.order.push_back(2);
+}
+
+static void countIdle(void *, double) {
+    taskLog.idleCalls++;
+}
+
+static void doNothing(void *, double) {
+}
+
+/** runFor
+    Runs a loop for a while, noting the time of every tick
+    @return The tick times
+*/
+static std::vector<double> runFor(ControlLoop &loop, double seconds) {
+    std::vector<double> ticks;
+    double start = TimeNow();
+    loop.run([&](double now) {
+        ticks.push_back(now);
+        return now - start < seconds;
+    });
+    return ticks;
+}
+
+static void testRate(double period) {
+    startRun();
+    ControlLoop loop(period);
+    std::vector<double> ticks = runFor(loop, 1);
+    CHECK_NEAR(ticks.size(), 1 / period + 1, 1);
+    CHECK(loop.getTicks() == ticks.size());
+    CHECK(loop.getOverruns() == 0);
+    CHECK(loop.getMaxJitter() < TICK_SLACK);
+    double shortest = 1, longest = 0;
+    for(size_t i = 1; i < ticks.size(); i++) {
+        double gap = ticks[i] - ticks[i - 1];
+        shortest = gap < shortest ? gap : shortest;
+        longest = gap > longest ? gap : longest;
+    }
+    CHECK_NEAR(shortest, period, TICK_SLACK);
+    CHECK_NEAR(longest, period, TICK_SLACK);
+}
+
+/** runSlow
+    Runs a loop for half a second where every tenth tick's primitive takes longer than it should
+    @param cost How long the slow ticks take (in periods)
+    @param slow Set to how many ticks were slow
+    @return The tick times
+*/
+static std::vector<double> runSlow(ControlLoop &loop, double cost, int &slow) {
+    std::vector<double> ticks;
+    slow = 0;
+    double start = TimeNow();
+    loop.run([&](double now) {
+        ticks.push_back(now);
+        if(ticks.size() % 10 == 0) {
+            Sleep(cost * CONTROL_PERIOD);
+            slow++;
+        }
+        return now - start < 0.5;
+    });
+    return ticks;
+}
+
+static void testOverruns() {
+    //Under a period late: no overrun, and the next tick comes early to keep the loop on its schedule
+    startRun();
+    ControlLoop loop;
+    int slow;
+    std::vector<double> ticks = runSlow(loop, 1.5, slow);
+    CHECK(loop.getOverruns() == 0);
+    CHECK_NEAR(loop.getMaxJitter(), 0.5 * CONTROL_PERIOD, TICK_SLACK);
+    CHECK_NEAR(ticks.size(), 0.5 / CONTROL_PERIOD + 1, 1);
+
+    //Over a period late: every slow tick is an overrun, and the count restarts from the late tick instead
+    //of running the missed ticks back to back
+    startRun();
+    loop.resetStats();
+    CHECK(loop.getTicks() == 0);
+    CHECK(loop.getOverruns() == 0);
+    CHECK(loop.getMaxJitter() == 0);
+    ticks = runSlow(loop, 2.5, slow);
+    CHECK(slow > 0);
+    //A slow last tick ends the loop before its lateness shows up
+    int lastSlow = ticks.size() % 10 == 0 ? 1 : 0;
+    CHECK(loop.getOverruns() == (unsigned long)(slow - lastSlow));
+    CHECK_NEAR(loop.getMaxJitter(), 1.5 * CONTROL_PERIOD, TICK_SLACK);
+    bool burst = false;
+    for(size_t i = 1; i < ticks.size(); i++) {
+        if(ticks[i] - ticks[i - 1] < CONTROL_PERIOD - TICK_SLACK) {
+            burst = true;
+        }
+    }
+    CHECK(!burst);
+}
+
+static void testTasks() {
+    startRun();
+    ControlLoop loop;
+    taskLog = TaskLog();
+    taskLog.idleCalls = 0;
+    CHECK(loop.addTask(firstTask, 0));
+    CHECK(loop.addTask(secondTask, 0));
+    loop.setIdleTask(countIdle, 0);
+    std::vector<double> ticks = runFor(loop, 0.1);
+    //Both tasks run once per tick, in the order they were added, with the tick's time, before the primitive
+    CHECK(taskLog.times.size() == ticks.size());
+    CHECK(taskLog.order.size() == 2 * ticks.size());
+    bool ordered = true;
+    for(size_t i = 0; i + 1 < taskLog.order.size(); i += 2) {
+        ordered = ordered && taskLog.order[i] == 1 && taskLog.order[i + 1] == 2;
+    }
+    CHECK(ordered);
+    bool sameTime = true;
+    for(size_t i = 0; i < ticks.size() && i < taskLog.times.size(); i++) {
+        sameTime = sameTime && taskLog.times[i] == ticks[i];
+    }
+    CHECK(sameTime);
+    CHECK(taskLog.idleCalls > ticks.size());
+
+    ControlLoop full;
+    for(int i = 0; i < MAX_BACKGROUND_TASKS; i++) {
+        CHECK(full.addTask(doNothing, 0));
+    }
+    CHECK(!full.addTask(doNothing, 0));
+}
+
+int main() {
+    testRate(CONTROL_PERIOD);
+    testRate(0.001);
+    testOverruns();
+    testTasks();
+    return checkSummary("schedulertest");
+}
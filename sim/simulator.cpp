@@ -0,0 +1,591 @@
+#include "simulator.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <exception>
+
+//Where the bump switches and corners of the robot are (inches forward and left of the wheel axle)
+#define BUMPER_FORWARD 4.0
+#define BUMPER_SIDE 2.5
+#define REAR_BACK 3.0
+//Distance from a wall at which a point on the robot touches it
+#define WALL_CONTACT 0.25
+//Extra distance a bump switch arm reaches
+#define BUMP_TRAVEL 0.05
+//Where the optosensors are (inches forward and left of the wheel axle)
+#define LINE_SENSOR_FORWARD 3.5
+#define LINE_SENSOR_SPACING 0.6
+#define LINE_SENSOR_SPOT 0.15
+//Where the CdS cells are
+#define FUEL_CDS_FORWARD 3.5
+#define START_CDS_FORWARD 0
+//CdS readings
+#define CDS_AMBIENT 2.4
+#define CDS_RED 0.45
+#define CDS_BLUE 0.95
+#define CDS_START_LIGHT 0.4
+//How long the operator takes to set the robot down and touch the screen
+#define OPERATOR_DELAY 2.0
+
+static const float DEGREES = 180 / 3.14159265358979323846;
+
+static float pointSegmentDistance(float px, float py, float x1, float y1, float x2, float y2) {
+    float dx = x2 - x1;
+    float dy = y2 - y1;
+    float lengthSquared = dx * dx + dy * dy;
+    float t = 0;
+    if(lengthSquared > 0) {
+        t = ((px - x1) * dx + (py - y1) * dy) / lengthSquared;
+        if(t < 0) {
+            t = 0;
+        }
+        else if(t > 1) {
+            t = 1;
+        }
+    }
+    float cx = x1 + t * dx - px;
+    float cy = y1 + t * dy - py;
+    return sqrt(cx * cx + cy * cy);
+}
+
+static float wrapHeading(float degrees) {
+    degrees = fmod(degrees, 360);
+    if(degrees < 0) {
+        degrees += 360;
+    }
+    return degrees;
+}
+
+static void endedByTimeLimit() {
+    try {
+        throw;
+    }
+    catch(const SimulationEnded &ended) {
+        fflush(stdout);
+        const SimState &state = simulator().getState();
+        fprintf(stderr, "sim: time limit reached at %.3f s with the robot at (%.2f, %.2f) heading %.1f\n",
+                ended.time, state.x, state.y, state.heading);
+        _Exit(2);
+    }
+    catch(...) {
+    }
+    fprintf(stderr, "sim: uncaught exception\n");
+    abort();
+}
+
+Simulator &simulator() {
+    static Simulator sim;
+    return sim;
+}
+
+Simulator::Simulator() {
+    SimConfig config = defaultConfig();
+    if(getenv("SIM_SEED")) {
+        config.seed = strtoul(getenv("SIM_SEED"), 0, 10);
+    }
+    if(getenv("SIM_QUIET")) {
+        config.echoLcd = false;
+    }
+    if(getenv("SIM_TRACE")) {
+        config.tracePeriod = atof(getenv("SIM_TRACE"));
+    }
+    if(getenv("SIM_RPS_DROPOUT")) {
+        config.rpsDropoutRate = atof(getenv("SIM_RPS_DROPOUT"));
+    }
+    std::set_terminate(endedByTimeLimit);
+    reset(config);
+}
+
+Simulator::~Simulator() {
+    if(config.echoLcd) {
+        fflush(stdout);
+        fprintf(stderr, "sim: program ended at %.3f s with the robot at (%.2f, %.2f) heading %.1f\n",
+                state.time, state.x, state.y, state.heading);
+    }
+}
+
+void Simulator::reset(const SimConfig &config) {
+    this->config = config;
+    rng = config.seed * 2654435761ULL + 88172645463325252ULL;
+    if(this->config.fuelLightColor < 0) {
+        this->config.fuelLightColor = uniform() < 0.5 ? 0 : 1;
+    }
+    for(int i = 0; i < 3; i++) {
+        if(this->config.switchDirections[i] < 1) {
+            this->config.switchDirections[i] = uniform() < 0.5 ? 1 : 2;
+        }
+    }
+
+    state.time = 0;
+    state.leftPercent = state.rightPercent = 0;
+    state.leftTravel = state.rightTravel = 0;
+    state.leftCounts = state.rightCounts = 0;
+    state.armDegree = state.armTarget = 90;
+    state.started = false;
+    physicsTime = 0;
+    ended = false;
+    nextTrace = 0;
+    leftOffset = rightOffset = 0;
+    touchesUsed = 0;
+    touchReadyTime = -1;
+    setupDoneTime = config.touchCount > 0 ? -1 : 0;
+    lcdLineStarted = false;
+    for(int i = 0; i < SIM_READ_KINDS; i++) {
+        reads[i] = 0;
+    }
+    placeRobot(config.startX + gaussian(config.startPoseError), config.startY + gaussian(config.startPoseError),
+               config.startHeading);
+}
+
+void Simulator::placeRobot(float x, float y, float heading) {
+    state.x = x;
+    state.y = y;
+    state.heading = wrapHeading(heading);
+    state.leftVelocity = state.rightVelocity = 0;
+    state.frontLeftPressed = state.frontRightPressed = false;
+    //Start the RPS history over so old poses don't show up after the robot is moved
+    rpsNewest = 0;
+    rpsSamples[0].time = -1;
+    rpsSamples[0].valid = false;
+    nextRpsSample = state.time;
+}
+
+void Simulator::advance(double seconds) {
+    state.time += seconds;
+    if(state.time > config.timeLimit && !ended) {
+        //Only thrown once, so code that runs while the exception unwinds can still call in
+        ended = true;
+        throw SimulationEnded(state.time);
+    }
+    while(physicsTime + SIM_STEP <= state.time) {
+        step(SIM_STEP);
+        physicsTime += SIM_STEP;
+        if(config.tracePeriod > 0 && physicsTime >= nextTrace) {
+            fprintf(stderr, "sim: %8.3f pose %6.2f %6.2f %5.1f motors %4.0f %4.0f bumps %d %d\n", physicsTime,
+                    state.x, state.y, state.heading, state.leftPercent, state.rightPercent,
+                    state.frontLeftPressed, state.frontRightPressed);
+            nextTrace += config.tracePeriod;
+        }
+    }
+}
+
+float Simulator::uniform() {
+    //xorshift64*
+    rng ^= rng >> 12;
+    rng ^= rng << 25;
+    rng ^= rng >> 27;
+    return ((rng * 2685821657736338717ULL) >> 40) / (float)(1 << 24);
+}
+
+float Simulator::gaussian(float deviation) {
+    if(deviation <= 0) {
+        return 0;
+    }
+    float u1 = uniform();
+    float u2 = uniform();
+    if(u1 < 1e-7) {
+        u1 = 1e-7;
+    }
+    return deviation * sqrt(-2 * log(u1)) * cos(2 * 3.14159265358979323846 * u2);
+}
+
+void Simulator::robotToCourse(float forward, float left, float *x, float *y) const {
+    float c = cos(state.heading / DEGREES);
+    float s = sin(state.heading / DEGREES);
+    *x = state.x + forward * c - left * s;
+    *y = state.y + forward * s + left * c;
+}
+
+bool Simulator::collides(float x, float y, float heading, float *penetration) {
+    static const float points[4][2] = {
+        {BUMPER_FORWARD, BUMPER_SIDE}, {BUMPER_FORWARD, -BUMPER_SIDE},
+        {-REAR_BACK, BUMPER_SIDE}, {-REAR_BACK, -BUMPER_SIDE}
+    };
+    float c = cos(heading / DEGREES);
+    float s = sin(heading / DEGREES);
+    float total = 0;
+    for(int p = 0; p < 4; p++) {
+        float px = x + points[p][0] * c - points[p][1] * s;
+        float py = y + points[p][0] * s + points[p][1] * c;
+        for(int w = 0; w < config.course.wallCount; w++) {
+            const SimWall &wall = config.course.walls[w];
+            float depth = WALL_CONTACT - pointSegmentDistance(px, py, wall.x1, wall.y1, wall.x2, wall.y2);
+            if(depth > 0) {
+                total += depth;
+            }
+        }
+    }
+    //Wall ends poking in between the corners
+    for(int w = 0; w < config.course.wallCount; w++) {
+        const SimWall &wall = config.course.walls[w];
+        for(int end = 0; end < 2; end++) {
+            float dx = (end == 0 ? wall.x1 : wall.x2) - x;
+            float dy = (end == 0 ? wall.y1 : wall.y2) - y;
+            float forward = dx * c + dy * s;
+            float left = -dx * s + dy * c;
+            float depth = fmin(fmin(forward + REAR_BACK, BUMPER_FORWARD - forward),
+                               fmin(left + BUMPER_SIDE, BUMPER_SIDE - left)) + WALL_CONTACT;
+            if(depth > 0) {
+                total += depth;
+            }
+        }
+    }
+    *penetration = total;
+    return total > 0;
+}
+
+bool Simulator::slide(float heading, float distance, float before) {
+    //Try pushing off the wall a little in each direction, like the robot scraping along it
+    float after;
+    for(int i = 0; i < 8; i++) {
+        float direction = i * 45 / DEGREES;
+        float x = state.x + distance * cos(direction);
+        float y = state.y + distance * sin(direction);
+        if(collides(x, y, heading, &after), after <= before + 1e-6) {
+            state.x = x;
+            state.y = y;
+            state.heading = heading;
+            return true;
+        }
+    }
+    return false;
+}
+
+static float wheelTarget(float percent, float gain, const SimConfig &config) {
+    float magnitude = fabs(percent);
+    if(magnitude <= config.motorDeadband) {
+        return 0;
+    }
+    float speed = (magnitude - config.motorDeadband) / (100 - config.motorDeadband) * config.maxWheelSpeed * gain;
+    return percent > 0 ? speed : -speed;
+}
+
+void Simulator::step(float dt) {
+    float blend = dt / config.motorTimeConstant;
+    if(blend > 1) {
+        blend = 1;
+    }
+    state.leftVelocity += (wheelTarget(state.leftPercent, config.leftMotorGain, config) - state.leftVelocity) * blend;
+    state.rightVelocity += (wheelTarget(state.rightPercent, config.rightMotorGain, config) - state.rightVelocity) * blend;
+
+    float leftTurn = state.leftVelocity * dt;
+    float rightTurn = state.rightVelocity * dt;
+    if(leftTurn != 0 || rightTurn != 0) {
+        //Slip makes the robot move less than its wheels turned
+        float leftMove = leftTurn * (1 - fabs(gaussian(config.wheelSlip)));
+        float rightMove = rightTurn * (1 - fabs(gaussian(config.wheelSlip)));
+        float rotation = (rightMove - leftMove) / config.trackWidth * DEGREES;
+        float distance = (leftMove + rightMove) / 2;
+        float direction = (state.heading + rotation / 2) / DEGREES;
+        float newX = state.x + distance * cos(direction);
+        float newY = state.y + distance * sin(direction);
+        float newHeading = wrapHeading(state.heading + rotation);
+
+        float before, after;
+        collides(state.x, state.y, state.heading, &before);
+        collides(newX, newY, newHeading, &after);
+        bool moved = true;
+        if(after <= before + 1e-6) {
+            state.x = newX;
+            state.y = newY;
+            state.heading = newHeading;
+        }
+        else if(collides(state.x, state.y, newHeading, &after), after <= before + 1e-6) {
+            //Pinned against a wall, but it can still pivot
+            state.heading = newHeading;
+        }
+        else if(slide(newHeading, fabs(distance) + fabs(rotation / DEGREES) * BUMPER_FORWARD, before)) {
+            //Scraped along the wall
+        }
+        else {
+            //Stalled against a wall, so the wheels stop and the encoders don't count
+            moved = false;
+            state.leftVelocity = 0;
+            state.rightVelocity = 0;
+        }
+        if(moved) {
+            state.leftTravel += fabs(leftTurn);
+            state.rightTravel += fabs(rightTurn);
+        }
+    }
+
+    //Bump switches close when their arm reaches a wall
+    float fx, fy;
+    state.frontLeftPressed = false;
+    state.frontRightPressed = false;
+    for(int side = 0; side < 2; side++) {
+        robotToCourse(BUMPER_FORWARD, side == 0 ? BUMPER_SIDE : -BUMPER_SIDE, &fx, &fy);
+        for(int w = 0; w < config.course.wallCount; w++) {
+            const SimWall &wall = config.course.walls[w];
+            if(pointSegmentDistance(fx, fy, wall.x1, wall.y1, wall.x2, wall.y2) < WALL_CONTACT + BUMP_TRAVEL) {
+                if(side == 0) {
+                    state.frontLeftPressed = true;
+                }
+                else {
+                    state.frontRightPressed = true;
+                }
+            }
+        }
+    }
+
+    float armStep = config.servoSpeed * dt;
+    if(fabs(state.armTarget - state.armDegree) <= armStep) {
+        state.armDegree = state.armTarget;
+    }
+    else {
+        state.armDegree += state.armTarget > state.armDegree ? armStep : -armStep;
+    }
+
+    if(setupDoneTime >= 0 && physicsTime >= setupDoneTime + config.startDelay) {
+        state.started = true;
+    }
+    if(physicsTime >= nextRpsSample) {
+        updateRps();
+        nextRpsSample += 1 / config.rpsRate;
+    }
+}
+
+void Simulator::updateRps() {
+    rpsNewest = (rpsNewest + 1) % 64;
+    RpsSample &sample = rpsSamples[rpsNewest];
+    sample.time = physicsTime;
+    sample.x = state.x + gaussian(config.rpsNoise);
+    sample.y = state.y + gaussian(config.rpsNoise);
+    sample.heading = wrapHeading(state.heading + gaussian(config.rpsHeadingNoise));
+    sample.valid = uniform() >= config.rpsDropoutRate;
+    if(physicsTime >= config.rpsOutageStart && physicsTime < config.rpsOutageEnd) {
+        sample.valid = false;
+    }
+    for(int i = 0; i < config.course.deadZoneCount; i++) {
+        if(inZone(config.course.deadZones[i])) {
+            sample.valid = false;
+        }
+    }
+}
+
+float Simulator::lineReading(float sensorX, float sensorY) {
+    const SimCourse &course = config.course;
+    float floor = sensorY >= course.upperLevelY ? course.upperFloorReading : course.lowerFloorReading;
+    float reading = floor;
+    float bestCoverage = 0;
+    for(int i = 0; i < course.lineCount; i++) {
+        const SimLine &line = course.lines[i];
+        float distance = pointSegmentDistance(sensorX, sensorY, line.x1, line.y1, line.x2, line.y2);
+        //Fraction of the sensor's spot that is over the line
+        float coverage = (line.width / 2 + LINE_SENSOR_SPOT - distance) / (2 * LINE_SENSOR_SPOT);
+        if(coverage > 1) {
+            coverage = 1;
+        }
+        if(coverage > bestCoverage) {
+            bestCoverage = coverage;
+            reading = floor + coverage * (line.reading - floor);
+        }
+    }
+    return reading + gaussian(config.analogNoise);
+}
+
+int Simulator::encoderCounts(FEHIO::FEHIOPin pin) {
+    advance(config.digitalReadCost);
+    SimDevice device = config.wiring.pins[pin];
+    if(device == SIM_LEFT_ENCODER) {
+        state.leftCounts = (int)(state.leftTravel * config.countsPerInch) - leftOffset;
+        return state.leftCounts;
+    }
+    if(device == SIM_RIGHT_ENCODER) {
+        state.rightCounts = (int)(state.rightTravel * config.countsPerInch) - rightOffset;
+        return state.rightCounts;
+    }
+    return 0;
+}
+
+void Simulator::resetEncoder(FEHIO::FEHIOPin pin) {
+    advance(config.digitalReadCost);
+    SimDevice device = config.wiring.pins[pin];
+    if(device == SIM_LEFT_ENCODER) {
+        leftOffset = (int)(state.leftTravel * config.countsPerInch);
+    }
+    else if(device == SIM_RIGHT_ENCODER) {
+        rightOffset = (int)(state.rightTravel * config.countsPerInch);
+    }
+}
+
+bool Simulator::digitalValue(FEHIO::FEHIOPin pin) {
+    advance(config.digitalReadCost);
+    SimDevice device = config.wiring.pins[pin];
+    //Switches are wired so the pin reads high until they are pressed
+    if(device == SIM_FRONT_LEFT_BUMP) {
+        return !state.frontLeftPressed;
+    }
+    if(device == SIM_FRONT_RIGHT_BUMP) {
+        return !state.frontRightPressed;
+    }
+    return true;
+}
+
+float Simulator::analogValue(FEHIO::FEHIOPin pin) {
+    advance(config.analogReadCost);
+    float x, y;
+    switch(config.wiring.pins[pin]) {
+        case SIM_LINE_LEFT:
+            robotToCourse(LINE_SENSOR_FORWARD, LINE_SENSOR_SPACING, &x, &y);
+            return lineReading(x, y);
+        case SIM_LINE_MIDDLE:
+            robotToCourse(LINE_SENSOR_FORWARD, 0, &x, &y);
+            return lineReading(x, y);
+        case SIM_LINE_RIGHT:
+            robotToCourse(LINE_SENSOR_FORWARD, -LINE_SENSOR_SPACING, &x, &y);
+            return lineReading(x, y);
+        case SIM_FUEL_CDS: {
+            robotToCourse(FUEL_CDS_FORWARD, 0, &x, &y);
+            float distance = sqrt((x - config.course.fuelLightX) * (x - config.course.fuelLightX)
+                                  + (y - config.course.fuelLightY) * (y - config.course.fuelLightY));
+            float lit = config.fuelLightColor == 0 ? CDS_RED : CDS_BLUE;
+            float reading = CDS_AMBIENT;
+            if(distance < 1) {
+                reading = lit;
+            }
+            else if(distance < 4) {
+                reading = lit + (distance - 1) / 3 * (CDS_AMBIENT - lit);
+            }
+            return reading + gaussian(config.analogNoise);
+        }
+        case SIM_START_CDS: {
+            robotToCourse(START_CDS_FORWARD, 0, &x, &y);
+            float distance = sqrt((x - config.course.startLightX) * (x - config.course.startLightX)
+                                  + (y - config.course.startLightY) * (y - config.course.startLightY));
+            float reading = state.started && distance < 4 ? CDS_START_LIGHT : CDS_AMBIENT;
+            return reading + gaussian(config.analogNoise);
+        }
+        default:
+            return 0;
+    }
+}
+
+void Simulator::setMotor(FEHMotor::FEHMotorPort port, float percent) {
+    advance(config.motorWriteCost);
+    if(percent > 100) {
+        percent = 100;
+    }
+    else if(percent < -100) {
+        percent = -100;
+    }
+    SimDevice device = config.wiring.motors[port];
+    if(device == SIM_LEFT_WHEEL) {
+        state.leftPercent = percent;
+    }
+    else if(device == SIM_RIGHT_WHEEL) {
+        state.rightPercent = percent;
+    }
+}
+
+void Simulator::setServo(FEHServo::FEHServoPort port, float degree) {
+    advance(config.motorWriteCost);
+    if(config.wiring.servos[port] == SIM_ARM) {
+        state.armTarget = degree;
+    }
+}
+
+float Simulator::rpsX() {
+    advance(config.rpsReadCost);
+    //Newest sample that has made it through the RPS latency
+    for(int i = 0; i < 64; i++) {
+        const RpsSample &sample = rpsSamples[(rpsNewest - i + 64) % 64];
+        if(sample.time < 0) {
+            break;
+        }
+        if(sample.time <= state.time - config.rpsLatency) {
+            return sample.valid ? sample.x : -1;
+        }
+    }
+    return -1;
+}
+
+float Simulator::rpsY() {
+    advance(config.rpsReadCost);
+    for(int i = 0; i < 64; i++) {
+        const RpsSample &sample = rpsSamples[(rpsNewest - i + 64) % 64];
+        if(sample.time < 0) {
+            break;
+        }
+        if(sample.time <= state.time - config.rpsLatency) {
+            return sample.valid ? sample.y : -1;
+        }
+    }
+    return -1;
+}
+
+float Simulator::rpsHeading() {
+    advance(config.rpsReadCost);
+    for(int i = 0; i < 64; i++) {
+        const RpsSample &sample = rpsSamples[(rpsNewest - i + 64) % 64];
+        if(sample.time < 0) {
+            break;
+        }
+        if(sample.time <= state.time - config.rpsLatency) {
+            return sample.valid ? sample.heading : -1;
+        }
+    }
+    return -1;
+}
+
+char Simulator::rpsCourse() {
+    advance(config.rpsReadCost);
+    return config.courseLetter;
+}
+
+int Simulator::switchDirection(int which) {
+    advance(config.rpsReadCost);
+    return config.switchDirections[which];
+}
+
+bool Simulator::touch(float *x, float *y) {
+    advance(config.digitalReadCost);
+    if(touchesUsed >= config.touchCount) {
+        return false;
+    }
+    const SimTouch &next = config.touches[touchesUsed];
+    if(touchReadyTime < 0) {
+        //The operator sets the robot down, waits for RPS, then touches the screen
+        placeRobot(next.robotX, next.robotY, next.robotHeading);
+        touchReadyTime = state.time + OPERATOR_DELAY;
+        return false;
+    }
+    if(state.time < touchReadyTime) {
+        return false;
+    }
+    *x = next.screenX;
+    *y = next.screenY;
+    touchesUsed++;
+    touchReadyTime = -1;
+    if(touchesUsed == config.touchCount) {
+        placeRobot(config.startX + gaussian(config.startPoseError), config.startY + gaussian(config.startPoseError),
+                   config.startHeading);
+        setupDoneTime = state.time;
+    }
+    return true;
+}
+
+void Simulator::lcdWrite(const char *text, bool newLine) {
+    advance(config.lcdWriteCost);
+    if(!config.echoLcd) {
+        return;
+    }
+    if(!lcdLineStarted) {
+        printf("[%9.3f] ", state.time);
+        lcdLineStarted = true;
+    }
+    printf("%s", text);
+    if(newLine) {
+        printf("\n");
+        lcdLineStarted = false;
+    }
+}
+
+void Simulator::lcdClear() {
+    advance(config.lcdWriteCost * 4);
+    if(config.echoLcd && lcdLineStarted) {
+        printf("\n");
+        lcdLineStarted = false;
+    }
+}
@@ -0,0 +1,336 @@
+#ifndef SIMULATOR_H
+#define SIMULATOR_H
+
+#include <FEHIO.h>
+#include <FEHMotor.h>
+#include <FEHServo.h>
+
+//Physics step (in seconds)
+#define SIM_STEP 0.0005
+//Most walls, lines and RPS dead zones a course can have
+#define SIM_MAX_WALLS 32
+#define SIM_MAX_LINES 16
+#define SIM_MAX_DEAD_ZONES 8
+//Most setup touches the operator script can hold
+#define SIM_MAX_TOUCHES 4
+
+/**
+ * Things plugged into the Proteus that the simulator knows how to model.
+ */
+enum SimDevice
+{
+    SIM_NONE,
+    SIM_LEFT_ENCODER,
+    SIM_RIGHT_ENCODER,
+    SIM_LEFT_WHEEL,
+    SIM_RIGHT_WHEEL,
+    SIM_FRONT_LEFT_BUMP,
+    SIM_FRONT_RIGHT_BUMP,
+    SIM_LINE_LEFT,
+    SIM_LINE_MIDDLE,
+    SIM_LINE_RIGHT,
+    SIM_FUEL_CDS,
+    SIM_START_CDS,
+    SIM_ARM
+};
+
+/**
+ * This is a struct which says which device is plugged into each port. The defaults match robot.cpp.
+ */
+struct SimWiring
+{
+    SimDevice pins[32];
+    SimDevice motors[4];
+    SimDevice servos[8];
+};
+
+/**
+ * Kinds of sensor read the FEH objects count, one per accessor family.
+ */
+enum SimRead
+{
+    SIM_READ_ENCODER,
+    SIM_READ_DIGITAL,
+    SIM_READ_ANALOG,
+    SIM_READ_RPS,
+    SIM_READ_KINDS
+};
+
+/**
+ * This is a struct which holds a wall segment on the course (in inches).
+ */
+struct SimWall
+{
+    float x1, y1, x2, y2;
+};
+
+/**
+ * This is a struct which holds a painted line segment on the course (in inches) and what an optosensor
+ * reads over it.
+ */
+struct SimLine
+{
+    float x1, y1, x2, y2;
+    float width;
+    float reading;
+};
+
+/**
+ * This is a struct which holds a rectangle of the course where RPS has no signal.
+ */
+struct SimZone
+{
+    float x1, y1, x2, y2;
+};
+
+/**
+ * This is a struct which holds one touch of the setup menu: where the operator sets the robot down
+ * before touching, and where on the screen they touch.
+ */
+struct SimTouch
+{
+    float robotX, robotY, robotHeading;
+    float screenX, screenY;
+};
+
+/**
+ * This is a struct which holds the course layout.
+ */
+struct SimCourse
+{
+    SimWall walls[SIM_MAX_WALLS];
+    int wallCount;
+    SimLine lines[SIM_MAX_LINES];
+    int lineCount;
+    SimZone deadZones[SIM_MAX_DEAD_ZONES];
+    int deadZoneCount;
+    //Optosensor reading of the floor below and above this y coordinate
+    float upperLevelY;
+    float lowerFloorReading;
+    float upperFloorReading;
+    float fuelLightX, fuelLightY;
+    float startLightX, startLightY;
+    //Where the robot has to be when the program ends for the run to count as a success
+    SimZone home;
+};
+
+/**
+ * This is a struct which holds everything about a simulated run that can be changed between runs.
+ */
+struct SimConfig
+{
+    unsigned int seed;
+    SimWiring wiring;
+    SimCourse course;
+
+    //Pose the robot is in when the start light turns on
+    float startX, startY, startHeading;
+    //Time the start light turns on after the setup menu is done (in seconds)
+    float startDelay;
+    //Setup menu touches, after the last one the robot is put at the start pose
+    SimTouch touches[SIM_MAX_TOUCHES];
+    int touchCount;
+
+    //Course details that are chosen at random when negative
+    int fuelLightColor;     //0 red, 1 blue
+    int switchDirections[3];//red, white, blue: 1 or 2
+    char courseLetter;
+
+    //Drive base
+    float trackWidth;       //inches between the wheels
+    float maxWheelSpeed;    //inches per second at 100%
+    float motorDeadband;    //percent below which the wheels don't turn
+    float motorTimeConstant;//seconds
+    float leftMotorGain;
+    float rightMotorGain;
+    float countsPerInch;
+    float servoSpeed;       //degrees per second
+
+    //Noise
+    float analogNoise;      //volts, standard deviation
+    float wheelSlip;        //fraction of wheel travel lost, standard deviation
+    float rpsNoise;         //inches, standard deviation
+    float rpsHeadingNoise;  //degrees, standard deviation
+    float rpsRate;          //updates per second
+    float rpsLatency;       //seconds
+    float rpsDropoutRate;   //chance per update that RPS has no fix
+    //Virtual time from which until which RPS has no fix at all, both 0 for no outage (in seconds)
+    float rpsOutageStart;
+    float rpsOutageEnd;
+    float startPoseError;   //inches, standard deviation
+
+    //Virtual time each call costs (in seconds)
+    float timeNowCost;
+    float digitalReadCost;
+    float analogReadCost;
+    float rpsReadCost;
+    float motorWriteCost;
+    float lcdWriteCost;
+
+    //Echo LCD text to standard output
+    bool echoLcd;
+    //Print the robot's pose to standard error this often (in seconds, 0 for never)
+    float tracePeriod;
+    //Longest the run may take before it is stopped (in seconds of virtual time)
+    float timeLimit;
+};
+
+/**
+ * This is a class which is thrown when a simulated run goes past its time limit.
+ */
+class SimulationEnded
+{
+    public:
+        SimulationEnded(double time) {
+            this->time = time;
+        }
+
+        double time;
+};
+
+/**
+ * This is a struct which holds where the robot is and what it is doing.
+ */
+struct SimState
+{
+    double time;
+    float x, y, heading;
+    float leftVelocity, rightVelocity;
+    float leftPercent, rightPercent;
+    double leftTravel, rightTravel;
+    int leftCounts, rightCounts;
+    float armDegree, armTarget;
+    bool frontLeftPressed, frontRightPressed;
+    bool started;
+};
+
+/**
+ * This is a class which simulates the robot and course that the FEH objects talk to.
+ *
+ * Time only moves forward when the robot program calls into the FEH library, and each call advances the
+ * clock by about what it costs on the Proteus. The drive base is a differential drive with a first order
+ * motor response, so busy loops and Sleep() run as fast as the host allows.
+ */
+class Simulator
+{
+    public:
+        Simulator();
+        ~Simulator();
+
+        /** reset
+            Starts a new run from a configuration
+        */
+        void reset(const SimConfig &config);
+
+        const SimConfig &getConfig() const {
+            return config;
+        }
+
+        const SimState &getState() const {
+            return state;
+        }
+
+        /** advance
+            Moves the virtual clock forward, stepping the physics as needed
+            @param seconds Time to move forward
+        */
+        void advance(double seconds);
+
+        double now() const {
+            return state.time;
+        }
+
+        /** inZone
+            @return true if the robot's center is inside the rectangle
+        */
+        bool inZone(const SimZone &zone) const {
+            return state.x >= zone.x1 && state.x <= zone.x2 && state.y >= zone.y1 && state.y <= zone.y2;
+        }
+
+        /** countRead
+            Counts one call to a sensor accessor. The FEH objects call this themselves, so every read the robot
+            program makes is counted however it reaches the hardware.
+        */
+        void countRead(SimRead kind) {
+            reads[kind]++;
+        }
+
+        /** getReads
+            @return Sensor reads of a kind since the run started
+        */
+        unsigned long getReads(SimRead kind) const {
+            return reads[kind];
+        }
+
+        //Hardware
+        int encoderCounts(FEHIO::FEHIOPin pin);
+        void resetEncoder(FEHIO::FEHIOPin pin);
+        bool digitalValue(FEHIO::FEHIOPin pin);
+        float analogValue(FEHIO::FEHIOPin pin);
+        void setMotor(FEHMotor::FEHMotorPort port, float percent);
+        void setServo(FEHServo::FEHServoPort port, float degree);
+        float rpsX();
+        float rpsY();
+        float rpsHeading();
+        char rpsCourse();
+        int switchDirection(int which);
+        bool touch(float *x, float *y);
+        void lcdWrite(const char *text, bool newLine);
+        void lcdClear();
+
+        /** gaussian
+            @return A normally distributed random number with the given standard deviation
+        */
+        float gaussian(float deviation);
+
+        /** uniform
+            @return A random number between 0 and 1
+        */
+        float uniform();
+
+    private:
+        void step(float dt);
+        bool collides(float x, float y, float heading, float *penetration);
+        bool slide(float heading, float distance, float before);
+        float lineReading(float sensorX, float sensorY);
+        void robotToCourse(float forward, float left, float *x, float *y) const;
+        void updateRps();
+        void placeRobot(float x, float y, float heading);
+
+        SimConfig config;
+        SimState state;
+        double physicsTime;
+        double nextTrace;
+        bool ended;
+        unsigned long long rng;
+
+        //RPS history for latency, a ring of samples taken at the RPS rate
+        struct RpsSample
+        {
+            double time;
+            float x, y, heading;
+            bool valid;
+        };
+        RpsSample rpsSamples[64];
+        int rpsNewest;
+        double nextRpsSample;
+        int touchesUsed;
+        double touchReadyTime;
+        double setupDoneTime;
+        int leftOffset;
+        int rightOffset;
+        bool lcdLineStarted;
+        unsigned long reads[SIM_READ_KINDS];
+};
+
+/** simulator
+    @return The simulator all the FEH objects use
+*/
+Simulator &simulator();
+
+/** defaultConfig
+    @return A configuration for the 2016 course built from locations.h and the robot wired like robot.cpp
+*/
+SimConfig defaultConfig();
+
+#endif
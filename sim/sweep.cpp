@@ -0,0 +1,487 @@
+/**
+ * Mission parameter sweep. Runs the whole mission on the simulator for every combination of the
+ * parameters asked for, several seeds each, spread over all the host's cores, and writes how often each
+ * combination got the robot home and how long the course took as JSON, marking the combinations on the
+ * Pareto front of course time against success rate.
+ *
+ * Any number the robot program wraps in SWEEP_PARAM() (see sweep.h) can be swept by its name:
+ *
+ *     g++ -std=c++14 -O2 -pthread -Isim sim/sweep.cpp sim/simulator.cpp sim/feh.cpp sim/course.cpp -o sweep
+ *     ./sweep --list
+ *     ./sweep --param SPEED=30:60:5 --param PURSUIT_SPEED=35:65:5 --runs 10 --out sweep.json
+ *     ./sweep --param SPEED=30:60:1 --param HOME_DASH_DISTANCE=14:19:0.25 --samples 200
+ *
+ * --samples tries that many random points of the grid instead of all of it. The first candidate is
+ * always the program's own values, to compare the rest with. A run is a success if the program ended
+ * within the time limit with the robot in the course's home area.
+ *
+ * Each run is a forked child process like the benchmark's, and the runs are shared out over a work
+ * stealing pool of threads that each wait on one child at a time.
+ */
+#define BENCHMARK
+#define SWEEP
+#define main robot_main
+#ifdef ROBOT_SOURCE
+#include ROBOT_SOURCE
+#else
+#include "../robot.cpp"
+#endif
+#undef main
+
+#include "simulator.h"
+#include "parallel.h"
+#include <algorithm>
+#include <random>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+//Most parameters the mission can read and the sweep can vary
+#define SWEEP_MAX_PARAMS 32
+#define SWEEP_NAME_LENGTH 32
+
+enum SweepStatus
+{
+    SWEEP_COMPLETED,
+    SWEEP_TIMED_OUT,
+    SWEEP_CRASHED
+};
+
+/**
+ * This is a struct which holds one parameter's range from the command line.
+ */
+struct SweepRange
+{
+    char name[SWEEP_NAME_LENGTH];
+    float low, high, step;
+
+    int steps() const {
+        return step > 0 ? (int)((high - low) / step + 0.5) + 1 : 1;
+    }
+};
+
+/**
+ * This is a struct which holds the values one candidate gives the swept parameters, in the order of the
+ * ranges. The baseline candidate gives none and the program uses its own.
+ */
+struct SweepCandidate
+{
+    bool baseline;
+    float values[SWEEP_MAX_PARAMS];
+};
+
+/**
+ * This is a struct which a child process sends back after one run. It is plain data so it can go through
+ * a pipe as is.
+ */
+struct SweepRun
+{
+    int status;
+    bool home;
+    float endX, endY;
+    double courseTime;
+    //Every parameter the mission read and the program's own value for it
+    int paramCount;
+    struct
+    {
+        char name[SWEEP_NAME_LENGTH];
+        float value;
+    } params[SWEEP_MAX_PARAMS];
+};
+
+struct SweepOptions
+{
+    std::vector<SweepRange> ranges;
+    int runs;
+    int samples;
+    unsigned int seed;
+    float noise;
+    float timeLimit;
+    int threads;
+    const char *output;
+    bool list;
+};
+
+//The candidate a child is running and what the mission has read so far, set up after the fork
+static const SweepOptions *activeOptions = 0;
+static const SweepCandidate *activeCandidate = 0;
+static SweepRun *activeRun = 0;
+
+float sweepParameter(const char *name, float value) {
+    if(activeRun) {
+        int i = 0;
+        while(i < activeRun->paramCount && strcmp(activeRun->params[i].name, name) != 0) {
+            i++;
+        }
+        if(i == activeRun->paramCount && i < SWEEP_MAX_PARAMS) {
+            strncpy(activeRun->params[i].name, name, SWEEP_NAME_LENGTH - 1);
+            activeRun->params[i].value = value;
+            activeRun->paramCount++;
+        }
+    }
+    if(activeCandidate && !activeCandidate->baseline) {
+        for(size_t i = 0; i < activeOptions->ranges.size(); i++) {
+            if(strcmp(activeOptions->ranges[i].name, name) == 0) {
+                return activeCandidate->values[i];
+            }
+        }
+    }
+    return value;
+}
+
+static double hostSeconds() {
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+/** runOnce
+    Runs the mission with one candidate's values on a fresh simulator, in the calling process
+*/
+static void runOnce(const SweepOptions &options, const SweepCandidate &candidate, unsigned int seed, SweepRun *run) {
+    activeOptions = &options;
+    activeCandidate = &candidate;
+    activeRun = run;
+    SimConfig config = defaultConfig();
+    config.seed = seed;
+    config.echoLcd = false;
+    config.tracePeriod = 0;
+    config.timeLimit = options.timeLimit;
+    config.analogNoise *= options.noise;
+    config.wheelSlip *= options.noise;
+    config.rpsNoise *= options.noise;
+    config.rpsHeadingNoise *= options.noise;
+    config.rpsDropoutRate *= options.noise;
+    config.startPoseError *= options.noise;
+    simulator().reset(config);
+
+    run->status = SWEEP_COMPLETED;
+    try {
+        robot_main();
+    }
+    catch(const SimulationEnded &ended) {
+        run->status = SWEEP_TIMED_OUT;
+    }
+    run->home = simulator().inZone(config.course.home);
+    run->endX = simulator().getState().x;
+    run->endY = simulator().getState().y;
+    run->courseTime = 0;
+    for(int i = 0; i < bench.getCount(); i++) {
+        //Phases don't overlap, so together they are the course time
+        if(bench.getEntry(i).phase) {
+            run->courseTime += bench.getEntry(i).total;
+        }
+    }
+}
+
+static bool succeeded(const SweepRun &run) {
+    return run.status == SWEEP_COMPLETED && run.home;
+}
+
+/** makeCandidates
+    @return The baseline, then every point of the grid or options.samples random points of it
+*/
+static std::vector<SweepCandidate> makeCandidates(const SweepOptions &options) {
+    std::vector<SweepCandidate> candidates;
+    SweepCandidate candidate;
+    memset(&candidate, 0, sizeof(candidate));
+    candidate.baseline = true;
+    candidates.push_back(candidate);
+    candidate.baseline = false;
+    if(options.ranges.empty()) {
+        return candidates;
+    }
+    std::mt19937 random(options.seed);
+    long gridSize = 1;
+    for(size_t i = 0; i < options.ranges.size(); i++) {
+        gridSize *= options.ranges[i].steps();
+    }
+    long count = options.samples > 0 ? options.samples : gridSize;
+    for(long c = 0; c < count; c++) {
+        //Grid points are numbered with the first parameter changing fastest
+        long point = options.samples > 0 ? std::uniform_int_distribution<long>(0, gridSize - 1)(random) : c;
+        for(size_t i = 0; i < options.ranges.size(); i++) {
+            const SweepRange &range = options.ranges[i];
+            candidate.values[i] = range.low + range.step * (point % range.steps());
+            point /= range.steps();
+        }
+        candidates.push_back(candidate);
+    }
+    return candidates;
+}
+
+static double percentile(std::vector<double> values, double fraction) {
+    if(values.empty()) {
+        return 0;
+    }
+    std::sort(values.begin(), values.end());
+    size_t rank = (size_t)(fraction * values.size() + 0.999999);
+    return values[(rank < 1 ? 1 : rank) - 1];
+}
+
+/**
+ * This is a struct which holds how one candidate did over all its seeds.
+ */
+struct SweepResult
+{
+    int successes;
+    double successRate;
+    //Course times of the runs that succeeded
+    std::vector<double> times;
+    double meanTime;
+    bool pareto;
+};
+
+static std::vector<SweepResult> summarize(const SweepOptions &options, const std::vector<SweepRun> &runs,
+                                          int candidateCount) {
+    std::vector<SweepResult> results(candidateCount);
+    for(int c = 0; c < candidateCount; c++) {
+        SweepResult &result = results[c];
+        result.successes = 0;
+        result.meanTime = 0;
+        for(int r = 0; r < options.runs; r++) {
+            const SweepRun &run = runs[c * options.runs + r];
+            if(succeeded(run)) {
+                result.successes++;
+                result.times.push_back(run.courseTime);
+                result.meanTime += run.courseTime;
+            }
+        }
+        result.successRate = (double)result.successes / options.runs;
+        if(result.successes > 0) {
+            result.meanTime /= result.successes;
+        }
+    }
+    //A candidate is on the front unless another one succeeds at least as often and is at least as fast,
+    //and is strictly better at one of them
+    for(int c = 0; c < candidateCount; c++) {
+        SweepResult &result = results[c];
+        result.pareto = result.successes > 0;
+        for(int o = 0; o < candidateCount && result.pareto; o++) {
+            const SweepResult &other = results[o];
+            if(o != c && other.successes > 0 && other.successRate >= result.successRate &&
+               other.meanTime <= result.meanTime &&
+               (other.successRate > result.successRate || other.meanTime < result.meanTime)) {
+                result.pareto = false;
+            }
+        }
+    }
+    return results;
+}
+
+static void writeValues(FILE *out, const SweepOptions &options, const SweepCandidate &candidate,
+                        const SweepRun &baseline) {
+    fprintf(out, "{");
+    for(size_t i = 0; i < options.ranges.size(); i++) {
+        float value = candidate.values[i];
+        if(candidate.baseline) {
+            for(int p = 0; p < baseline.paramCount; p++) {
+                if(strcmp(baseline.params[p].name, options.ranges[i].name) == 0) {
+                    value = baseline.params[p].value;
+                }
+            }
+        }
+        fprintf(out, "%s\"%s\": %g", i == 0 ? "" : ", ", options.ranges[i].name, value);
+    }
+    fprintf(out, "}");
+}
+
+static void writeReport(FILE *out, const SweepOptions &options, const std::vector<SweepCandidate> &candidates,
+                        const std::vector<SweepRun> &runs, const std::vector<SweepResult> &results,
+                        int steals, double hostTime) {
+    fprintf(out, "{\n");
+    fprintf(out, "  \"program\": \"%s\",\n",
+#ifdef ROBOT_SOURCE
+            ROBOT_SOURCE
+#else
+            "../robot.cpp"
+#endif
+           );
+    fprintf(out, "  \"candidates_run\": %d, \"runs_per_candidate\": %d, \"seed\": %u, \"noise\": %.3f, "
+            "\"time_limit\": %.1f,\n", (int)candidates.size(), options.runs, options.seed, options.noise,
+            options.timeLimit);
+    fprintf(out, "  \"threads\": %d, \"steals\": %d, \"host_seconds\": %.2f,\n", options.threads, steals, hostTime);
+    fprintf(out, "  \"parameters\": [");
+    for(size_t i = 0; i < options.ranges.size(); i++) {
+        const SweepRange &range = options.ranges[i];
+        fprintf(out, "%s\n    {\"name\": \"%s\", \"low\": %g, \"high\": %g, \"step\": %g}", i == 0 ? "" : ",",
+                range.name, range.low, range.high, range.step);
+    }
+    fprintf(out, "\n  ],\n  \"candidates\": [");
+    for(size_t c = 0; c < candidates.size(); c++) {
+        const SweepResult &result = results[c];
+        fprintf(out, "%s\n    {\"baseline\": %s, \"values\": ", c == 0 ? "" : ",",
+                candidates[c].baseline ? "true" : "false");
+        writeValues(out, options, candidates[c], runs[0]);
+        fprintf(out, ", \"success_rate\": %.3f, \"course_seconds\": {\"mean\": %.4f, \"p50\": %.4f, \"p95\": %.4f}, "
+                "\"pareto\": %s}", result.successRate, result.meanTime, percentile(result.times, 0.5),
+                percentile(result.times, 0.95), result.pareto ? "true" : "false");
+    }
+    fprintf(out, "\n  ],\n  \"pareto\": [");
+    bool first = true;
+    for(size_t c = 0; c < candidates.size(); c++) {
+        if(results[c].pareto) {
+            fprintf(out, "%s%d", first ? "" : ", ", (int)c);
+            first = false;
+        }
+    }
+    fprintf(out, "]\n}\n");
+}
+
+/** printFront
+    Prints the Pareto front, fastest first, and the baseline to standard error
+*/
+static void printFront(const SweepOptions &options, const std::vector<SweepCandidate> &candidates,
+                       const std::vector<SweepRun> &runs, const std::vector<SweepResult> &results) {
+    std::vector<int> front;
+    for(size_t c = 0; c < candidates.size(); c++) {
+        if(results[c].pareto || c == 0) {
+            front.push_back(c);
+        }
+    }
+    std::sort(front.begin(), front.end(), [&](int a, int b) {
+        return results[a].meanTime < results[b].meanTime;
+    });
+    fprintf(stderr, "success  mean s  candidate\n");
+    for(size_t i = 0; i < front.size(); i++) {
+        const SweepResult &result = results[front[i]];
+        fprintf(stderr, "%6.0f%%  %6.2f  ", result.successRate * 100, result.meanTime);
+        writeValues(stderr, options, candidates[front[i]], runs[0]);
+        fprintf(stderr, "%s\n", front[i] == 0 ? " (baseline)" : "");
+    }
+}
+
+static bool parseRange(const char *text, SweepRange &range) {
+    const char *equals = strchr(text, '=');
+    if(!equals || equals == text || equals - text >= SWEEP_NAME_LENGTH) {
+        return false;
+    }
+    memset(range.name, 0, sizeof(range.name));
+    strncpy(range.name, text, equals - text);
+    range.step = 0;
+    int read = sscanf(equals + 1, "%f:%f:%f", &range.low, &range.high, &range.step);
+    if(read == 1) {
+        range.high = range.low;
+    }
+    return read >= 1 && range.high >= range.low && range.step >= 0 && (read < 3 || range.step > 0);
+}
+
+static void usage() {
+    fprintf(stderr, "usage: sweep [--param NAME=LOW:HIGH:STEP]... [--samples N] [--runs N] [--seed S] [--noise SCALE]\n"
+            "             [--time-limit SECONDS] [--threads N] [--out FILE] [--list]\n");
+    exit(2);
+}
+
+int main(int argc, char **argv) {
+    SweepOptions options;
+    options.runs = 10;
+    options.samples = 0;
+    options.seed = 1;
+    options.noise = 1;
+    options.timeLimit = 120;
+    options.threads = 0;
+    options.output = 0;
+    options.list = false;
+    for(int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        SweepRange range;
+        if(strcmp(argv[i], "--param") == 0 && hasValue) {
+            if(!parseRange(argv[++i], range) || options.ranges.size() >= SWEEP_MAX_PARAMS) {
+                usage();
+            }
+            options.ranges.push_back(range);
+        }
+        else if(strcmp(argv[i], "--samples") == 0 && hasValue) {
+            options.samples = atoi(argv[++i]);
+        }
+        else if(strcmp(argv[i], "--runs") == 0 && hasValue) {
+            options.runs = atoi(argv[++i]);
+        }
+        else if(strcmp(argv[i], "--seed") == 0 && hasValue) {
+            options.seed = strtoul(argv[++i], 0, 10);
+        }
+        else if(strcmp(argv[i], "--noise") == 0 && hasValue) {
+            options.noise = atof(argv[++i]);
+        }
+        else if(strcmp(argv[i], "--time-limit") == 0 && hasValue) {
+            options.timeLimit = atof(argv[++i]);
+        }
+        else if(strcmp(argv[i], "--threads") == 0 && hasValue) {
+            options.threads = atoi(argv[++i]);
+        }
+        else if(strcmp(argv[i], "--out") == 0 && hasValue) {
+            options.output = argv[++i];
+        }
+        else if(strcmp(argv[i], "--list") == 0) {
+            options.list = true;
+        }
+        else {
+            usage();
+        }
+    }
+    if(options.runs < 1) {
+        usage();
+    }
+
+    std::vector<SweepCandidate> candidates = makeCandidates(options);
+    if(options.list) {
+        //One baseline run shows every parameter the mission reads
+        SweepRun run;
+        memset(&run, 0, sizeof(run));
+        runForked([&](SweepRun *result) {
+            runOnce(options, candidates[0], options.seed, result);
+        }, &run);
+        for(int p = 0; p < run.paramCount; p++) {
+            printf("%s=%g\n", run.params[p].name, run.params[p].value);
+        }
+        return 0;
+    }
+
+    WorkStealingPool pool(options.threads);
+    options.threads = pool.getThreadCount();
+    int jobs = candidates.size() * options.runs;
+    fprintf(stderr, "%d candidates, %d runs on %d threads\n", (int)candidates.size(), jobs, options.threads);
+    std::vector<SweepRun> runs(jobs);
+    int finished = 0;
+    double start = hostSeconds();
+    //Job c * runs + r is candidate c with seed + r, so every candidate sees the same seeds
+    pool.run(jobs, [&](int job) {
+        SweepRun &run = runs[job];
+        memset(&run, 0, sizeof(run));
+        run.status = SWEEP_CRASHED;
+        runForked([&](SweepRun *result) {
+            runOnce(options, candidates[job / options.runs], options.seed + job % options.runs, result);
+        }, &run);
+        std::lock_guard<std::mutex> hold(forkLock());
+        finished++;
+        if(finished % std::max(1, jobs / 20) == 0 || finished == jobs) {
+            fprintf(stderr, "%d/%d runs, %.1f s\n", finished, jobs, hostSeconds() - start);
+        }
+    });
+    double hostTime = hostSeconds() - start;
+
+    for(size_t i = 0; i < options.ranges.size(); i++) {
+        bool read = false;
+        for(int p = 0; p < runs[0].paramCount; p++) {
+            read = read || strcmp(runs[0].params[p].name, options.ranges[i].name) == 0;
+        }
+        if(!read) {
+            fprintf(stderr, "warning: the mission never read %s (see --list)\n", options.ranges[i].name);
+        }
+    }
+    std::vector<SweepResult> results = summarize(options, runs, candidates.size());
+    printFront(options, candidates, runs, results);
+
+    FILE *out = options.output ? fopen(options.output, "w") : stdout;
+    if(!out) {
+        perror(options.output);
+        return 1;
+    }
+    writeReport(out, options, candidates, runs, results, pool.getSteals(), hostTime);
+    if(out != stdout) {
+        fclose(out);
+    }
+    return 0;
+}
@@ -0,0 +1,140 @@
+/**
+ * Unchained variant test. Builds robot.cpp as the unchained robot and runs the whole mission on the
+ * simulator for several seeds, tracing the robot's pose every physics step. Each trace is hashed along
+ * with exactly where the run ended and compared with UNCHAINED_TRACES, the traces of the original
+ * unchained program, so the variant has to drive the course bit-for-bit the way that program did.
+ *
+ *     g++ -std=c++14 -O2 -Isim sim/varianttest.cpp sim/simulator.cpp sim/feh.cpp sim/course.cpp -o varianttest
+ *     ./varianttest
+ *
+ * UNCHAINED_TRACES was written by building this test against the unchained.cpp that robot.cpp replaced
+ * and running it with --write, which prints the table instead of checking it:
+ *
+ *     git show ddcf7a3:unchained.cpp > /tmp/unchained.cpp
+ *     g++ ... -I. -DROBOT_SOURCE='"/tmp/unchained.cpp"' -o unchained_traces
+ *     ./unchained_traces --write
+ */
+#define BENCHMARK
+#define ROBOT_VARIANT UnchainedRobot
+#define main robot_main
+#ifdef ROBOT_SOURCE
+#include ROBOT_SOURCE
+#else
+#include "../robot.cpp"
+#endif
+#undef main
+
+#include "simulator.h"
+#include "check.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+//Seeds the mission is traced on, 1 up to this
+#define VARIANT_SEEDS 12
+
+/**
+ * This is a struct which holds what one traced run of the mission came to.
+ */
+struct VariantTrace
+{
+    unsigned int seed;
+    unsigned long lines;
+    unsigned long long hash;
+    //Virtual time the run ended at, only to make a mismatch easier to read (in seconds)
+    double end;
+};
+
+static const VariantTrace UNCHAINED_TRACES[] = {
+    {1, 107697, 0x6e333e0dd24123c2ULL, 53.848},
+    {2, 108872, 0xb024b4a928b5c3d0ULL, 54.436},
+    {3, 110314, 0xb628d5a78e5e6db9ULL, 55.157},
+    {4, 109946, 0x1974b8da21fc88f7ULL, 54.973},
+    {5, 98910, 0xe539a7698176bc28ULL, 49.455},
+    {6, 97819, 0x9e70f9871fab485aULL, 48.909},
+    {7, 95623, 0x960cf87969b4b7cbULL, 47.811},
+    {8, 97850, 0xa5da1a8fa5b8710fULL, 48.925},
+    {9, 98210, 0x0f312a9834b48e86ULL, 49.105},
+    {10, 98476, 0x147729208075c024ULL, 49.238},
+    {11, 109806, 0x6b6db764ebc2a622ULL, 54.903},
+    {12, 99988, 0x6f06589024b70464ULL, 49.994},
+};
+
+/** fnv1a
+    Adds bytes to a 64 bit FNV-1a hash
+    @param hash Hash so far
+    @return The new hash
+*/
+static unsigned long long fnv1a(unsigned long long hash, const char *bytes, size_t length) {
+    for(size_t i = 0; i < length; i++) {
+        hash ^= (unsigned char)bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+/** traceRun
+    Runs the mission once with the trace going to a temporary file instead of standard error, then hashes
+    the trace and the robot's final state, printed as exact hexadecimal floats
+    @param seed Simulator seed
+    @param trace Filled in with the run's hash
+*/
+static void traceRun(unsigned int seed, VariantTrace *trace) {
+    FILE *file = tmpfile();
+    fflush(stderr);
+    dup2(fileno(file), STDERR_FILENO);
+    SimConfig config = defaultConfig();
+    config.seed = seed;
+    config.echoLcd = false;
+    config.tracePeriod = SIM_STEP;
+    simulator().reset(config);
+    try {
+        robot_main();
+    }
+    catch(const SimulationEnded &) {
+    }
+    const SimState &state = simulator().getState();
+    fprintf(stderr, "end %a %a %a %a\n", state.time, state.x, state.y, state.heading);
+    fflush(stderr);
+
+    trace->seed = seed;
+    trace->lines = 0;
+    trace->hash = 14695981039346656037ULL;
+    trace->end = state.time;
+    rewind(file);
+    char line[256];
+    while(fgets(line, sizeof(line), file)) {
+        trace->lines++;
+        trace->hash = fnv1a(trace->hash, line, strlen(line));
+    }
+    fclose(file);
+}
+
+static void testTrace(const VariantTrace &expected) {
+    VariantTrace trace;
+    memset(&trace, 0, sizeof(trace));
+    CHECK(runForked([&](VariantTrace *result) { traceRun(expected.seed, result); }, &trace));
+    if(!CHECK(trace.lines == expected.lines && trace.hash == expected.hash)) {
+        fprintf(stderr, "    seed %u: %lu lines ending at %.3f s, the original's %lu lines end at %.3f s\n",
+                expected.seed, trace.lines, trace.end, expected.lines, expected.end);
+    }
+}
+
+int main(int argc, char **argv) {
+    int count = sizeof(UNCHAINED_TRACES) / sizeof(UNCHAINED_TRACES[0]);
+    if(argc > 1 && strcmp(argv[1], "--write") == 0) {
+        for(unsigned int seed = 1; seed <= VARIANT_SEEDS; seed++) {
+            VariantTrace trace;
+            memset(&trace, 0, sizeof(trace));
+            runForked([&](VariantTrace *result) { traceRun(seed, result); }, &trace);
+            printf("    {%u, %lu, 0x%016llxULL, %.3f},\n", trace.seed, trace.lines, trace.hash, trace.end);
+        }
+        return 0;
+    }
+    CHECK(count == VARIANT_SEEDS);
+    for(int i = 0; i < count; i++) {
+        testTrace(UNCHAINED_TRACES[i]);
+    }
+    return checkSummary("varianttest");
+}
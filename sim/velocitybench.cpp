@@ -0,0 +1,229 @@
+/**
+ * Velocity estimator benchmark. Drives the simulator's drive base on an empty floor through a run of
+ * speeds, from a crawl where the encoders count every few ticks to full speed and a pivot, and compares
+ * what VelocityEstimator makes of the encoder counts every control tick with the simulator's wheel speeds.
+ * Prints the RMS error of each wheel and of the robot's speed and turn rate, for each segment and each
+ * low-pass filter shift.
+ *
+ *     g++ -std=c++14 -O2 -Isim sim/velocitybench.cpp sim/simulator.cpp sim/feh.cpp sim/course.cpp -o velocitybench
+ *     ./velocitybench
+ *     ./velocitybench --seeds 5 --filter 2
+ *     ./velocitybench --bench 1000000
+ *
+ * --bench times VelocityEstimator::measure() on this computer instead, against counts that speed up and
+ * slow down, so the cost per tick can be checked without a robot.
+ */
+#include "../velocity.h"
+#include "../scheduler.h"
+#include "simulator.h"
+#include <FEHIO.h>
+#include <FEHMotor.h>
+#include <FEHUtility.h>
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+Bench bench;
+
+static const float DEGREES = 180 / 3.14159265358979323846;
+//Highest filter shift compared when --filter isn't given
+#define BENCH_MAX_FILTER_SHIFT 4
+
+/**
+ * This is a struct which holds one stretch of the drive: both motors held at a percent for a while.
+ */
+struct Segment
+{
+    const char *name;
+    float left;
+    float right;
+    float time;
+};
+
+static const Segment SEGMENTS[] = {
+    {"crawl", 12, 12, 1.5},
+    {"slow", 25, 25, 1},
+    {"cruise", 50, 50, 1},
+    {"full", 100, 100, 1},
+    {"pivot", 40, -40, 1},
+    {"reverse", -50, -50, 1},
+    {"stop", 0, 0, 0.5}
+};
+static const int SEGMENT_COUNT = sizeof(SEGMENTS) / sizeof(SEGMENTS[0]);
+
+struct BenchOptions
+{
+    int seeds;
+    int filterLow;
+    int filterHigh;
+    long benchTicks;
+};
+
+/**
+ * This is a struct which sums squared errors against the simulator's speeds.
+ */
+struct ErrorSums
+{
+    double wheel;
+    double linear;
+    double angular;
+    long samples;
+};
+
+DigitalEncoder leftEncoder(FEHIO::P0_0), rightEncoder(FEHIO::P0_1);
+DigitalInputPin leftBump(FEHIO::P2_0), rightBump(FEHIO::P2_1);
+AnalogInputPin lineLeft(FEHIO::P1_6), lineMiddle(FEHIO::P1_4), lineRight(FEHIO::P1_2);
+AnalogInputPin cds1(FEHIO::P3_0), cds2(FEHIO::P3_1);
+SensorBank sensors(leftEncoder, rightEncoder, leftBump, rightBump, lineLeft, lineMiddle, lineRight, cds1, cds2);
+
+static void startRun(unsigned int seed) {
+    SimConfig config = defaultConfig();
+    config.seed = seed;
+    //An empty floor, so nothing stops the robot however far it goes
+    config.course.wallCount = 0;
+    config.touchCount = 0;
+    config.startX = 0;
+    config.startY = 0;
+    config.startHeading = 90;
+    config.startPoseError = 0;
+    config.echoLcd = false;
+    config.tracePeriod = 0;
+    simulator().reset(config);
+    leftEncoder.ResetCounts();
+    rightEncoder.ResetCounts();
+}
+
+/** drive
+    Runs every segment once with a filter shift, adding the estimator's errors to one sum per segment
+*/
+static void drive(int filterShift, unsigned int seed, ErrorSums *sums) {
+    startRun(seed);
+    const SimConfig &config = simulator().getConfig();
+    DriveMotor leftMotor(FEHMotor::Motor3, 12.0), rightMotor(FEHMotor::Motor2, 12.0);
+    float countsPerDegree = config.countsPerInch * config.trackWidth / 2 / DEGREES;
+    VelocityEstimator velocity(sensors, leftMotor, rightMotor, config.countsPerInch, countsPerDegree, countsPerDegree);
+    velocity.setFilterShift(filterShift);
+    sensors.setChannels(SENSE_ENCODERS);
+
+    double now = TimeNow();
+    velocity.reset(now);
+    double next = now;
+    for(int s = 0; s < SEGMENT_COUNT; s++) {
+        double end = next + SEGMENTS[s].time;
+        leftMotor.SetPercent(SEGMENTS[s].left);
+        rightMotor.SetPercent(SEGMENTS[s].right);
+        while(next < end) {
+            now = TimeNow();
+            if(next > now) {
+                Sleep(next - now);
+            }
+            now = TimeNow();
+            SensorBank::update(&sensors, now);
+            DriveMotor::update(&leftMotor, now);
+            DriveMotor::update(&rightMotor, now);
+            VelocityEstimator::update(&velocity, now);
+
+            const SimState &state = simulator().getState();
+            float left = velocity.getLeft() - state.leftVelocity;
+            float right = velocity.getRight() - state.rightVelocity;
+            float linear = velocity.getLinear() - (state.leftVelocity + state.rightVelocity) / 2;
+            float angular = velocity.getAngular() - (state.rightVelocity - state.leftVelocity) / config.trackWidth * DEGREES;
+            sums[s].wheel += (left * left + right * right) / 2;
+            sums[s].linear += linear * linear;
+            sums[s].angular += angular * angular;
+            sums[s].samples++;
+            next += CONTROL_PERIOD;
+        }
+    }
+    leftMotor.Stop();
+    rightMotor.Stop();
+}
+
+static double rms(double sum, long samples) {
+    return samples > 0 ? sqrt(sum / samples) : 0;
+}
+
+static void compare(const BenchOptions &options) {
+    printf("filter  segment   wheel in/s  linear in/s  angular deg/s\n");
+    for(int shift = options.filterLow; shift <= options.filterHigh; shift++) {
+        ErrorSums sums[SEGMENT_COUNT];
+        memset(sums, 0, sizeof(sums));
+        for(int seed = 1; seed <= options.seeds; seed++) {
+            drive(shift, seed, sums);
+        }
+        ErrorSums total = {0, 0, 0, 0};
+        for(int s = 0; s < SEGMENT_COUNT; s++) {
+            printf("%6d  %-8s  %10.3f  %11.3f  %13.2f\n", shift, SEGMENTS[s].name,
+                   rms(sums[s].wheel, sums[s].samples), rms(sums[s].linear, sums[s].samples),
+                   rms(sums[s].angular, sums[s].samples));
+            total.wheel += sums[s].wheel;
+            total.linear += sums[s].linear;
+            total.angular += sums[s].angular;
+            total.samples += sums[s].samples;
+        }
+        printf("%6d  %-8s  %10.3f  %11.3f  %13.2f\n", shift, "all", rms(total.wheel, total.samples),
+               rms(total.linear, total.samples), rms(total.angular, total.samples));
+    }
+}
+
+/** benchMeasure
+    Times VelocityEstimator::measure() against counts that speed up from a crawl and slow down again
+*/
+static void benchMeasure(long ticks) {
+    DriveMotor leftMotor(FEHMotor::Motor3, 12.0), rightMotor(FEHMotor::Motor2, 12.0);
+    static VelocityEstimator velocity(sensors, leftMotor, rightMotor, 33.74, 2.2, 2.2);
+    int leftCounts = 0;
+    int rightCounts = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for(long i = 0; i < ticks; i++) {
+        //Up to about three counts a tick, then back down, every 4096 ticks
+        int phase = (int)(i & 4095);
+        int speed = phase < 2048 ? phase : 4095 - phase;
+        leftCounts += (int)((i * speed) >> 10 & 3) == 0 ? speed >> 9 : 0;
+        rightCounts += speed >> 10;
+        velocity.measure(leftCounts & 0xffff, rightCounts & 0xffff, i * CONTROL_PERIOD);
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("%ld ticks in %.3f ms, %.1f ns per tick, %lu bytes held (last %.2f in/s)\n", ticks, elapsed * 1000,
+           elapsed * 1e9 / ticks, (unsigned long)sizeof(VelocityEstimator), velocity.getLinear());
+}
+
+static bool parseOptions(int argc, char **argv, BenchOptions &options) {
+    options.seeds = 3;
+    options.filterLow = 0;
+    options.filterHigh = BENCH_MAX_FILTER_SHIFT;
+    options.benchTicks = 0;
+    for(int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if(strcmp(argv[i], "--seeds") == 0 && hasValue) {
+            options.seeds = atoi(argv[++i]);
+        }
+        else if(strcmp(argv[i], "--filter") == 0 && hasValue) {
+            options.filterLow = options.filterHigh = atoi(argv[++i]);
+        }
+        else if(strcmp(argv[i], "--bench") == 0 && hasValue) {
+            options.benchTicks = atol(argv[++i]);
+        }
+        else {
+            fprintf(stderr, "Usage: velocitybench [--seeds N] [--filter SHIFT]\n"
+                            "       velocitybench --bench TICKS\n");
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    BenchOptions options;
+    if(!parseOptions(argc, argv, options)) {
+        return 2;
+    }
+    if(options.benchTicks > 0) {
+        benchMeasure(options.benchTicks);
+        return 0;
+    }
+    compare(options);
+    return 0;
+}
@@ -0,0 +1,25 @@
+#ifndef SWEEP_H
+#define SWEEP_H
+
+/**
+ * Mission numbers the host parameter sweep (sim/sweep.cpp) can change between simulated runs.
+ *
+ * A speed, distance or angle the sweep should try other values for is written as
+ * SWEEP_PARAM("NAME", default). On the robot that is just the default, so it costs nothing. When SWEEP is
+ * defined (only the sweep defines it) each use asks the sweep for the value of this run instead, and the
+ * sweep also learns the names and defaults from it, so any number wrapped this way can be swept by name.
+ */
+#ifdef SWEEP
+/** sweepParameter
+    Defined by the sweep
+    @param name Name of the parameter
+    @param value Default value
+    @return Value to use for this run
+*/
+float sweepParameter(const char *name, float value);
+#define SWEEP_PARAM(name, value) sweepParameter(name, value)
+#else
+#define SWEEP_PARAM(name, value) (value)
+#endif
+
+#endif
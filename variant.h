@@ -0,0 +1,76 @@
+#ifndef VARIANT_H
+#define VARIANT_H
+
+/*
+ * Policies for the two robots robot.cpp can be built as. It is built as the variant named by ROBOT_VARIANT,
+ * CompetitionRobot unless it is defined. Each policy picks the primitives the robot drives with and holds
+ * the values the two robots are tuned differently on. Every choice is made at compile time: constants are
+ * used directly and the primitives pick a runRobot() overload in robot.cpp, so neither build pays for the
+ * other's code.
+ */
+
+/**
+ * Primitives a robot drives with, each an overload of runRobot().
+ */
+//Drive loops on the control loop, with the pose estimate, flight recorder and slew limited motors
+struct LoopPrimitives {};
+//The original unchained program's busy-wait loops, writing straight to the motors (DirectDrive)
+struct DirectPrimitives {};
+
+/**
+ * This is a struct which holds the competition robot's policies.
+ */
+struct CompetitionRobot
+{
+    typedef LoopPrimitives Primitives;
+
+    //Fuel light CdS reading below which the light is on (in volts)
+    static constexpr double FUEL_LIGHT_ON = 1.1;
+    //Speed the robot creeps along the line towards the fuel light at
+    static constexpr int LIGHT_CREEP_PERCENT = 25;
+
+    /** wallBackoff
+        @param percent Percent driveToWall is driving at
+        @return Percent for the wheel whose bump switch is already pressed, while the other catches up
+    */
+    static float wallBackoff(int percent) {
+        return -1 * percent * .1;
+    }
+
+    //Side ramp: climbing speed, backing off the wall and the turn onto the top
+    static constexpr int SIDE_RAMP_PERCENT = 50;
+    static constexpr int SIDE_RAMP_BACKUP_PERCENT = 50;
+    static constexpr int SIDE_RAMP_TOP_TURN = 90;
+    //Side switches: how far to back up before pushing one, and how long to push
+    static constexpr double SWITCH_PUSH_BACKUP = 2.5;
+    static constexpr double SWITCH_PUSH_TIME = .25;
+    //Drop off: backing away from the supplies and the turn back to the line
+    static constexpr int DROP_BACKUP_PERCENT = 30;
+    static constexpr int DROP_PIVOT_DEGREES = 175;
+};
+
+/**
+ * This is a struct which holds the unchained robot's policies: the original program's primitives and
+ * mission, with its own values.
+ */
+struct UnchainedRobot
+{
+    typedef DirectPrimitives Primitives;
+
+    static constexpr double FUEL_LIGHT_ON = 1.00;
+    static constexpr int LIGHT_CREEP_PERCENT = 30;
+
+    static float wallBackoff(int) {
+        return -15;
+    }
+
+    static constexpr int SIDE_RAMP_PERCENT = 40;
+    static constexpr int SIDE_RAMP_BACKUP_PERCENT = 40;
+    static constexpr int SIDE_RAMP_TOP_TURN = 87;
+    static constexpr double SWITCH_PUSH_BACKUP = 1.5;
+    static constexpr double SWITCH_PUSH_TIME = .5;
+    static constexpr int DROP_BACKUP_PERCENT = 25;
+    static constexpr int DROP_PIVOT_DEGREES = 180;
+};
+
+#endif
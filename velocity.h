@@ -0,0 +1,264 @@
+#ifndef VELOCITY_H
+#define VELOCITY_H
+
+#include <stdint.h>
+#include "sensors.h"
+#include "motor.h"
+
+//Ticks of encoder counts the count-delta mode measures over, 1 for the counts gained since the last tick
+#define VELOCITY_WINDOW 8
+//Counts the window needs before the count-delta mode is used, below this the time between edges is used
+#define VELOCITY_EDGE_COUNTS 4
+//A wheel that hasn't counted for this long is taken to have stopped (in microseconds)
+#define VELOCITY_STOP_MICROS 100000
+//A wheel is only taken to have changed direction once it has slowed below this (in counts per second)
+#define VELOCITY_REVERSE_RATE 100
+//Low-pass filter: each estimate moves 1/2^shift of the way to the new measurement, 0 for no filter
+#define VELOCITY_FILTER_SHIFT 2
+//Fraction bits of the fixed point velocities
+#define VELOCITY_FRACTION_BITS 8
+
+/**
+ * This is a struct which holds the velocity measurement of one wheel, all in whole numbers.
+ */
+struct WheelVelocity
+{
+    //Raw encoder count at the last tick, to spot resets
+    int lastCounts;
+    //Counts since the estimator started, which resets don't change
+    int32_t total;
+    //Totals and times (in microseconds) of the last VELOCITY_WINDOW ticks
+    int32_t windowTotals[VELOCITY_WINDOW];
+    uint32_t windowTimes[VELOCITY_WINDOW];
+    //Tick the count last went up at, and the counts per second from that and the edge before it
+    uint32_t edgeTime;
+    int32_t edgeRate;
+    //Which way the wheel is taken to be turning, 1 or -1
+    int direction;
+    //Counts per second with VELOCITY_FRACTION_BITS fraction bits, before and after the filter
+    int32_t raw;
+    int32_t filtered;
+};
+
+/**
+ * This is a class which estimates how fast each wheel is turning from the encoder counts, and from them
+ * how fast the robot is driving and turning.
+ *
+ * It is registered as a control loop task after the SensorBank. While a wheel gains at least
+ * VELOCITY_EDGE_COUNTS over the last VELOCITY_WINDOW ticks its speed is the counts gained over the window's
+ * time. Slower than that there are too few counts per tick to go by, so the speed is one over the time
+ * between the last two ticks the count went up at, falling off as one count over the time since the last
+ * one once that is longer. The encoders only count up, so the direction each motor was last driven gives
+ * the sign, the same as the pose estimate, except that a wheel driven the other way is taken to keep
+ * turning the old way until it has slowed below VELOCITY_REVERSE_RATE.
+ *
+ * Everything per tick is done in fixed point: times are whole microseconds and speeds are counts per
+ * second with VELOCITY_FRACTION_BITS fraction bits, then low-pass filtered by a shift. Only the getters
+ * turn them into inches and degrees. The microsecond times wrap around every 71 minutes, which only the
+ * differences between them ever see.
+ *
+ * Primitives reset the encoders, so they should call countsReset() right after they do.
+ */
+class VelocityEstimator
+{
+    public:
+        VelocityEstimator(const SensorBank &sensors, const DriveMotor &leftMotor, const DriveMotor &rightMotor,
+                          float countsPerInch, float leftCountsPerDegree, float rightCountsPerDegree)
+            : sensors(sensors), leftMotor(leftMotor), rightMotor(rightMotor) {
+            filterShift = VELOCITY_FILTER_SHIFT;
+            setConstants(countsPerInch, leftCountsPerDegree, rightCountsPerDegree);
+            reset(0);
+        }
+
+        /** reset
+            Forgets every measurement, for a robot that is standing still
+            @param now Current time (in seconds)
+        */
+        void reset(double now) {
+            uint32_t micros = toMicros(now);
+            clear(left, micros);
+            clear(right, micros);
+            windowNext = 0;
+        }
+
+        /** countsReset
+            Tells the estimator the encoders were just reset to zero
+        */
+        void countsReset() {
+            left.lastCounts = 0;
+            right.lastCounts = 0;
+        }
+
+        /** setConstants
+            Changes how encoder counts turn into inches and degrees, for when calibrated constants are loaded
+        */
+        void setConstants(float countsPerInch, float leftCountsPerDegree, float rightCountsPerDegree) {
+            this->countsPerInch = countsPerInch;
+            countsPerDegree = (leftCountsPerDegree + rightCountsPerDegree) / 2;
+        }
+
+        /** setFilterShift
+            @param shift Each estimate moves 1/2^shift of the way to the new measurement, 0 for no filter
+        */
+        void setFilterShift(int shift) {
+            filterShift = shift;
+        }
+
+        /** measure
+            Takes one tick's encoder counts
+            @param leftCounts Left encoder count
+            @param rightCounts Right encoder count
+            @param now Time of the counts (in seconds)
+        */
+        void measure(int leftCounts, int rightCounts, double now) {
+            uint32_t micros = toMicros(now);
+            measureWheel(left, leftCounts, leftMotor.getDirection(), micros);
+            measureWheel(right, rightCounts, rightMotor.getDirection(), micros);
+            windowNext = (windowNext + 1) % VELOCITY_WINDOW;
+        }
+
+        /** getLeftRaw
+            @return Left wheel speed (in counts per second with VELOCITY_FRACTION_BITS fraction bits)
+        */
+        int32_t getLeftRaw() const {
+            return left.filtered;
+        }
+
+        int32_t getRightRaw() const {
+            return right.filtered;
+        }
+
+        /** getLeft
+            @return Left wheel speed (in inches per second, negative backwards)
+        */
+        float getLeft() const {
+            return left.filtered / (float)(1 << VELOCITY_FRACTION_BITS) / countsPerInch;
+        }
+
+        /** getRight
+            @return Right wheel speed (in inches per second, negative backwards)
+        */
+        float getRight() const {
+            return right.filtered / (float)(1 << VELOCITY_FRACTION_BITS) / countsPerInch;
+        }
+
+        /** getLinear
+            @return Speed of the middle of the robot (in inches per second, negative backwards)
+        */
+        float getLinear() const {
+            return (left.filtered + right.filtered) / (float)(2 << VELOCITY_FRACTION_BITS) / countsPerInch;
+        }
+
+        /** getAngular
+            @return How fast the robot is turning (in degrees per second, positive to the left like RPS)
+        */
+        float getAngular() const {
+            return (right.filtered - left.filtered) / (float)(2 << VELOCITY_FRACTION_BITS) / countsPerDegree;
+        }
+
+        /** update
+            Control loop task that keeps the estimate up to date
+            @param estimator The VelocityEstimator to update
+            @param now Time the tick started (in seconds)
+        */
+        static void update(void *estimator, double now) {
+            VelocityEstimator *self = (VelocityEstimator *)estimator;
+            if(self->sensors.getChannels() & SENSE_ENCODERS) {
+                const SensorFrame &frame = self->sensors.frame();
+                self->measure(frame.leftCounts, frame.rightCounts, now);
+            }
+        }
+
+    private:
+        /** toMicros
+            @param now Time (in seconds)
+            @return The time in whole microseconds, wrapped to 32 bits. Going through 64 bits keeps the
+                    conversion defined past the 4295 seconds a uint32_t holds.
+        */
+        static uint32_t toMicros(double now) {
+            return (uint32_t)(uint64_t)(now * 1000000);
+        }
+
+        void clear(WheelVelocity &wheel, uint32_t micros) {
+            wheel.lastCounts = 0;
+            wheel.total = 0;
+            for(int i = 0; i < VELOCITY_WINDOW; i++) {
+                wheel.windowTotals[i] = 0;
+                wheel.windowTimes[i] = micros;
+            }
+            wheel.edgeTime = micros - VELOCITY_STOP_MICROS;
+            wheel.edgeRate = 0;
+            wheel.direction = 1;
+            wheel.raw = 0;
+            wheel.filtered = 0;
+        }
+
+        void measureWheel(WheelVelocity &wheel, int counts, int direction, uint32_t micros) {
+            //A count lower than last time means the encoders were reset without countsReset()
+            int delta = counts >= wheel.lastCounts ? counts - wheel.lastCounts : counts;
+            wheel.lastCounts = counts;
+            wheel.total += delta;
+
+            uint32_t sinceEdge = micros - wheel.edgeTime;
+            if(delta > 0) {
+                //The counts all arrived some time in this tick, so the edge is taken to be at its start
+                if(sinceEdge > 0 && sinceEdge < VELOCITY_STOP_MICROS) {
+                    wheel.edgeRate = rate(delta, sinceEdge);
+                }
+                else {
+                    wheel.edgeRate = rate(delta, VELOCITY_STOP_MICROS);
+                }
+                wheel.edgeTime = micros;
+            }
+            else if(sinceEdge >= VELOCITY_STOP_MICROS) {
+                wheel.edgeRate = 0;
+            }
+            else if(wheel.edgeRate > rate(1, sinceEdge)) {
+                //The next count is later than the last gap, so the wheel is at most this fast
+                wheel.edgeRate = rate(1, sinceEdge);
+            }
+
+            //The slot about to be filled holds the tick VELOCITY_WINDOW ticks ago
+            int32_t windowCounts = wheel.total - wheel.windowTotals[windowNext];
+            uint32_t windowTime = micros - wheel.windowTimes[windowNext];
+            int32_t speed;
+            if(windowCounts >= VELOCITY_EDGE_COUNTS && windowTime > 0) {
+                speed = rate(windowCounts, windowTime);
+            }
+            else {
+                speed = wheel.edgeRate;
+            }
+            wheel.windowTotals[windowNext] = wheel.total;
+            wheel.windowTimes[windowNext] = micros;
+
+            //A wheel driven the other way keeps turning the old way until the motor has slowed it down
+            if(direction != wheel.direction && speed < (VELOCITY_REVERSE_RATE << VELOCITY_FRACTION_BITS)) {
+                wheel.direction = direction;
+            }
+            wheel.raw = wheel.direction * speed;
+            wheel.filtered += (wheel.raw - wheel.filtered) >> filterShift;
+        }
+
+        /** rate
+            @param counts Counts gained
+            @param micros Time they took (in microseconds)
+            @return Counts per second with VELOCITY_FRACTION_BITS fraction bits
+        */
+        static int32_t rate(int32_t counts, uint32_t micros) {
+            return (int32_t)(((int64_t)counts * (1000000 << VELOCITY_FRACTION_BITS)) / micros);
+        }
+
+        const SensorBank &sensors;
+        const DriveMotor &leftMotor;
+        const DriveMotor &rightMotor;
+        float countsPerInch;
+        float countsPerDegree;
+        int filterShift;
+
+        WheelVelocity left;
+        WheelVelocity right;
+        //Slot this tick's totals go in
+        int windowNext;
+};
+
+#endif